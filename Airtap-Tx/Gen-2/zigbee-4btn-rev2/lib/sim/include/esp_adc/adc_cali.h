@@ -0,0 +1,11 @@
+#ifndef ESP_ADC_ADC_CALI_H
+#define ESP_ADC_ADC_CALI_H
+
+#include "esp_err.h"
+
+// Raw readings are already in millivolts in the simulator
+typedef struct adc_cali_scheme_t *adc_cali_handle_t;
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage);
+
+#endif // ESP_ADC_ADC_CALI_H
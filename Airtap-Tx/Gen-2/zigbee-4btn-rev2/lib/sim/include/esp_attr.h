@@ -0,0 +1,13 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// Placement attributes have no meaning on the host. RTC_NOINIT_ATTR data
+// starts zeroed, which the snapshot checksum rejects like power-on garbage.
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_SLOW_ATTR
+#define __NOINIT_ATTR
+
+#endif // ESP_ATTR_H
@@ -0,0 +1,44 @@
+#ifndef ESP_CORE_DUMP_H
+#define ESP_CORE_DUMP_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// No core dump is ever found in the simulated flash
+#define APP_ELF_SHA256_SZ               (CONFIG_APP_RETRIEVE_LEN_ELF_SHA + 1)
+#ifndef CONFIG_APP_RETRIEVE_LEN_ELF_SHA
+#define CONFIG_APP_RETRIEVE_LEN_ELF_SHA 9
+#endif
+#define EPCx_REGISTER_COUNT             8
+#define ESP_CORE_DUMP_STACKDUMP_SIZE    1024
+
+typedef struct {
+    uint32_t mstatus;
+    uint32_t mtvec;
+    uint32_t mcause;
+    uint32_t mtval;
+    uint32_t ra;
+    uint32_t sp;
+    uint32_t exc_a[8];
+} esp_core_dump_summary_extra_info_t;
+
+typedef struct {
+    uint8_t stackdump[ESP_CORE_DUMP_STACKDUMP_SIZE];
+    uint32_t dump_size;
+} esp_core_dump_bt_info_t;
+
+typedef struct {
+    uint32_t exc_tcb;
+    char exc_task[16];
+    uint32_t exc_pc;
+    esp_core_dump_bt_info_t exc_bt_info;
+    uint32_t core_dump_version;
+    uint8_t app_elf_sha256[APP_ELF_SHA256_SZ];
+    esp_core_dump_summary_extra_info_t ex_info;
+} esp_core_dump_summary_t;
+
+esp_err_t esp_core_dump_image_check(void);
+esp_err_t esp_core_dump_get_summary(esp_core_dump_summary_t *summary);
+esp_err_t esp_core_dump_image_erase(void);
+
+#endif // ESP_CORE_DUMP_H
@@ -0,0 +1,12 @@
+#ifndef ESP_CPU_H
+#define ESP_CPU_H
+
+#include <stdint.h>
+
+// Cycle counter derived from the virtual clock at SIM_CPU_MHZ. Firmware code
+// runs in zero virtual time, so only modelled busy time shows up in it.
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#endif // ESP_CPU_H
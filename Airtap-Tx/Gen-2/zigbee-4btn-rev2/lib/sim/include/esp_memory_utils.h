@@ -0,0 +1,13 @@
+#ifndef ESP_MEMORY_UTILS_H
+#define ESP_MEMORY_UTILS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Host addresses are never target code addresses
+static inline bool esp_ptr_executable(const void *p) {
+    uint32_t addr = (uint32_t)(uintptr_t)p;
+    return addr >= 0x40800000 && addr < 0x40880000 && (uintptr_t)p == addr;
+}
+
+#endif // ESP_MEMORY_UTILS_H
@@ -0,0 +1,11 @@
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Seeded by sim_init(), so a run can be replayed
+uint32_t esp_random(void);
+void esp_fill_random(void *buf, size_t len);
+
+#endif // ESP_RANDOM_H
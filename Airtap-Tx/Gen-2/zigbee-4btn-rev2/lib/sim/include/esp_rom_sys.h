@@ -0,0 +1,10 @@
+#ifndef ESP_ROM_SYS_H
+#define ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+// Busy-waits: the calling task holds the CPU for us of virtual time
+void esp_rom_delay_us(uint32_t us);
+int esp_rom_printf(const char *fmt, ...);
+
+#endif // ESP_ROM_SYS_H
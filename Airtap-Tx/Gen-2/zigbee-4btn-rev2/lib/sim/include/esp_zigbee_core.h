@@ -0,0 +1,87 @@
+#ifndef ESP_ZIGBEE_CORE_H
+#define ESP_ZIGBEE_CORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_zigbee_type.h"
+#include "esp_zigbee_cluster.h"
+#include "esp_zigbee_endpoint.h"
+
+// Fake Zigbee end device stack. esp_zb_main_loop_iteration() behaves like
+// the library's stack loop: it takes the stack lock and never returns,
+// waking only for stack events (signals, alarms, writes from the hub) and
+// for the parent poll every zed_cfg.keep_alive ms once joined. The network
+// side is driven by the sim_zb_*() calls in sim.h.
+typedef enum {
+    ESP_ZB_ZDO_SIGNAL_DEFAULT_START = 0x00,
+    ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP = 0x01,
+    ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE = 0x02,
+    ESP_ZB_ZDO_SIGNAL_LEAVE = 0x03,
+    ESP_ZB_ZDO_SIGNAL_ERROR = 0x04,
+    ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START = 0x05,
+    ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT = 0x06,
+    ESP_ZB_BDB_SIGNAL_STEERING = 0x0a,
+    ESP_ZB_BDB_SIGNAL_FORMATION = 0x0b,
+    ESP_ZB_ZDO_SIGNAL_PRODUCTION_CONFIG_READY = 0x14,
+    ESP_ZB_COMMON_SIGNAL_CAN_SLEEP = 0x16,
+} esp_zb_app_signal_type_t;
+
+typedef struct {
+    uint32_t *p_app_signal;
+    esp_err_t esp_err_status;
+} esp_zb_app_signal_t;
+
+typedef enum {
+    ESP_ZB_BDB_MODE_INITIALIZATION = 0,
+    ESP_ZB_BDB_MODE_TOUCHLINK_COMMISSIONING = 1,
+    ESP_ZB_BDB_MODE_NETWORK_STEERING = 2,
+    ESP_ZB_BDB_MODE_NETWORK_FORMATION = 4,
+} esp_zb_bdb_commissioning_mode_t;
+
+typedef enum {
+    ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID = 0x0000,
+    ESP_ZB_CORE_CMD_READ_ATTR_RESP_CB_ID = 0x1000,
+} esp_zb_core_action_callback_id_t;
+
+typedef esp_err_t (*esp_zb_core_action_callback_t)(esp_zb_core_action_callback_id_t callback_id, const void *message);
+typedef void (*esp_zb_callback_t)(uint8_t param);
+
+// Implemented by the application
+void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_s);
+
+esp_err_t esp_zb_platform_config(esp_zb_platform_config_t *config);
+void esp_zb_init(esp_zb_cfg_t *nwk_cfg);
+esp_err_t esp_zb_device_register(esp_zb_ep_list_t *ep_list);
+void esp_zb_core_action_handler_register(esp_zb_core_action_callback_t cb);
+esp_err_t esp_zb_set_primary_network_channel_set(uint32_t channel_mask);
+esp_err_t esp_zb_start(bool autostart);
+void esp_zb_main_loop_iteration(void);
+void esp_zb_stack_main_loop(void);
+
+bool esp_zb_lock_acquire(TickType_t block_ticks);
+void esp_zb_lock_release(void);
+
+esp_err_t esp_zb_bdb_start_top_level_commissioning(uint8_t mode_mask);
+bool esp_zb_bdb_is_factory_new(void);
+void esp_zb_bdb_reset_via_local_action(void);
+void esp_zb_factory_reset(void);
+
+void esp_zb_get_extended_pan_id(esp_zb_ieee_addr_t ext_pan_id);
+uint16_t esp_zb_get_pan_id(void);
+uint8_t esp_zb_get_current_channel(void);
+uint16_t esp_zb_get_short_address(void);
+const char *esp_zb_zdo_signal_to_string(esp_zb_app_signal_type_t signal);
+
+// Runs cb(param) in the Zigbee task after time ms; caller holds the lock
+void esp_zb_scheduler_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t time);
+
+void esp_zb_sleep_enable(bool enable);
+void esp_zb_sleep_now(void);
+
+esp_zb_zcl_attr_t *esp_zb_zcl_get_attribute(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role, uint16_t attr_id);
+esp_zb_zcl_status_t esp_zb_zcl_set_attribute_val(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role,
+                                                 uint16_t attr_id, void *value_p, bool check);
+
+#endif // ESP_ZIGBEE_CORE_H
@@ -0,0 +1,10 @@
+#ifndef ESP_ZIGBEE_ENDPOINT_H
+#define ESP_ZIGBEE_ENDPOINT_H
+
+#include "esp_zigbee_type.h"
+
+esp_zb_ep_list_t *esp_zb_ep_list_create(void);
+esp_err_t esp_zb_ep_list_add_ep(esp_zb_ep_list_t *ep_list, esp_zb_cluster_list_t *cluster_list,
+                                esp_zb_endpoint_config_t endpoint_config);
+
+#endif // ESP_ZIGBEE_ENDPOINT_H
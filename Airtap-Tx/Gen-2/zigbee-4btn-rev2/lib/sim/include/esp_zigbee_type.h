@@ -0,0 +1,197 @@
+#ifndef ESP_ZIGBEE_TYPE_H
+#define ESP_ZIGBEE_TYPE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// The subset of esp-zigbee-lib 1.6 types the firmware uses, with the
+// library's names and values
+typedef uint8_t esp_zb_ieee_addr_t[8];
+
+typedef struct esp_zb_attribute_list_s esp_zb_attribute_list_t;
+typedef struct esp_zb_cluster_list_s esp_zb_cluster_list_t;
+typedef struct esp_zb_ep_list_s esp_zb_ep_list_t;
+
+typedef enum {
+    ESP_ZB_DEVICE_TYPE_COORDINATOR = 0x0,
+    ESP_ZB_DEVICE_TYPE_ROUTER = 0x1,
+    ESP_ZB_DEVICE_TYPE_ED = 0x2,
+    ESP_ZB_DEVICE_TYPE_NONE = 0x3,
+} esp_zb_nwk_device_type_t;
+
+typedef enum {
+    ESP_ZB_ED_AGING_TIMEOUT_10SEC = 0,
+    ESP_ZB_ED_AGING_TIMEOUT_2MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_4MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_8MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_16MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_32MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_64MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_128MIN,
+    ESP_ZB_ED_AGING_TIMEOUT_256MIN,
+} esp_zb_aging_timeout_t;
+
+typedef struct {
+    uint8_t zczr_max_children;
+} esp_zb_zczr_cfg_t;
+
+typedef struct {
+    uint8_t ed_timeout;
+    uint32_t keep_alive;        // Parent poll interval in ms
+} esp_zb_zed_cfg_t;
+
+typedef struct {
+    esp_zb_nwk_device_type_t esp_zb_role;
+    bool install_code_policy;
+    union {
+        esp_zb_zczr_cfg_t zczr_cfg;
+        esp_zb_zed_cfg_t zed_cfg;
+    } nwk_cfg;
+} esp_zb_cfg_t;
+
+typedef enum {
+    ZB_RADIO_MODE_NATIVE = 0x0,
+    ZB_RADIO_MODE_UART_RCP = 0x1,
+} esp_zb_radio_mode_t;
+
+typedef enum {
+    ZB_HOST_CONNECTION_MODE_NONE = 0x0,
+    ZB_HOST_CONNECTION_MODE_CLI_UART = 0x1,
+    ZB_HOST_CONNECTION_MODE_RCP_UART = 0x2,
+} esp_zb_host_connection_mode_t;
+
+typedef struct {
+    esp_zb_radio_mode_t radio_mode;
+} esp_zb_radio_config_t;
+
+typedef struct {
+    esp_zb_host_connection_mode_t host_connection_mode;
+} esp_zb_host_config_t;
+
+typedef struct {
+    esp_zb_radio_config_t radio_config;
+    esp_zb_host_config_t host_config;
+} esp_zb_platform_config_t;
+
+typedef enum {
+    ESP_ZB_ZCL_CLUSTER_SERVER_ROLE = 0x01,
+    ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE = 0x02,
+} esp_zb_zcl_cluster_role_t;
+
+typedef enum {
+    ESP_ZB_ZCL_CLUSTER_ID_BASIC = 0x0000,
+    ESP_ZB_ZCL_CLUSTER_ID_IDENTIFY = 0x0003,
+    ESP_ZB_ZCL_CLUSTER_ID_ON_OFF = 0x0006,
+    ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL = 0x0008,
+    ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT = 0x0402,
+} esp_zb_zcl_cluster_id_t;
+
+typedef enum {
+    ESP_ZB_ZCL_ATTR_TYPE_NULL = 0x00,
+    ESP_ZB_ZCL_ATTR_TYPE_BOOL = 0x10,
+    ESP_ZB_ZCL_ATTR_TYPE_8BITMAP = 0x18,
+    ESP_ZB_ZCL_ATTR_TYPE_U8 = 0x20,
+    ESP_ZB_ZCL_ATTR_TYPE_U16 = 0x21,
+    ESP_ZB_ZCL_ATTR_TYPE_U32 = 0x23,
+    ESP_ZB_ZCL_ATTR_TYPE_S8 = 0x28,
+    ESP_ZB_ZCL_ATTR_TYPE_S16 = 0x29,
+    ESP_ZB_ZCL_ATTR_TYPE_8BIT_ENUM = 0x30,
+    ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING = 0x41,
+    ESP_ZB_ZCL_ATTR_TYPE_CHAR_STRING = 0x42,
+} esp_zb_zcl_attr_type_t;
+
+typedef enum {
+    ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY = 0x01,
+    ESP_ZB_ZCL_ATTR_ACCESS_WRITE_ONLY = 0x02,
+    ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE = 0x03,
+    ESP_ZB_ZCL_ATTR_ACCESS_REPORTING = 0x04,
+} esp_zb_zcl_attr_access_t;
+
+typedef enum {
+    ESP_ZB_ZCL_STATUS_SUCCESS = 0x00,
+    ESP_ZB_ZCL_STATUS_FAIL = 0x01,
+} esp_zb_zcl_status_t;
+
+// Attribute IDs
+#define ESP_ZB_ZCL_ATTR_BASIC_ZCL_VERSION_ID            0x0000
+#define ESP_ZB_ZCL_ATTR_BASIC_POWER_SOURCE_ID           0x0007
+#define ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID      0x0004
+#define ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID       0x0005
+#define ESP_ZB_ZCL_ATTR_BASIC_SW_BUILD_ID               0x4000
+#define ESP_ZB_ZCL_ATTR_IDENTIFY_IDENTIFY_TIME_ID       0x0000
+#define ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID                0x0000
+#define ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID  0x0000
+#define ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID       0x0000
+#define ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MIN_VALUE_ID   0x0001
+#define ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MAX_VALUE_ID   0x0002
+
+#define ESP_ZB_AF_HA_PROFILE_ID                         0x0104
+#define ESP_ZB_HA_ON_OFF_LIGHT_DEVICE_ID                0x0100
+#define ESP_ZB_HA_COLOR_DIMMABLE_LIGHT_DEVICE_ID        0x0102
+#define ESP_ZB_TRANSCEIVER_ALL_CHANNELS_MASK            0x07FFF800U
+
+typedef struct {
+    uint16_t id;
+    uint8_t type;
+    uint8_t access;
+    uint16_t manuf_code;
+    void *data_p;
+} esp_zb_zcl_attr_t;
+
+typedef struct {
+    esp_zb_zcl_attr_type_t type;
+    uint16_t size;
+    void *value;
+} esp_zb_zcl_attribute_data_t;
+
+typedef struct {
+    uint16_t id;
+    esp_zb_zcl_attribute_data_t data;
+} esp_zb_zcl_attribute_t;
+
+typedef struct {
+    esp_zb_zcl_status_t status;
+    uint8_t dst_endpoint;
+    uint8_t src_endpoint;
+    uint16_t cluster;
+    uint16_t profile;
+} esp_zb_device_cb_common_info_t;
+
+typedef struct {
+    esp_zb_device_cb_common_info_t info;
+    esp_zb_zcl_attribute_t attribute;
+} esp_zb_zcl_set_attr_value_message_t;
+
+typedef struct {
+    uint8_t endpoint;
+    uint16_t app_profile_id;
+    uint16_t app_device_id;
+    uint32_t app_device_version: 4;
+} esp_zb_endpoint_config_t;
+
+// Cluster configurations used by the HA standard device macros
+typedef struct {
+    uint8_t zcl_version;
+    uint8_t power_source;
+} esp_zb_basic_cluster_cfg_t;
+
+typedef struct {
+    uint16_t identify_time;
+} esp_zb_identify_cluster_cfg_t;
+
+typedef struct {
+    bool on_off;
+} esp_zb_on_off_cluster_cfg_t;
+
+typedef struct {
+    uint8_t current_level;
+} esp_zb_level_cluster_cfg_t;
+
+typedef struct {
+    int16_t measured_value;
+    int16_t min_value;
+    int16_t max_value;
+} esp_zb_temperature_meas_cluster_cfg_t;
+
+#endif // ESP_ZIGBEE_TYPE_H
@@ -0,0 +1,63 @@
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+
+// FreeRTOS types and port macros as ESP-IDF defines them for RISC-V
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define configTICK_RATE_HZ              CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES            25
+#define configMAX_TASK_NAME_LEN         CONFIG_FREERTOS_MAX_TASK_NAME_LEN
+#define configRUN_TIME_COUNTER_TYPE     uint32_t
+
+#define pdFALSE                         ((BaseType_t)0)
+#define pdTRUE                          ((BaseType_t)1)
+#define pdPASS                          pdTRUE
+#define pdFAIL                          pdFALSE
+#define errQUEUE_EMPTY                  ((BaseType_t)0)
+#define errQUEUE_FULL                   ((BaseType_t)0)
+#define errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY (-1)
+
+#define portMAX_DELAY                   ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS              ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)               ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define pdTICKS_TO_MS(ticks)            ((uint32_t)(((uint64_t)(ticks) * 1000U) / configTICK_RATE_HZ))
+
+// Spinlocks only need to mask the scheduler: every task runs on one thread
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    { 0, 0 }
+
+void sim_critical_enter(void);
+void sim_critical_exit(void);
+UBaseType_t sim_interrupt_mask(void);
+void sim_interrupt_unmask(UBaseType_t state);
+
+#define taskENTER_CRITICAL(mux)         ((void)(mux), sim_critical_enter())
+#define taskEXIT_CRITICAL(mux)          ((void)(mux), sim_critical_exit())
+#define taskENTER_CRITICAL_ISR(mux)     taskENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL_ISR(mux)      taskEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL(mux)         taskENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL(mux)          taskEXIT_CRITICAL(mux)
+#define portSET_INTERRUPT_MASK_FROM_ISR()       sim_interrupt_mask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(s)    sim_interrupt_unmask(s)
+
+void sim_yield_from_isr(BaseType_t woken);
+#define portYIELD_FROM_ISR(...)         sim_yield_from_isr(__VA_ARGS__ + 0)
+#define portYIELD()                     taskYIELD()
+
+#endif // INC_FREERTOS_H
@@ -0,0 +1,30 @@
+#ifndef ESP_ZIGBEE_HA_STANDARD_H
+#define ESP_ZIGBEE_HA_STANDARD_H
+
+#include "esp_zigbee_type.h"
+
+typedef struct {
+    esp_zb_basic_cluster_cfg_t basic_cfg;
+    esp_zb_identify_cluster_cfg_t identify_cfg;
+    esp_zb_on_off_cluster_cfg_t on_off_cfg;
+    esp_zb_level_cluster_cfg_t level_cfg;
+} esp_zb_color_dimmable_light_cfg_t;
+
+#define ESP_ZB_DEFAULT_COLOR_DIMMABLE_LIGHT_CONFIG()    \
+    {                                                   \
+        .basic_cfg = {                                  \
+            .zcl_version = 8,                           \
+            .power_source = 0x01,                       \
+        },                                              \
+        .identify_cfg = {                               \
+            .identify_time = 0,                         \
+        },                                              \
+        .on_off_cfg = {                                 \
+            .on_off = false,                            \
+        },                                              \
+        .level_cfg = {                                  \
+            .current_level = 0xff,                      \
+        },                                              \
+    }
+
+#endif // ESP_ZIGBEE_HA_STANDARD_H
@@ -0,0 +1,106 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// The esp32c6 configuration as the simulator builds it: sdkconfig.esp32c6
+// for the IDF options the firmware reads, Kconfig.projbuild defaults for the
+// AirTap ones. Every value can be overridden from build_flags; boolean
+// options that are off are left undefined, as in a generated sdkconfig.h.
+
+#define CONFIG_IDF_TARGET "esp32c6"
+#define CONFIG_IDF_TARGET_ESP32C6 1
+#define CONFIG_IDF_TARGET_ARCH_RISCV 1
+
+#ifndef CONFIG_FREERTOS_HZ
+#define CONFIG_FREERTOS_HZ 100
+#endif
+#define CONFIG_FREERTOS_MAX_TASK_NAME_LEN 16
+#ifndef CONFIG_ESP_MAIN_TASK_STACK_SIZE
+#define CONFIG_ESP_MAIN_TASK_STACK_SIZE 3584
+#endif
+#ifndef CONFIG_ESP_TIMER_TASK_STACK_SIZE
+#define CONFIG_ESP_TIMER_TASK_STACK_SIZE 3584
+#endif
+#ifndef CONFIG_FREERTOS_IDLE_TASK_STACKSIZE
+#define CONFIG_FREERTOS_IDLE_TASK_STACKSIZE 1536
+#endif
+#ifndef CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH
+#define CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH 2048
+#endif
+#define CONFIG_ESP_CONSOLE_UART_NUM 0
+#define CONFIG_LOG_DEFAULT_LEVEL 3
+
+#ifndef CONFIG_PM_ENABLE
+#define CONFIG_PM_ENABLE 1
+#endif
+#define CONFIG_PM_LIGHT_SLEEP_CALLBACKS 1
+#define CONFIG_FREERTOS_USE_TICKLESS_IDLE 1
+#ifndef CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP
+#define CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP 3
+#endif
+#define CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH 1
+
+// AirTap Firmware
+#if !defined(CONFIG_AIRTAP_BOARD_GEN4_TOUCH)
+#define CONFIG_AIRTAP_BOARD_GEN2 1
+#else
+#ifndef CONFIG_AIRTAP_TOUCH_ACTIVE_HIGH
+#define CONFIG_AIRTAP_TOUCH_ACTIVE_HIGH 1
+#endif
+#ifndef CONFIG_AIRTAP_TOUCH_MAX_HOLD_MS
+#define CONFIG_AIRTAP_TOUCH_MAX_HOLD_MS 30000
+#endif
+#endif
+#ifndef CONFIG_AIRTAP_ZIGBEE_TASK_STACK
+#define CONFIG_AIRTAP_ZIGBEE_TASK_STACK 4096
+#endif
+#ifndef CONFIG_AIRTAP_CONSOLE_TASK_STACK
+#define CONFIG_AIRTAP_CONSOLE_TASK_STACK 3072
+#endif
+#ifndef CONFIG_AIRTAP_BUTTON_DEBOUNCE_MS
+#if CONFIG_AIRTAP_BOARD_GEN4_TOUCH
+#define CONFIG_AIRTAP_BUTTON_DEBOUNCE_MS 40
+#else
+#define CONFIG_AIRTAP_BUTTON_DEBOUNCE_MS 20
+#endif
+#endif
+#ifndef CONFIG_AIRTAP_I2C_STALL_MS
+#define CONFIG_AIRTAP_I2C_STALL_MS 0
+#endif
+
+#if CONFIG_AIRTAP_PROFILER && !defined(CONFIG_AIRTAP_PROFILER_DUMP_INTERVAL_MS)
+#define CONFIG_AIRTAP_PROFILER_DUMP_INTERVAL_MS 30000
+#endif
+#if CONFIG_AIRTAP_TRACE && !defined(CONFIG_AIRTAP_TRACE_EVENTS)
+#define CONFIG_AIRTAP_TRACE_EVENTS 2048
+#endif
+#if CONFIG_AIRTAP_SOAK
+#ifndef CONFIG_AIRTAP_SOAK_SAMPLE_MS
+#define CONFIG_AIRTAP_SOAK_SAMPLE_MS 60000
+#endif
+#ifndef CONFIG_AIRTAP_SOAK_STIMULUS_MAX_MS
+#define CONFIG_AIRTAP_SOAK_STIMULUS_MAX_MS 20000
+#endif
+#ifndef CONFIG_AIRTAP_SOAK_ZB_FAULT_PCT
+#define CONFIG_AIRTAP_SOAK_ZB_FAULT_PCT 25
+#endif
+#ifndef CONFIG_AIRTAP_SOAK_WINDOW
+#define CONFIG_AIRTAP_SOAK_WINDOW 30
+#endif
+#endif
+
+#ifndef CONFIG_AIRTAP_STACK_MONITOR
+#define CONFIG_AIRTAP_STACK_MONITOR 1
+#endif
+#if CONFIG_AIRTAP_STACK_MONITOR
+#ifndef CONFIG_AIRTAP_STACK_SAMPLE_MS
+#define CONFIG_AIRTAP_STACK_SAMPLE_MS 60000
+#endif
+#ifndef CONFIG_AIRTAP_STACK_WARN_BYTES
+#define CONFIG_AIRTAP_STACK_WARN_BYTES 512
+#endif
+#ifndef CONFIG_AIRTAP_STACK_MARGIN
+#define CONFIG_AIRTAP_STACK_MARGIN 1024
+#endif
+#endif
+
+#endif // SDKCONFIG_H
@@ -0,0 +1,147 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_log.h"
+
+// Whole-firmware host simulator. The sources in src/ build unchanged against
+// fake FreeRTOS, esp_timer, GPIO, LEDC, ADC, I2C, UART, NVS, PM and esp_zb
+// layers. Tasks are coroutines on one host thread, scheduled by priority as
+// FreeRTOS would, and the clock is virtual: code runs in zero time and the
+// clock only moves when every task is blocked, so a day of device time
+// takes seconds and a run is repeatable for a given seed.
+//
+// The Zigbee stack is a fake (esp_zigbee_core.h): its loop blocks between
+// stack events and parent polls and never returns, as the library's does.
+// Task stacks are host stacks; the high water marks reported are estimates
+// scaled to RV32.
+//
+// Work that takes real time on the chip holds its caller for a modelled
+// duration. These are estimates; override them with -D once measured.
+#ifndef SIM_NVS_INIT_US
+#define SIM_NVS_INIT_US         20000   // nvs_flash_init(): page scan of the NVS partition
+#endif
+#ifndef SIM_NVS_READ_US
+#define SIM_NVS_READ_US         50      // nvs_open() / nvs_get_*()
+#endif
+#ifndef SIM_NVS_WRITE_US
+#define SIM_NVS_WRITE_US        2000    // nvs_set_*() that changes the stored value
+#endif
+#ifndef SIM_ADC_READ_US
+#define SIM_ADC_READ_US         30      // adc_oneshot_read()
+#endif
+#ifndef SIM_UART_BAUD
+#define SIM_UART_BAUD           115200  // Log output; a line waits once the TX FIFO is full
+#endif
+#define SIM_UART_FIFO_BYTES     128
+#ifndef SIM_CPU_MHZ
+#define SIM_CPU_MHZ             160     // esp_cpu_get_cycle_count() rate
+#endif
+
+// Zigbee network timings
+#ifndef SIM_ZB_INIT_US
+#define SIM_ZB_INIT_US          100000  // BDB initialization to FIRST_START / REBOOT
+#endif
+#ifndef SIM_ZB_STEERING_US
+#define SIM_ZB_STEERING_US      4000000 // Steering over all channels to its result
+#endif
+#ifndef SIM_ZB_LEAVE_US
+#define SIM_ZB_LEAVE_US         200000  // Local reset to the LEAVE signal
+#endif
+#ifndef SIM_ZB_POLL_US
+#define SIM_ZB_POLL_US          2000    // Parent poll: radio up, data request, response
+#endif
+
+#define SIM_FOREVER INT64_MAX
+
+typedef void (*sim_event_fn_t)(void *arg);
+
+// Set up the device: NVS, GPIO levels and the Zigbee network start empty and
+// the random sources are seeded. Pre-seed state (NVS, reset reason, inputs)
+// after this and before sim_start(). The firmware's statics cannot be reset,
+// so this may be called once per process: one test binary is one boot.
+void sim_init(uint32_t seed);
+
+// Power on: start the esp_timer task and the main task running app_main()
+void sim_start(void);
+
+// Advance virtual time, running tasks, timers and scheduled events
+void sim_run_until(int64_t time_us);
+void sim_run_for(int64_t duration_us);
+int64_t sim_now_us(void);
+
+// Call fn(arg) from the environment (not a task) at time_us
+void sim_at(int64_t time_us, sim_event_fn_t fn, void *arg);
+
+// Counters since sim_start()
+typedef struct {
+    uint64_t wakeups;           // Idle periods ended by a task becoming ready or an interrupt
+    uint64_t switches;          // Task resumptions
+    uint64_t sleeps;            // Idle periods spent in automatic light sleep
+    int64_t busy_us;            // Modelled CPU time
+    int64_t idle_us;
+    int64_t sleep_us;
+} sim_stats_t;
+
+void sim_get_stats(sim_stats_t *stats);
+
+// Times the named task resumed after blocking or being preempted; 0 if unknown
+uint64_t sim_task_resumes(const char *name);
+
+// Heap bytes allocated through the fakes (queues, timers, stacks, Zigbee)
+size_t sim_heap_used(void);
+
+// Logging: lines at or above this level are printed (default ESP_LOG_WARN).
+// The hook sees every line the device would print.
+typedef void (*sim_log_hook_t)(esp_log_level_t level, const char *line);
+void sim_set_log_level(esp_log_level_t level);
+void sim_set_log_hook(sim_log_hook_t hook);
+
+// esp_reset_reason() for this boot (esp_reset_reason_t, default ESP_RST_POWERON)
+void sim_set_reset_reason(int reason);
+
+// GPIO inputs. Unconnected inputs follow their pull resistors.
+void sim_gpio_set_input(int pin, int level);
+void sim_gpio_input_at(int pin, int level, int64_t time_us);
+
+// Press a button for hold_us, with contact bounce for up to bounce_us on
+// each edge. Times are absolute.
+void sim_button_press(int pin, int active_level, int64_t at_us, int64_t hold_us, int64_t bounce_us);
+
+// LEDC output on a pin: first rising edge and current duty (0 when stopped)
+int64_t sim_pwm_first_edge_us(int pin);
+uint32_t sim_pwm_duty(int pin);
+uint32_t sim_pwm_duty_max(int pin);
+
+// NTC temperature seen by the ADC
+void sim_set_temperature(float celsius);
+
+// I2C devices answer only while present (default: present)
+void sim_i2c_set_present(bool present);
+uint32_t sim_i2c_transactions(void);
+
+// NVS contents survive sim_start() but not sim_init()
+void sim_nvs_set_u8(const char *ns, const char *key, uint8_t value);
+void sim_nvs_set_u16(const char *ns, const char *key, uint16_t value);
+bool sim_nvs_get_u16(const char *ns, const char *key, uint16_t *value);
+uint32_t sim_nvs_writes(void);
+
+// Bytes typed on the console UART
+void sim_console_input(const char *text);
+
+// Zigbee network seen by the device
+void sim_zb_set_commissioned(bool commissioned);        // Joined before power-on
+void sim_zb_set_network(bool available);                // A coordinator accepts joins
+void sim_zb_set_steering_fail_permille(uint32_t permille);
+bool sim_zb_joined(void);
+uint32_t sim_zb_steering_attempts(void);
+uint32_t sim_zb_reports(void);                          // Attribute changes made by the device
+
+// The hub writing or reading an attribute on the device's endpoint. Writes
+// are delivered in the Zigbee task; false if not joined or unknown.
+bool sim_zb_hub_write(uint16_t cluster, uint16_t attr, const void *value);
+bool sim_zb_hub_read(uint16_t cluster, uint16_t attr, void *value, size_t size);
+
+#endif // SIM_H
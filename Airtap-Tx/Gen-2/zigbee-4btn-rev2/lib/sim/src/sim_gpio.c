@@ -0,0 +1,235 @@
+#include <stdlib.h>
+#include "sim_internal.h"
+#include "driver/gpio.h"
+
+// Pin levels and interrupts. An input not driven from the test follows its
+// pull resistor. Interrupts are checked whenever a level, trigger type or
+// enable changes and again whenever interrupts are unmasked, so a level
+// trigger keeps firing while its level holds and the pin stays enabled.
+#define STORM_LIMIT 10000   // ISR runs in one pass before a stuck trigger is fatal
+
+typedef struct {
+    gpio_mode_t mode;
+    bool pull_up;
+    bool pull_down;
+    int driven;             // Level driven from outside, -1 for none
+    int output;
+    int last;               // Level at the previous check, for edge triggers
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    bool edge_pending;
+    gpio_isr_t isr;
+    void *isr_arg;
+} pin_t;
+
+static pin_t pins[GPIO_NUM_MAX];
+static bool isr_service;
+static bool servicing;
+
+typedef struct {
+    int pin;
+    int level;
+} level_change_t;
+
+static bool valid(gpio_num_t gpio_num) {
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+static int level_of(const pin_t *pin) {
+    if (pin->driven >= 0) return pin->driven;
+    if (pin->mode & GPIO_MODE_OUTPUT) return pin->output;
+    return pin->pull_up ? 1 : 0;
+}
+
+void sim_gpio_reset(void) {
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        pins[i] = (pin_t){ .driven = -1 };
+    }
+    isr_service = false;
+}
+
+static bool fires(pin_t *pin) {
+    if (!pin->intr_enabled || !pin->isr) return false;
+    int level = level_of(pin);
+    switch (pin->intr_type) {
+    case GPIO_INTR_LOW_LEVEL:
+        return level == 0;
+    case GPIO_INTR_HIGH_LEVEL:
+        return level == 1;
+    case GPIO_INTR_POSEDGE:
+    case GPIO_INTR_NEGEDGE:
+    case GPIO_INTR_ANYEDGE:
+        return pin->edge_pending;
+    default:
+        return false;
+    }
+}
+
+static void note_level(pin_t *pin) {
+    int level = level_of(pin);
+    if (level != pin->last) {
+        bool rising = level > pin->last;
+        if (pin->intr_type == GPIO_INTR_ANYEDGE ||
+            (pin->intr_type == GPIO_INTR_POSEDGE && rising) ||
+            (pin->intr_type == GPIO_INTR_NEGEDGE && !rising)) {
+            pin->edge_pending = true;
+        }
+        pin->last = level;
+    }
+}
+
+// Take every interrupt that is due, unless interrupts are masked here
+void sim_gpio_service(void) {
+    if (servicing || sim_in_isr() || sim_in_critical()) return;
+    servicing = true;
+    int runs = 0;
+    bool fired = true;
+    while (fired) {
+        fired = false;
+        for (int i = 0; i < GPIO_NUM_MAX; i++) {
+            pin_t *pin = &pins[i];
+            if (!fires(pin)) continue;
+            if (++runs > STORM_LIMIT) sim_fatal("interrupt storm on GPIO%d", i);
+            pin->edge_pending = false;
+            sim_isr_run(pin->isr, pin->isr_arg);
+            fired = true;
+        }
+    }
+    servicing = false;
+}
+
+static void set_driven(int pin, int level) {
+    if (!valid(pin)) sim_fatal("GPIO%d does not exist", pin);
+    pins[pin].driven = level;
+    note_level(&pins[pin]);
+    sim_gpio_service();
+}
+
+void sim_gpio_set_input(int pin, int level) {
+    set_driven(pin, level < 0 ? -1 : level != 0);
+}
+
+static void level_change_event(void *arg) {
+    level_change_t *change = arg;
+    set_driven(change->pin, change->level);
+    free(change);
+}
+
+void sim_gpio_input_at(int pin, int level, int64_t time_us) {
+    level_change_t *change = malloc(sizeof(*change));
+    if (!change) sim_fatal("out of host memory");
+    change->pin = pin;
+    change->level = level < 0 ? -1 : level != 0;
+    sim_at(time_us, level_change_event, change);
+}
+
+// Contact bounce: a few random flips within bounce_us of each edge, ending
+// on the settled level
+static void bounce(int pin, int settled, int64_t at_us, int64_t bounce_us) {
+    if (bounce_us > 0) {
+        int flips = 2 + (int)(sim_env_random() % 5) * 2;
+        int64_t t = at_us;
+        for (int i = 0; i < flips; i++) {
+            t += 1 + (int64_t)(sim_env_random() % (uint32_t)(bounce_us / flips + 1));
+            sim_gpio_input_at(pin, i % 2 == 0 ? settled : !settled, i == 0 ? at_us : t);
+        }
+        sim_gpio_input_at(pin, settled, t + 1);
+    } else {
+        sim_gpio_input_at(pin, settled, at_us);
+    }
+}
+
+void sim_button_press(int pin, int active_level, int64_t at_us, int64_t hold_us, int64_t bounce_us) {
+    bounce(pin, active_level, at_us, bounce_us);
+    bounce(pin, !active_level, at_us + hold_us, bounce_us);
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    if (!config) return ESP_ERR_INVALID_ARG;
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        if (!(config->pin_bit_mask & (1ULL << i))) continue;
+        pin_t *pin = &pins[i];
+        pin->mode = config->mode;
+        pin->pull_up = config->pull_up_en;
+        pin->pull_down = config->pull_down_en;
+        pin->intr_type = config->intr_type;
+        pin->intr_enabled = config->intr_type != GPIO_INTR_DISABLE;
+        pin->last = level_of(pin);
+        pin->edge_pending = false;
+    }
+    sim_gpio_service();
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    int driven = pins[gpio_num].driven;
+    pins[gpio_num] = (pin_t){ .driven = driven, .pull_up = true, .mode = GPIO_MODE_INPUT };
+    pins[gpio_num].last = level_of(&pins[gpio_num]);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    return valid(gpio_num) ? level_of(&pins[gpio_num]) : 0;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins[gpio_num].output = level != 0;
+    note_level(&pins[gpio_num]);
+    sim_gpio_service();
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins[gpio_num].intr_type = intr_type;
+    pins[gpio_num].edge_pending = false;
+    sim_gpio_service();
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins[gpio_num].intr_enabled = true;
+    sim_gpio_service();
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins[gpio_num].intr_enabled = false;
+    return ESP_OK;
+}
+
+// Light sleep wakeup follows the interrupt: a level that would fire wakes the chip
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    if (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num) {
+    return valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+    if (isr_service) return ESP_ERR_INVALID_STATE;
+    isr_service = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    if (!isr_service) return ESP_ERR_INVALID_STATE;
+    pins[gpio_num].isr = isr_handler;
+    pins[gpio_num].isr_arg = args;
+    sim_gpio_service();
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins[gpio_num].isr = NULL;
+    return ESP_OK;
+}
@@ -0,0 +1,97 @@
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ucontext.h>
+#include "sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Shared between the fake layers; not part of the simulator API
+
+// Host stack per task. Host frames are roughly twice the size of RV32 ones,
+// so usage is halved before it is reported as the task's.
+#define SIM_HOST_STACK_BYTES    (128 * 1024)
+#define SIM_STACK_SCALE_DIV     2
+
+// Free heap at app_main() on the device, once ESP-IDF and the Zigbee
+// stack's pools are allocated (estimate)
+#define SIM_HEAP_TOTAL_BYTES    (256 * 1024)
+#define SIM_TCB_BYTES           352
+
+typedef enum {
+    SIM_TASK_READY,
+    SIM_TASK_BUSY,          // Holding the CPU for busy_left_us of modelled work
+    SIM_TASK_BLOCKED,
+    SIM_TASK_DELETED,
+} sim_task_state_t;
+
+struct tskTaskControlBlock {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t fn;
+    void *arg;
+    UBaseType_t priority;
+    uint32_t stack_depth;           // Bytes, as passed to xTaskCreate()
+    uint8_t *stack;                 // Host stack, painted
+    size_t stack_mark;              // Lowest offset found touched
+    ucontext_t ctx;
+    sim_task_state_t state;
+    const void *wait_on;            // Object the task is blocked on, NULL for a delay
+    int64_t wake_us;                // Block deadline, SIM_FOREVER for none
+    bool timed_out;
+    bool woken;                     // Resumed from BLOCKED or preempted since it last ran
+    int64_t busy_left_us;
+    uint64_t ready_seq;             // FIFO order within a priority
+    UBaseType_t number;
+    uint64_t resumes;
+    int64_t run_us;
+    struct tskTaskControlBlock *next;
+};
+
+// Kernel
+int64_t sim_kernel_now(void);
+bool sim_in_isr(void);
+bool sim_in_critical(void);
+TaskHandle_t sim_current_task(void);
+TaskHandle_t sim_task_create(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                             UBaseType_t priority);
+
+// Block the current task on obj until woken or deadline_us; false on timeout.
+// A NULL obj is a plain delay.
+bool sim_block(const void *obj, int64_t deadline_us);
+void sim_wake_all(const void *obj);
+void sim_task_set_deadline(TaskHandle_t task, int64_t deadline_us);
+
+// Deadline of a FreeRTOS timeout of ticks from now, on a tick boundary
+int64_t sim_tick_deadline(TickType_t ticks);
+
+// Hold the CPU for us of modelled work; tasks at higher priority and
+// interrupts still run meanwhile
+void sim_busy(int64_t us);
+
+// Run an interrupt handler now: from a task it preempts it, from the
+// environment it wakes the chip
+void sim_isr_run(void (*fn)(void *), void *arg);
+
+void sim_fatal(const char *format, ...) __attribute__((noreturn, format(printf, 1, 2)));
+uint32_t sim_env_random(void);
+
+// Heap accounting for what the fakes allocate on the device's behalf
+void sim_heap_take(size_t bytes);
+void sim_heap_give(size_t bytes);
+
+// Module hooks
+void sim_system_reset(uint32_t seed);
+void sim_timer_reset(void);
+void sim_timer_start(void);
+void sim_gpio_reset(void);
+void sim_gpio_service(void);
+void sim_periph_reset(void);
+void sim_nvs_reset(void);
+void sim_zigbee_reset(void);
+bool sim_pm_sleep_allowed(void);
+void sim_pm_sleep_exit(int64_t slept_us);
+
+#endif // SIM_INTERNAL_H
@@ -0,0 +1,533 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+
+// Tasks are ucontext coroutines switched from one host thread. A task runs
+// in zero virtual time until it blocks, yields or asks for modelled work
+// (sim_busy); the run loop then picks the highest-priority runnable task, as
+// the FreeRTOS scheduler would, and moves the clock only when nothing is
+// runnable or the picked task is busy. Interrupts come from the environment
+// event list between task slices, or synchronously when a task unmasks a
+// pending GPIO interrupt.
+
+#define TICK_US                 (1000000 / configTICK_RATE_HZ)
+#define STACK_PAINT             0xa5a5a5a5u
+#define STACK_SCAN_RUN_BYTES    4096    // Untouched run that ends a stack scan
+
+typedef struct env_event {
+    int64_t time_us;
+    sim_event_fn_t fn;
+    void *arg;
+    struct env_event *next;
+} env_event_t;
+
+static struct {
+    bool initialized;
+    bool started;
+    int64_t now_us;
+    TaskHandle_t tasks;             // Creation order
+    TaskHandle_t current;           // NULL in the run loop and environment events
+    ucontext_t loop_ctx;
+    int critical;
+    int isr;
+    uint64_t seq;
+    UBaseType_t numbered;
+    env_event_t *events;            // Sorted by time, FIFO for equal times
+    bool idle;
+    bool idle_sleep;
+    int64_t idle_start_us;
+    sim_stats_t stats;
+    uint64_t env_rng;
+} k;
+
+void app_main(void);
+
+void sim_fatal(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fflush(stdout);
+    fprintf(stderr, "sim: fatal at %lld us in %s: ", (long long)k.now_us,
+            k.isr ? "ISR" : k.current ? k.current->name : "environment");
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    abort();
+}
+
+uint32_t sim_env_random(void) {
+    k.env_rng ^= k.env_rng >> 12;
+    k.env_rng ^= k.env_rng << 25;
+    k.env_rng ^= k.env_rng >> 27;
+    return (uint32_t)((k.env_rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+int64_t sim_kernel_now(void) {
+    return k.now_us;
+}
+
+bool sim_in_isr(void) {
+    return k.isr > 0;
+}
+
+bool sim_in_critical(void) {
+    return k.critical > 0;
+}
+
+TaskHandle_t sim_current_task(void) {
+    return k.current;
+}
+
+// Scheduling
+
+static TaskHandle_t pick(void) {
+    TaskHandle_t best = NULL;
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        if (t->state != SIM_TASK_READY && t->state != SIM_TASK_BUSY) continue;
+        if (!best || t->priority > best->priority ||
+            (t->priority == best->priority && t->ready_seq < best->ready_seq)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void make_ready(TaskHandle_t t, bool timed_out) {
+    t->state = SIM_TASK_READY;
+    t->timed_out = timed_out;
+    t->wait_on = NULL;
+    t->wake_us = SIM_FOREVER;
+    t->ready_seq = ++k.seq;
+    t->woken = true;
+}
+
+static void to_loop(void) {
+    TaskHandle_t t = k.current;
+    swapcontext(&t->ctx, &k.loop_ctx);
+}
+
+static void check_preempt(void) {
+    if (!k.current || k.critical || k.isr) return;
+    TaskHandle_t best = pick();
+    if (best && best->priority > k.current->priority) {
+        k.current->woken = true;
+        to_loop();
+    }
+}
+
+static void task_free(TaskHandle_t task) {
+    TaskHandle_t *link = &k.tasks;
+    while (*link != task) link = &(*link)->next;
+    *link = task->next;
+    free(task->stack);
+    free(task);
+}
+
+static void resume(TaskHandle_t t) {
+    if (t->woken) {
+        t->woken = false;
+        t->resumes++;
+        k.stats.switches++;
+    }
+    k.current = t;
+    swapcontext(&k.loop_ctx, &t->ctx);
+    k.current = NULL;
+    if (t->state == SIM_TASK_DELETED) {
+        task_free(t);
+    }
+}
+
+bool sim_block(const void *obj, int64_t deadline_us) {
+    if (!k.current) sim_fatal("blocking call outside a task");
+    if (k.critical || k.isr) sim_fatal("blocking call with interrupts masked");
+    if (deadline_us <= k.now_us) return false;
+    TaskHandle_t t = k.current;
+    t->state = SIM_TASK_BLOCKED;
+    t->wait_on = obj;
+    t->wake_us = deadline_us;
+    t->timed_out = false;
+    to_loop();
+    return !t->timed_out;
+}
+
+void sim_wake_all(const void *obj) {
+    if (!obj) return;
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        if (t->state == SIM_TASK_BLOCKED && t->wait_on == obj) {
+            make_ready(t, false);
+        }
+    }
+    check_preempt();
+}
+
+void sim_task_set_deadline(TaskHandle_t task, int64_t deadline_us) {
+    if (task->state != SIM_TASK_BLOCKED || deadline_us >= task->wake_us) return;
+    if (deadline_us > k.now_us) {
+        task->wake_us = deadline_us;
+        return;
+    }
+    make_ready(task, true);
+    check_preempt();
+}
+
+int64_t sim_tick_deadline(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return SIM_FOREVER;
+    return (k.now_us / TICK_US + (int64_t)ticks) * TICK_US;
+}
+
+void sim_busy(int64_t us) {
+    if (us <= 0) return;
+    if (!k.current || k.critical || k.isr) {
+        // Nothing may preempt this; events due meanwhile are handled late
+        k.now_us += us;
+        k.stats.busy_us += us;
+        if (k.current) k.current->run_us += us;
+        return;
+    }
+    k.current->state = SIM_TASK_BUSY;
+    k.current->busy_left_us = us;
+    to_loop();
+}
+
+// Idle accounting: an idle period ends when a task becomes runnable or an
+// interrupt is taken. It is spent in light sleep if, when it began, the next
+// task deadline was at least CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP ticks
+// away and power management allowed it.
+
+static int64_t next_deadline(void) {
+    int64_t next = SIM_FOREVER;
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        if (t->state == SIM_TASK_BLOCKED && t->wake_us < next) next = t->wake_us;
+    }
+    return next;
+}
+
+static void begin_idle(void) {
+    k.idle = true;
+    k.idle_start_us = k.now_us;
+    int64_t expected = next_deadline() - k.now_us;
+    k.idle_sleep = sim_pm_sleep_allowed() &&
+                   expected >= (int64_t)CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP * TICK_US;
+}
+
+static void end_idle(void) {
+    if (!k.idle) return;
+    k.idle = false;
+    int64_t gap = k.now_us - k.idle_start_us;
+    if (gap <= 0) return;
+    k.stats.wakeups++;
+    k.stats.idle_us += gap;
+    if (k.idle_sleep) {
+        k.stats.sleeps++;
+        k.stats.sleep_us += gap;
+        k.isr++;
+        sim_pm_sleep_exit(gap);
+        k.isr--;
+    }
+}
+
+void sim_isr_run(void (*fn)(void *), void *arg) {
+    end_idle();
+    k.isr++;
+    fn(arg);
+    k.isr--;
+    if (!k.isr && !k.critical) {
+        sim_gpio_service();
+        check_preempt();
+    }
+}
+
+void sim_critical_enter(void) {
+    k.critical++;
+}
+
+void sim_critical_exit(void) {
+    if (k.critical == 0) sim_fatal("unbalanced critical section exit");
+    if (--k.critical == 0 && !k.isr) {
+        sim_gpio_service();
+        check_preempt();
+    }
+}
+
+UBaseType_t sim_interrupt_mask(void) {
+    sim_critical_enter();
+    return 0;
+}
+
+void sim_interrupt_unmask(UBaseType_t state) {
+    sim_critical_exit();
+}
+
+void sim_yield_from_isr(BaseType_t woken) {
+    // The switch happens when the interrupt returns
+}
+
+// Run loop
+
+static int64_t next_event(void) {
+    int64_t next = next_deadline();
+    if (k.events && k.events->time_us < next) next = k.events->time_us;
+    return next;
+}
+
+static void run_due(void) {
+    while (k.events && k.events->time_us <= k.now_us) {
+        env_event_t *event = k.events;
+        k.events = event->next;
+        event->fn(event->arg);
+        free(event);
+    }
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        if (t->state == SIM_TASK_BLOCKED && t->wake_us <= k.now_us) {
+            make_ready(t, true);
+        }
+    }
+}
+
+void sim_run_until(int64_t time_us) {
+    if (!k.started) sim_fatal("sim_run_until() before sim_start()");
+    if (k.current) sim_fatal("sim_run_until() from a task");
+    while (true) {
+        run_due();
+        TaskHandle_t t = pick();
+        if (!t) {
+            if (!k.idle) begin_idle();
+            int64_t next = next_event();
+            if (next > time_us) {
+                if (time_us > k.now_us) k.now_us = time_us;
+                return;
+            }
+            k.now_us = next;
+            continue;
+        }
+        end_idle();
+        if (t->state == SIM_TASK_BUSY) {
+            int64_t end = k.now_us + t->busy_left_us;
+            int64_t next = next_event();
+            if (next < end) end = next;
+            if (time_us < end) end = time_us;
+            if (end <= k.now_us) return;
+            int64_t step = end - k.now_us;
+            k.now_us = end;
+            t->busy_left_us -= step;
+            t->run_us += step;
+            k.stats.busy_us += step;
+            if (t->busy_left_us == 0) t->state = SIM_TASK_READY;
+            continue;
+        }
+        resume(t);
+    }
+}
+
+void sim_run_for(int64_t duration_us) {
+    sim_run_until(k.now_us + duration_us);
+}
+
+int64_t sim_now_us(void) {
+    return k.now_us;
+}
+
+void sim_at(int64_t time_us, sim_event_fn_t fn, void *arg) {
+    env_event_t *event = malloc(sizeof(*event));
+    if (!event) sim_fatal("out of host memory");
+    event->time_us = time_us < k.now_us ? k.now_us : time_us;
+    event->fn = fn;
+    event->arg = arg;
+    env_event_t **link = &k.events;
+    while (*link && (*link)->time_us <= event->time_us) link = &(*link)->next;
+    event->next = *link;
+    *link = event;
+}
+
+void sim_get_stats(sim_stats_t *stats) {
+    *stats = k.stats;
+    if (k.idle) {
+        // Count the idle period in progress without ending it
+        stats->idle_us += k.now_us - k.idle_start_us;
+        if (k.idle_sleep) stats->sleep_us += k.now_us - k.idle_start_us;
+    }
+}
+
+uint64_t sim_task_resumes(const char *name) {
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        if (strcmp(t->name, name) == 0) return t->resumes;
+    }
+    return 0;
+}
+
+void sim_init(uint32_t seed) {
+    // Firmware statics cannot be reset, so a process simulates one boot
+    if (k.initialized) sim_fatal("sim_init() called twice; simulate one boot per process");
+    k.initialized = true;
+    k.env_rng = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)seed << 1) ^ 1;
+    sim_system_reset(seed);
+    sim_timer_reset();
+    sim_gpio_reset();
+    sim_periph_reset();
+    sim_nvs_reset();
+    sim_zigbee_reset();
+}
+
+static void main_task(void *arg) {
+    app_main();
+    vTaskDelete(NULL);
+}
+
+void sim_start(void) {
+    if (!k.initialized) sim_fatal("sim_start() before sim_init()");
+    if (k.started) sim_fatal("sim_start() called twice");
+    k.started = true;
+    sim_timer_start();
+    sim_task_create(main_task, "main", CONFIG_ESP_MAIN_TASK_STACK_SIZE, NULL, 1);
+}
+
+// Tasks
+
+static void task_entry(void) {
+    TaskHandle_t t = k.current;
+    t->fn(t->arg);
+    sim_fatal("task %s returned from its function", t->name);
+}
+
+TaskHandle_t sim_task_create(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                             UBaseType_t priority) {
+    TaskHandle_t t = calloc(1, sizeof(*t));
+    uint32_t *stack = malloc(SIM_HOST_STACK_BYTES);
+    if (!t || !stack) sim_fatal("out of host memory");
+    for (size_t i = 0; i < SIM_HOST_STACK_BYTES / sizeof(uint32_t); i++) {
+        stack[i] = STACK_PAINT;
+    }
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t->fn = fn;
+    t->arg = arg;
+    t->priority = priority < configMAX_PRIORITIES ? priority : configMAX_PRIORITIES - 1;
+    t->stack_depth = stack_depth;
+    t->stack = (uint8_t *)stack;
+    t->stack_mark = SIM_HOST_STACK_BYTES;
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = SIM_HOST_STACK_BYTES;
+    t->ctx.uc_link = NULL;
+    makecontext(&t->ctx, task_entry, 0);
+    t->number = ++k.numbered;
+    make_ready(t, false);
+
+    TaskHandle_t *link = &k.tasks;
+    while (*link) link = &(*link)->next;
+    *link = t;
+    sim_heap_take(SIM_TCB_BYTES + stack_depth);
+    return t;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created) {
+    TaskHandle_t t = sim_task_create(fn, name, stack_depth, arg, priority);
+    if (created) *created = t;
+    check_preempt();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core) {
+    return xTaskCreate(fn, name, stack_depth, arg, priority, created);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (!task) task = k.current;
+    if (!task) sim_fatal("vTaskDelete(NULL) outside a task");
+    sim_heap_give(SIM_TCB_BYTES + task->stack_depth);
+    task->state = SIM_TASK_DELETED;
+    if (task == k.current) {
+        if (k.critical) sim_fatal("task deleted itself in a critical section");
+        to_loop();
+        sim_fatal("deleted task resumed");
+    }
+    task_free(task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        taskYIELD();
+        return;
+    }
+    sim_block(NULL, sim_tick_deadline(ticks));
+}
+
+void taskYIELD(void) {
+    if (!k.current || k.critical || k.isr) return;
+    k.current->ready_seq = ++k.seq;
+    k.current->woken = true;
+    to_loop();
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(k.now_us / TICK_US);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return k.current;
+}
+
+char *pcTaskGetName(TaskHandle_t task) {
+    if (!task) task = k.current;
+    return task ? task->name : NULL;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    UBaseType_t count = 0;
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        count += t->state != SIM_TASK_DELETED;
+    }
+    return count;
+}
+
+// Stacks are painted at creation. Scanning continues down from the deepest
+// point seen so far and stops after a long untouched run, so repeated
+// samples stay cheap; a frame skipping more than that run is missed. The
+// scan reads other tasks' live frames, which AddressSanitizer poisons.
+__attribute__((no_sanitize_address))
+static uint32_t stack_free_bytes(TaskHandle_t t) {
+    const uint32_t *words = (const uint32_t *)t->stack;
+    size_t i = t->stack_mark / sizeof(uint32_t);
+    size_t run = 0;
+    while (i > 0 && run < STACK_SCAN_RUN_BYTES / sizeof(uint32_t)) {
+        i--;
+        if (words[i] != STACK_PAINT) {
+            t->stack_mark = i * sizeof(uint32_t);
+            run = 0;
+        } else {
+            run++;
+        }
+    }
+    size_t used = (SIM_HOST_STACK_BYTES - t->stack_mark) / SIM_STACK_SCALE_DIV;
+    return used < t->stack_depth ? (uint32_t)(t->stack_depth - used) : 0;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    if (!task) task = k.current;
+    return task ? stack_free_bytes(task) : 0;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t count,
+                                 configRUN_TIME_COUNTER_TYPE *total_run_time) {
+    if (count < uxTaskGetNumberOfTasks()) return 0;
+    UBaseType_t filled = 0;
+    for (TaskHandle_t t = k.tasks; t; t = t->next) {
+        if (t->state == SIM_TASK_DELETED) continue;
+        TaskStatus_t *s = &status[filled++];
+        memset(s, 0, sizeof(*s));
+        s->xHandle = t;
+        s->pcTaskName = t->name;
+        s->xTaskNumber = t->number;
+        s->eCurrentState = t == k.current ? eRunning : t->state == SIM_TASK_BLOCKED ? eBlocked : eReady;
+        s->uxCurrentPriority = t->priority;
+        s->uxBasePriority = t->priority;
+        s->ulRunTimeCounter = (configRUN_TIME_COUNTER_TYPE)t->run_us;
+        s->pxStackBase = (StackType_t *)t->stack;
+        s->usStackHighWaterMark = stack_free_bytes(t);
+        s->xCoreID = tskNO_AFFINITY;
+    }
+    if (total_run_time) *total_run_time = (configRUN_TIME_COUNTER_TYPE)k.now_us;
+    return filled;
+}
@@ -0,0 +1,81 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "esp_log.h"
+
+// Log output. Every line goes through the vprintf hook chain the firmware
+// can extend (crash_log.c does) and ends in the console UART: the TX FIFO
+// drains at SIM_UART_BAUD and a writer that finds it full busy-waits, as
+// the ROM console does. Lines are printed on the host from the level set
+// with sim_set_log_level().
+#define UART_BITS_PER_BYTE  10
+#define LOG_LINE_MAX        512
+
+static int uart_vprintf(const char *format, va_list args);
+
+static vprintf_like_t log_vprintf = uart_vprintf;
+static esp_log_level_t host_level = ESP_LOG_WARN;
+static sim_log_hook_t log_hook;
+static esp_log_level_t line_level;      // Level of the line being written
+static int64_t uart_drained_us;         // When the TX FIFO will be empty
+
+void sim_set_log_level(esp_log_level_t level) {
+    host_level = level;
+}
+
+void sim_set_log_hook(sim_log_hook_t hook) {
+    log_hook = hook;
+}
+
+static int64_t byte_us(size_t bytes) {
+    return ((int64_t)bytes * UART_BITS_PER_BYTE * 1000000 + SIM_UART_BAUD - 1) / SIM_UART_BAUD;
+}
+
+static int uart_vprintf(const char *format, va_list args) {
+    char line[LOG_LINE_MAX];
+    int len = vsnprintf(line, sizeof(line), format, args);
+    if (len < 0) return len;
+    size_t bytes = (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1;
+
+    int64_t now = sim_kernel_now();
+    if (uart_drained_us < now) uart_drained_us = now;
+    uart_drained_us += byte_us(bytes);
+    int64_t wait = uart_drained_us - now - byte_us(SIM_UART_FIFO_BYTES);
+
+    if (log_hook) log_hook(line_level, line);
+    if (line_level <= host_level) fputs(line, stdout);
+    sim_busy(wait);
+    return len;
+}
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+    vprintf_like_t previous = log_vprintf;
+    log_vprintf = func;
+    return previous;
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(sim_kernel_now() / 1000);
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    esp_log_level_t outer = line_level;
+    line_level = level;
+    log_vprintf(format, args);
+    line_level = outer;
+    va_end(args);
+}
+
+int esp_rom_printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = vprintf(fmt, args);
+    va_end(args);
+    return len;
+}
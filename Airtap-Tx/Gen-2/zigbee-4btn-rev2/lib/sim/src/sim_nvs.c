@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "nvs_flash.h"
+
+// In-memory NVS. Entries are typed as on the device, so a get of the wrong
+// type fails. A set that does not change the value writes nothing, as the
+// real implementation skips identical entries; sim_nvs_writes() counts the
+// flash writes that remain.
+#define NVS_KEY_MAX     16
+#define NVS_BLOB_MAX    4000
+#define NVS_MAX_HANDLES 8
+
+typedef enum {
+    NVS_TYPE_U8,
+    NVS_TYPE_U16,
+    NVS_TYPE_U32,
+    NVS_TYPE_BLOB,
+} nvs_type_t;
+
+typedef struct nvs_entry {
+    char ns[NVS_KEY_MAX];
+    char key[NVS_KEY_MAX];
+    nvs_type_t type;
+    size_t len;
+    uint8_t *data;
+    struct nvs_entry *next;
+} nvs_entry_t;
+
+typedef struct {
+    char ns[NVS_KEY_MAX];
+    nvs_open_mode_t mode;
+    bool open;
+} nvs_open_t;
+
+static nvs_entry_t *entries;
+static nvs_open_t handles[NVS_MAX_HANDLES];
+static bool initialized;
+static uint32_t writes;
+
+void sim_nvs_reset(void) {
+    while (entries) {
+        nvs_entry_t *next = entries->next;
+        free(entries->data);
+        free(entries);
+        entries = next;
+    }
+    memset(handles, 0, sizeof(handles));
+    initialized = false;
+    writes = 0;
+}
+
+static nvs_entry_t *find(const char *ns, const char *key) {
+    for (nvs_entry_t *e = entries; e; e = e->next) {
+        if (strcmp(e->ns, ns) == 0 && strcmp(e->key, key) == 0) return e;
+    }
+    return NULL;
+}
+
+static bool store(const char *ns, const char *key, nvs_type_t type, const void *data, size_t len) {
+    nvs_entry_t *e = find(ns, key);
+    if (e && e->type == type && e->len == len && memcmp(e->data, data, len) == 0) return false;
+    if (!e) {
+        e = calloc(1, sizeof(*e));
+        if (!e) sim_fatal("out of host memory");
+        snprintf(e->ns, sizeof(e->ns), "%s", ns);
+        snprintf(e->key, sizeof(e->key), "%s", key);
+        e->next = entries;
+        entries = e;
+    }
+    free(e->data);
+    e->data = malloc(len ? len : 1);
+    if (!e->data) sim_fatal("out of host memory");
+    memcpy(e->data, data, len);
+    e->type = type;
+    e->len = len;
+    return true;
+}
+
+static void store_seed(const char *ns, const char *key, nvs_type_t type, const void *data, size_t len) {
+    if (strlen(ns) >= NVS_KEY_MAX || strlen(key) >= NVS_KEY_MAX) sim_fatal("NVS name too long: %s/%s", ns, key);
+    store(ns, key, type, data, len);
+}
+
+void sim_nvs_set_u8(const char *ns, const char *key, uint8_t value) {
+    store_seed(ns, key, NVS_TYPE_U8, &value, sizeof(value));
+}
+
+void sim_nvs_set_u16(const char *ns, const char *key, uint16_t value) {
+    store_seed(ns, key, NVS_TYPE_U16, &value, sizeof(value));
+}
+
+bool sim_nvs_get_u16(const char *ns, const char *key, uint16_t *value) {
+    nvs_entry_t *e = find(ns, key);
+    if (!e || e->type != NVS_TYPE_U16) return false;
+    memcpy(value, e->data, sizeof(*value));
+    return true;
+}
+
+uint32_t sim_nvs_writes(void) {
+    return writes;
+}
+
+esp_err_t nvs_flash_init(void) {
+    if (!initialized) sim_busy(SIM_NVS_INIT_US);
+    initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    sim_nvs_reset();
+    return ESP_OK;
+}
+
+static nvs_open_t *handle_of(nvs_handle_t handle) {
+    if (handle == 0 || handle > NVS_MAX_HANDLES || !handles[handle - 1].open) return NULL;
+    return &handles[handle - 1];
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    if (!initialized) return ESP_ERR_NVS_NOT_INITIALIZED;
+    if (!namespace_name || !out_handle || strlen(namespace_name) >= NVS_KEY_MAX) return ESP_ERR_INVALID_ARG;
+    sim_busy(SIM_NVS_READ_US);
+    if (open_mode == NVS_READONLY) {
+        bool exists = false;
+        for (nvs_entry_t *e = entries; e; e = e->next) {
+            exists |= strcmp(e->ns, namespace_name) == 0;
+        }
+        if (!exists) return ESP_ERR_NVS_NOT_FOUND;
+    }
+    for (int i = 0; i < NVS_MAX_HANDLES; i++) {
+        if (!handles[i].open) {
+            snprintf(handles[i].ns, sizeof(handles[i].ns), "%s", namespace_name);
+            handles[i].mode = open_mode;
+            handles[i].open = true;
+            *out_handle = (nvs_handle_t)(i + 1);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    nvs_open_t *h = handle_of(handle);
+    if (h) h->open = false;
+}
+
+static esp_err_t get(nvs_handle_t handle, const char *key, nvs_type_t type, void *out, size_t len) {
+    nvs_open_t *h = handle_of(handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!key || !out) return ESP_ERR_INVALID_ARG;
+    sim_busy(SIM_NVS_READ_US);
+    nvs_entry_t *e = find(h->ns, key);
+    if (!e || e->type != type) return ESP_ERR_NVS_NOT_FOUND;
+    memcpy(out, e->data, len);
+    return ESP_OK;
+}
+
+static esp_err_t set(nvs_handle_t handle, const char *key, nvs_type_t type, const void *data, size_t len) {
+    nvs_open_t *h = handle_of(handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (h->mode == NVS_READONLY) return ESP_ERR_NVS_READ_ONLY;
+    if (!key || !data || strlen(key) >= NVS_KEY_MAX) return ESP_ERR_INVALID_ARG;
+    if (len > NVS_BLOB_MAX) return ESP_ERR_NVS_INVALID_LENGTH;
+    if (store(h->ns, key, type, data, len)) {
+        writes++;
+        sim_busy(SIM_NVS_WRITE_US);
+    } else {
+        sim_busy(SIM_NVS_READ_US);
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value) {
+    return get(handle, key, NVS_TYPE_U8, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_get_u16(nvs_handle_t handle, const char *key, uint16_t *out_value) {
+    return get(handle, key, NVS_TYPE_U16, out_value, sizeof(*out_value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value) {
+    return get(handle, key, NVS_TYPE_U32, out_value, sizeof(*out_value));
+}
+
+// With out_value NULL only the stored length is returned, as on the device
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    nvs_open_t *h = handle_of(handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!key || !length) return ESP_ERR_INVALID_ARG;
+    sim_busy(SIM_NVS_READ_US);
+    nvs_entry_t *e = find(h->ns, key);
+    if (!e || e->type != NVS_TYPE_BLOB) return ESP_ERR_NVS_NOT_FOUND;
+    if (!out_value) {
+        *length = e->len;
+        return ESP_OK;
+    }
+    if (*length < e->len) {
+        *length = e->len;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, e->data, e->len);
+    *length = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value) {
+    return set(handle, key, NVS_TYPE_U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u16(nvs_handle_t handle, const char *key, uint16_t value) {
+    return set(handle, key, NVS_TYPE_U16, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value) {
+    return set(handle, key, NVS_TYPE_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return set(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    nvs_open_t *h = handle_of(handle);
+    if (!h) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (h->mode == NVS_READONLY) return ESP_ERR_NVS_READ_ONLY;
+    nvs_entry_t **link = &entries;
+    while (*link && !(strcmp((*link)->ns, h->ns) == 0 && strcmp((*link)->key, key) == 0)) {
+        link = &(*link)->next;
+    }
+    if (!*link) return ESP_ERR_NVS_NOT_FOUND;
+    nvs_entry_t *e = *link;
+    *link = e->next;
+    free(e->data);
+    free(e);
+    writes++;
+    sim_busy(SIM_NVS_WRITE_US);
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return handle_of(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
@@ -0,0 +1,337 @@
+#include <math.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "driver/ledc.h"
+#include "driver/i2c.h"
+#include "driver/uart.h"
+#include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_cali.h"
+
+// LEDC, ADC, I2C and the console UART receive side
+
+// LEDC: a duty takes effect when latched; the first rising edge after that
+// is at the next PWM period boundary of the timer
+typedef struct {
+    uint32_t freq_hz;
+    ledc_timer_bit_t resolution;
+    bool configured;
+} ledc_timer_state_t;
+
+typedef struct {
+    int gpio;
+    ledc_timer_t timer;
+    uint32_t duty;          // Set, not yet latched
+    uint32_t latched;
+    bool running;
+    int64_t first_edge_us;
+    bool configured;
+} ledc_channel_state_t;
+
+static ledc_timer_state_t ledc_timers[LEDC_TIMER_MAX];
+static ledc_channel_state_t ledc_channels[LEDC_CHANNEL_MAX];
+
+// ADC: 10 k pull-up from 3.3 V, NTC to ground (B = 3950 K, 10 k at 25 °C),
+// as temperature.c assumes; readings are in millivolts
+#define NTC_R25             10000.0
+#define NTC_BETA            3950.0
+#define NTC_PULL            10000.0
+#define ADC_FULL_SCALE_MV   3300.0
+#define ADC_NOISE_LSB       2
+
+struct adc_oneshot_unit_ctx_t {
+    adc_unit_t unit;
+};
+
+static struct adc_oneshot_unit_ctx_t adc_units[2];
+static bool adc_unit_used[2];
+static double temperature_c;
+
+// I2C: one port, a command list is timed on the bus as a whole
+typedef struct {
+    uint32_t bytes;
+    uint32_t starts;
+    uint32_t magic;
+} i2c_link_t;
+
+#define I2C_LINK_MAGIC      0x12c0112cu
+
+static struct {
+    uint32_t clk_speed;
+    bool configured;
+    bool installed;
+} i2c_port;
+static bool i2c_present;
+static uint32_t i2c_count;
+static uint8_t i2c_bus;             // Wait object
+
+// UART receive buffer for the console
+#define UART_RX_BYTES 256
+static struct {
+    bool installed;
+    uint8_t buf[UART_RX_BYTES];
+    size_t head;
+    size_t count;
+} uart_rx;
+
+void sim_periph_reset(void) {
+    memset(ledc_timers, 0, sizeof(ledc_timers));
+    memset(ledc_channels, 0, sizeof(ledc_channels));
+    memset(adc_unit_used, 0, sizeof(adc_unit_used));
+    temperature_c = 22.0;
+    memset(&i2c_port, 0, sizeof(i2c_port));
+    i2c_present = true;
+    i2c_count = 0;
+    memset(&uart_rx, 0, sizeof(uart_rx));
+}
+
+// LEDC
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf) {
+    if (!timer_conf || timer_conf->timer_num >= LEDC_TIMER_MAX || timer_conf->freq_hz == 0 ||
+        timer_conf->duty_resolution < LEDC_TIMER_1_BIT || timer_conf->duty_resolution >= LEDC_TIMER_BIT_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ledc_timer_state_t *timer = &ledc_timers[timer_conf->timer_num];
+    timer->freq_hz = timer_conf->freq_hz;
+    timer->resolution = timer_conf->duty_resolution;
+    timer->configured = true;
+    return ESP_OK;
+}
+
+static void latch(ledc_channel_state_t *channel) {
+    channel->latched = channel->duty;
+    channel->running = channel->latched > 0;
+    if (channel->running && channel->first_edge_us < 0) {
+        int64_t period_us = 1000000 / ledc_timers[channel->timer].freq_hz;
+        if (period_us <= 0) period_us = 1;
+        channel->first_edge_us = (sim_kernel_now() / period_us + 1) * period_us;
+    }
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf) {
+    if (!ledc_conf || ledc_conf->channel >= LEDC_CHANNEL_MAX || ledc_conf->timer_sel >= LEDC_TIMER_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!ledc_timers[ledc_conf->timer_sel].configured) return ESP_ERR_INVALID_STATE;
+    ledc_channel_state_t *channel = &ledc_channels[ledc_conf->channel];
+    channel->gpio = ledc_conf->gpio_num;
+    channel->timer = ledc_conf->timer_sel;
+    channel->duty = ledc_conf->duty;
+    channel->first_edge_us = -1;
+    channel->configured = true;
+    latch(channel);
+    return ESP_OK;
+}
+
+static ledc_channel_state_t *configured_channel(ledc_channel_t channel) {
+    if (channel >= LEDC_CHANNEL_MAX || !ledc_channels[channel].configured) return NULL;
+    return &ledc_channels[channel];
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty) {
+    ledc_channel_state_t *state = configured_channel(channel);
+    if (!state) return ESP_ERR_INVALID_STATE;
+    state->duty = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    ledc_channel_state_t *state = configured_channel(channel);
+    if (!state) return ESP_ERR_INVALID_STATE;
+    latch(state);
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    ledc_channel_state_t *state = configured_channel(channel);
+    return state ? state->latched : 0;
+}
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level) {
+    ledc_channel_state_t *state = configured_channel(channel);
+    if (!state) return ESP_ERR_INVALID_STATE;
+    state->running = false;
+    state->latched = 0;
+    return ESP_OK;
+}
+
+static ledc_channel_state_t *channel_on_pin(int pin) {
+    for (int i = 0; i < LEDC_CHANNEL_MAX; i++) {
+        if (ledc_channels[i].configured && ledc_channels[i].gpio == pin) return &ledc_channels[i];
+    }
+    return NULL;
+}
+
+int64_t sim_pwm_first_edge_us(int pin) {
+    ledc_channel_state_t *channel = channel_on_pin(pin);
+    return channel ? channel->first_edge_us : -1;
+}
+
+uint32_t sim_pwm_duty(int pin) {
+    ledc_channel_state_t *channel = channel_on_pin(pin);
+    return channel && channel->running ? channel->latched : 0;
+}
+
+uint32_t sim_pwm_duty_max(int pin) {
+    ledc_channel_state_t *channel = channel_on_pin(pin);
+    return channel ? (1u << ledc_timers[channel->timer].resolution) - 1 : 0;
+}
+
+// ADC
+
+void sim_set_temperature(float celsius) {
+    temperature_c = celsius;
+}
+
+esp_err_t adc_oneshot_new_unit(const adc_oneshot_unit_init_cfg_t *init_config, adc_oneshot_unit_handle_t *ret_unit) {
+    if (!init_config || !ret_unit || init_config->unit_id > ADC_UNIT_2) return ESP_ERR_INVALID_ARG;
+    if (adc_unit_used[init_config->unit_id]) return ESP_ERR_NOT_FOUND;
+    adc_unit_used[init_config->unit_id] = true;
+    adc_units[init_config->unit_id].unit = init_config->unit_id;
+    *ret_unit = &adc_units[init_config->unit_id];
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_config_channel(adc_oneshot_unit_handle_t handle, adc_channel_t channel,
+                                     const adc_oneshot_chan_cfg_t *config) {
+    if (!handle || !config || channel > ADC_CHANNEL_6) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_read(adc_oneshot_unit_handle_t handle, adc_channel_t chan, int *out_raw) {
+    if (!handle || !out_raw) return ESP_ERR_INVALID_ARG;
+    sim_busy(SIM_ADC_READ_US);
+    double r = NTC_R25 * exp(NTC_BETA * (1.0 / (temperature_c + 273.15) - 1.0 / 298.15));
+    double mv = ADC_FULL_SCALE_MV * r / (NTC_PULL + r);
+    int raw = (int)lround(mv) + (int)(sim_env_random() % (2 * ADC_NOISE_LSB + 1)) - ADC_NOISE_LSB;
+    *out_raw = raw < 0 ? 0 : raw > 4095 ? 4095 : raw;
+    return ESP_OK;
+}
+
+esp_err_t adc_oneshot_del_unit(adc_oneshot_unit_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    adc_unit_used[handle->unit] = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage) {
+    if (!handle || !voltage) return ESP_ERR_INVALID_ARG;
+    *voltage = raw;
+    return ESP_OK;
+}
+
+// I2C
+
+void sim_i2c_set_present(bool present) {
+    i2c_present = present;
+}
+
+uint32_t sim_i2c_transactions(void) {
+    return i2c_count;
+}
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf) {
+    if (i2c_num != I2C_NUM_0 || !i2c_conf || i2c_conf->mode != I2C_MODE_MASTER) return ESP_ERR_INVALID_ARG;
+    if (i2c_conf->master.clk_speed == 0) return ESP_ERR_INVALID_ARG;
+    i2c_port.clk_speed = i2c_conf->master.clk_speed;
+    i2c_port.configured = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags) {
+    if (i2c_num != I2C_NUM_0 || mode != I2C_MODE_MASTER) return ESP_ERR_INVALID_ARG;
+    if (i2c_port.installed) return ESP_FAIL;
+    i2c_port.installed = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num) {
+    if (i2c_num != I2C_NUM_0 || !i2c_port.installed) return ESP_ERR_INVALID_ARG;
+    i2c_port.installed = false;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t *buffer, uint32_t size) {
+    if (!buffer || size < sizeof(i2c_link_t)) return NULL;
+    i2c_link_t *link = (i2c_link_t *)buffer;
+    *link = (i2c_link_t){ .magic = I2C_LINK_MAGIC };
+    return link;
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd_handle) {
+    if (cmd_handle) ((i2c_link_t *)cmd_handle)->magic = 0;
+}
+
+static i2c_link_t *link_of(i2c_cmd_handle_t cmd_handle) {
+    i2c_link_t *link = cmd_handle;
+    if (!link || link->magic != I2C_LINK_MAGIC) sim_fatal("I2C command link not created");
+    return link;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle) {
+    link_of(cmd_handle)->starts++;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en) {
+    link_of(cmd_handle)->bytes++;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len, bool ack_en) {
+    link_of(cmd_handle)->bytes += data_len;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle) {
+    return ESP_OK;
+}
+
+// The caller waits on the driver's completion semaphore, so it is blocked
+// rather than busy while the bus runs; a missing device NACKs its address
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait) {
+    i2c_link_t *link = link_of(cmd_handle);
+    if (i2c_num != I2C_NUM_0 || !i2c_port.installed) return ESP_ERR_INVALID_STATE;
+    uint32_t bits = i2c_present ? link->bytes * 9 + link->starts * 2 + 1 : 9 + 3;
+    int64_t bus_us = ((int64_t)bits * 1000000 + i2c_port.clk_speed - 1) / i2c_port.clk_speed;
+    sim_block(&i2c_bus, sim_kernel_now() + bus_us);
+    i2c_count++;
+    return i2c_present ? ESP_OK : ESP_FAIL;
+}
+
+// UART
+
+void sim_console_input(const char *text) {
+    for (; *text; text++) {
+        if (uart_rx.count == UART_RX_BYTES) break;
+        uart_rx.buf[(uart_rx.head + uart_rx.count) % UART_RX_BYTES] = (uint8_t)*text;
+        uart_rx.count++;
+    }
+    sim_wake_all(&uart_rx);
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    if (uart_num != CONFIG_ESP_CONSOLE_UART_NUM) return ESP_ERR_INVALID_ARG;
+    if (uart_rx.installed) return ESP_FAIL;
+    uart_rx.installed = true;
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait) {
+    if (uart_num != CONFIG_ESP_CONSOLE_UART_NUM || !uart_rx.installed) return -1;
+    int64_t deadline = sim_tick_deadline(ticks_to_wait);
+    uint8_t *out = buf;
+    uint32_t read = 0;
+    while (read < length) {
+        if (uart_rx.count == 0) {
+            if (!sim_block(&uart_rx, deadline) && uart_rx.count == 0) break;
+            continue;
+        }
+        out[read++] = uart_rx.buf[uart_rx.head];
+        uart_rx.head = (uart_rx.head + 1) % UART_RX_BYTES;
+        uart_rx.count--;
+    }
+    return (int)read;
+}
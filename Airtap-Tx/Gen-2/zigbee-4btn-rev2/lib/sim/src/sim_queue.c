@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "freertos/queue.h"
+
+// Copying FIFO; blocked receivers and senders wait on the queue's two ends
+// and re-check after every wake, as several may be woken at once
+#define QUEUE_OVERHEAD_BYTES 80
+
+struct QueueDefinition {
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t rx;             // Wait objects
+    uint8_t tx;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(*queue));
+    if (!queue) return NULL;
+    queue->items = calloc(length ? length : 1, item_size ? item_size : 1);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    sim_heap_take(QUEUE_OVERHEAD_BYTES + length * item_size);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    sim_heap_give(QUEUE_OVERHEAD_BYTES + queue->length * queue->item_size);
+    free(queue->items);
+    free(queue);
+}
+
+static void put(QueueHandle_t queue, const void *item, bool front) {
+    UBaseType_t slot;
+    if (front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        slot = queue->head;
+    } else {
+        slot = (queue->head + queue->count) % queue->length;
+    }
+    memcpy(queue->items + slot * queue->item_size, item, queue->item_size);
+    queue->count++;
+}
+
+static BaseType_t send(QueueHandle_t queue, const void *item, TickType_t ticks, bool front) {
+    int64_t deadline = sim_tick_deadline(ticks);
+    while (queue->count == queue->length) {
+        if (ticks == 0 || !sim_block(&queue->tx, deadline)) {
+            if (queue->count == queue->length) return errQUEUE_FULL;
+        }
+    }
+    put(queue, item, front);
+    sim_wake_all(&queue->rx);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return send(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    return send(queue, item, ticks, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_prio_woken) {
+    if (queue->count == queue->length) return errQUEUE_FULL;
+    put(queue, item, false);
+    sim_wake_all(&queue->rx);
+    if (higher_prio_woken) *higher_prio_woken = pdTRUE;
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks) {
+    int64_t deadline = sim_tick_deadline(ticks);
+    while (queue->count == 0) {
+        if (ticks == 0 || !sim_block(&queue->rx, deadline)) {
+            if (queue->count == 0) return errQUEUE_EMPTY;
+        }
+    }
+    memcpy(buffer, queue->items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    sim_wake_all(&queue->tx);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->count;
+}
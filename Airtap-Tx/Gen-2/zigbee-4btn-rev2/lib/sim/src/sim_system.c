@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "esp_system.h"
+#include "esp_random.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_trace.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_rom_sys.h"
+#include "esp_core_dump.h"
+#include "esp_cpu.h"
+
+// Reset reason, random numbers, heap accounting, power management and the
+// core dump partition (always empty)
+
+static esp_reset_reason_t reset_reason;
+static uint64_t rng;
+static size_t heap_used;
+static size_t heap_peak;
+
+#define PM_MAX_LOCKS 8
+
+struct esp_pm_lock {
+    esp_pm_lock_type_t type;
+    const char *name;
+    int count;
+};
+
+static struct esp_pm_lock pm_locks[PM_MAX_LOCKS];
+static int pm_lock_count;
+static int pm_locks_held;
+static bool light_sleep_enabled;
+static esp_pm_light_sleep_cb_t sleep_exit_cb;
+static void *sleep_exit_arg;
+
+void sim_system_reset(uint32_t seed) {
+    reset_reason = ESP_RST_POWERON;
+    rng = ((uint64_t)seed << 32) ^ 0xD1B54A32D192ED03ULL;
+    heap_used = 0;
+    heap_peak = 0;
+    pm_lock_count = 0;
+    pm_locks_held = 0;
+    light_sleep_enabled = false;
+    sleep_exit_cb = NULL;
+}
+
+void sim_error_check_failed(esp_err_t rc, const char *file, int line, const char *expression) {
+    sim_fatal("ESP_ERROR_CHECK failed: esp_err_t 0x%x (%s) at %s:%d: %s", rc, esp_err_to_name(rc), file, line,
+              expression);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_INITIALIZED: return "ESP_ERR_NVS_NOT_INITIALIZED";
+    case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_TYPE_MISMATCH: return "ESP_ERR_NVS_TYPE_MISMATCH";
+    case ESP_ERR_NVS_READ_ONLY: return "ESP_ERR_NVS_READ_ONLY";
+    case ESP_ERR_NVS_INVALID_HANDLE: return "ESP_ERR_NVS_INVALID_HANDLE";
+    case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+    case ESP_ERR_NVS_NO_FREE_PAGES: return "ESP_ERR_NVS_NO_FREE_PAGES";
+    case ESP_ERR_NVS_NEW_VERSION_FOUND: return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+// Reset reason
+
+void sim_set_reset_reason(int reason) {
+    reset_reason = (esp_reset_reason_t)reason;
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return reset_reason;
+}
+
+void esp_restart(void) {
+    sim_fatal("esp_restart() called");
+}
+
+void esp_system_abort(const char *details) {
+    sim_fatal("abort: %s", details);
+}
+
+// Random numbers for the firmware, separate from the environment's stream
+
+uint32_t esp_random(void) {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+void esp_fill_random(void *buf, size_t len) {
+    uint8_t *out = buf;
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (uint8_t)esp_random();
+    }
+}
+
+// Heap: accounting only; the memory itself comes from the host
+
+void sim_heap_take(size_t bytes) {
+    heap_used += bytes;
+    if (heap_used > SIM_HEAP_TOTAL_BYTES) sim_fatal("simulated heap exhausted (%zu bytes)", heap_used);
+    if (heap_used > heap_peak) heap_peak = heap_used;
+}
+
+void sim_heap_give(size_t bytes) {
+    heap_used = bytes < heap_used ? heap_used - bytes : 0;
+}
+
+size_t sim_heap_used(void) {
+    return heap_used;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    // The block size is kept in front of the allocation for heap_caps_free()
+    size_t *block = malloc(sizeof(size_t) + size);
+    if (!block) return NULL;
+    *block = size;
+    sim_heap_take(size);
+    return block + 1;
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    void *p = heap_caps_malloc(n * size, caps);
+    if (p) memset(p, 0, n * size);
+    return p;
+}
+
+void heap_caps_free(void *ptr) {
+    if (!ptr) return;
+    size_t *block = (size_t *)ptr - 1;
+    sim_heap_give(*block);
+    free(block);
+}
+
+size_t heap_caps_get_total_size(uint32_t caps) {
+    return SIM_HEAP_TOTAL_BYTES;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return SIM_HEAP_TOTAL_BYTES - heap_used;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    return SIM_HEAP_TOTAL_BYTES - heap_peak;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return SIM_HEAP_TOTAL_BYTES - heap_used;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+}
+
+esp_err_t heap_trace_init_standalone(heap_trace_record_t *record_buffer, size_t num_records) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t heap_trace_start(heap_trace_mode_t mode) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t heap_trace_stop(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t heap_trace_resume(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+size_t heap_trace_get_count(void) {
+    return 0;
+}
+
+esp_err_t heap_trace_get(size_t index, heap_trace_record_t *record) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// Power management: light sleep is taken by the idle accounting in the
+// kernel whenever it is enabled and no lock is held
+
+esp_err_t esp_pm_configure(const void *config) {
+    if (!config) return ESP_ERR_INVALID_ARG;
+    light_sleep_enabled = ((const esp_pm_config_t *)config)->light_sleep_enable;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name, esp_pm_lock_handle_t *out_handle) {
+    if (!out_handle) return ESP_ERR_INVALID_ARG;
+    if (pm_lock_count == PM_MAX_LOCKS) return ESP_ERR_NO_MEM;
+    esp_pm_lock_handle_t lock = &pm_locks[pm_lock_count++];
+    *lock = (struct esp_pm_lock){ .type = lock_type, .name = name };
+    *out_handle = lock;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_delete(esp_pm_lock_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->count) return ESP_ERR_INVALID_STATE;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->count++ == 0) pm_locks_held++;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) {
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->count == 0) return ESP_ERR_INVALID_STATE;
+    if (--handle->count == 0) pm_locks_held--;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_light_sleep_register_cbs(esp_pm_sleep_cbs_register_config_t *cbs_conf) {
+    if (!cbs_conf) return ESP_ERR_INVALID_ARG;
+    sleep_exit_cb = cbs_conf->exit_cb;
+    sleep_exit_arg = cbs_conf->exit_cb_user_arg;
+    return ESP_OK;
+}
+
+bool sim_pm_sleep_allowed(void) {
+    return light_sleep_enabled && pm_locks_held == 0;
+}
+
+void sim_pm_sleep_exit(int64_t slept_us) {
+    if (sleep_exit_cb) sleep_exit_cb(slept_us, sleep_exit_arg);
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) {
+    return ESP_OK;
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    sim_busy(us);
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    return (esp_cpu_cycle_count_t)(sim_kernel_now() * SIM_CPU_MHZ);
+}
+
+// Core dump: the partition never holds an image
+
+esp_err_t esp_core_dump_image_check(void) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_core_dump_get_summary(esp_core_dump_summary_t *summary) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_core_dump_image_erase(void) {
+    return ESP_OK;
+}
@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include "sim_internal.h"
+#include "esp_timer.h"
+
+// esp_timer with ESP_TIMER_TASK dispatch: armed timers sit in a list sorted
+// by expiry and the "esp_timer" task runs the callbacks that are due, then
+// blocks until the earliest remaining one
+#define TIMER_TASK_PRIORITY 22
+#define TIMER_BYTES         64
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    const char *name;
+    int64_t alarm_us;
+    uint64_t period_us;
+    bool armed;
+    struct esp_timer *next;
+};
+
+static esp_timer_handle_t armed;
+static TaskHandle_t timer_task;
+static uint8_t timers_changed;      // Wait object
+
+void sim_timer_reset(void) {
+    armed = NULL;
+    timer_task = NULL;
+}
+
+int64_t esp_timer_get_time(void) {
+    return sim_kernel_now();
+}
+
+static void unlink_timer(esp_timer_handle_t timer) {
+    esp_timer_handle_t *link = &armed;
+    while (*link && *link != timer) link = &(*link)->next;
+    if (*link) *link = timer->next;
+    timer->armed = false;
+}
+
+static void arm(esp_timer_handle_t timer, int64_t alarm_us) {
+    timer->alarm_us = alarm_us;
+    timer->armed = true;
+    esp_timer_handle_t *link = &armed;
+    while (*link && (*link)->alarm_us <= alarm_us) link = &(*link)->next;
+    timer->next = *link;
+    *link = timer;
+    if (timer_task) sim_task_set_deadline(timer_task, armed->alarm_us);
+}
+
+static void timer_task_fn(void *arg) {
+    while (true) {
+        while (armed && armed->alarm_us <= sim_kernel_now()) {
+            esp_timer_handle_t timer = armed;
+            unlink_timer(timer);
+            if (timer->period_us) arm(timer, timer->alarm_us + (int64_t)timer->period_us);
+            timer->callback(timer->arg);
+        }
+        sim_block(&timers_changed, armed ? armed->alarm_us : SIM_FOREVER);
+    }
+}
+
+void sim_timer_start(void) {
+    timer_task = sim_task_create(timer_task_fn, "esp_timer", CONFIG_ESP_TIMER_TASK_STACK_SIZE, NULL,
+                                 TIMER_TASK_PRIORITY);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (!create_args || !create_args->callback || !out_handle) return ESP_ERR_INVALID_ARG;
+    if (create_args->dispatch_method != ESP_TIMER_TASK) return ESP_ERR_NOT_SUPPORTED;
+    esp_timer_handle_t timer = calloc(1, sizeof(*timer));
+    if (!timer) return ESP_ERR_NO_MEM;
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->name = create_args->name;
+    sim_heap_take(TIMER_BYTES);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+    timer->period_us = 0;
+    arm(timer, sim_kernel_now() + (int64_t)timeout_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (!timer || period == 0) return ESP_ERR_INVALID_ARG;
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+    timer->period_us = period;
+    arm(timer, sim_kernel_now() + (int64_t)period);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->armed) return ESP_ERR_INVALID_STATE;
+    unlink_timer(timer);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+    sim_heap_give(TIMER_BYTES);
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->armed;
+}
+
+int64_t esp_timer_get_next_alarm(void) {
+    return armed ? armed->alarm_us : INT64_MAX;
+}
@@ -0,0 +1,629 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "esp_zigbee_core.h"
+#include "esp_system.h"
+
+// Fake Zigbee end device stack. Everything the stack does for the
+// application happens in the task that calls esp_zb_main_loop_iteration():
+// signals, scheduler alarms and attribute writes from the hub are events on
+// one time-sorted list, dispatched with the stack lock held. Between events
+// the task blocks with the lock released, waking for the parent poll every
+// keep_alive ms while joined. With sleep enabled the device is a sleepy end
+// device, so a hub write reaches it at the next poll.
+#define ZB_PAN_ID           0x1a62
+#define ZB_CHANNEL          15
+#define ZB_SHORT_ADDRESS    0x3c4d
+
+typedef enum {
+    EV_SIGNAL,
+    EV_INITIALIZED,
+    EV_STEERING_DONE,
+    EV_LEFT,
+    EV_ALARM,
+    EV_HUB_WRITE,
+} zb_event_kind_t;
+
+typedef struct zb_event {
+    int64_t due_us;
+    zb_event_kind_t kind;
+    esp_zb_app_signal_type_t signal;
+    esp_err_t status;
+    esp_zb_callback_t cb;
+    uint8_t param;
+    esp_zb_zcl_attr_t *attr;        // EV_HUB_WRITE target and value
+    uint16_t cluster;
+    uint8_t *value;
+    struct zb_event *next;
+} zb_event_t;
+
+typedef struct attr_node {
+    esp_zb_zcl_attr_t attr;
+    uint16_t size;
+    struct attr_node *next;
+} attr_node_t;
+
+struct esp_zb_attribute_list_s {
+    uint16_t cluster_id;
+    uint8_t role;
+    attr_node_t *attrs;
+    struct esp_zb_attribute_list_s *next;
+};
+
+struct esp_zb_cluster_list_s {
+    esp_zb_attribute_list_t *clusters;
+};
+
+struct esp_zb_ep_list_s {
+    esp_zb_endpoint_config_t config;
+    esp_zb_cluster_list_t *clusters;
+    struct esp_zb_ep_list_s *next;
+};
+
+static struct {
+    // Network side
+    bool commissioned;
+    bool network;
+    uint32_t fail_permille;
+    bool joined;
+    uint32_t steering_attempts;
+    uint32_t reports;
+    // Stack
+    bool initialized;
+    bool started;
+    bool sleep_enabled;
+    uint32_t keep_alive_ms;
+    esp_zb_ep_list_t *endpoints;
+    esp_zb_core_action_callback_t action_cb;
+    TaskHandle_t task;
+    zb_event_t *events;             // Sorted by due time, FIFO for equal times
+    int64_t next_poll_us;
+    // Stack lock, recursive
+    TaskHandle_t owner;
+    int depth;
+} zb;
+
+void sim_zigbee_reset(void) {
+    memset(&zb, 0, sizeof(zb));
+    zb.network = true;
+}
+
+void sim_zb_set_commissioned(bool commissioned) {
+    zb.commissioned = commissioned;
+}
+
+void sim_zb_set_network(bool available) {
+    zb.network = available;
+}
+
+void sim_zb_set_steering_fail_permille(uint32_t permille) {
+    zb.fail_permille = permille;
+}
+
+bool sim_zb_joined(void) {
+    return zb.joined;
+}
+
+uint32_t sim_zb_steering_attempts(void) {
+    return zb.steering_attempts;
+}
+
+uint32_t sim_zb_reports(void) {
+    return zb.reports;
+}
+
+// Events
+
+static zb_event_t *event_new(zb_event_kind_t kind, int64_t due_us) {
+    zb_event_t *ev = calloc(1, sizeof(*ev));
+    if (!ev) sim_fatal("out of host memory");
+    ev->kind = kind;
+    ev->due_us = due_us;
+    return ev;
+}
+
+static void event_post(zb_event_t *ev) {
+    zb_event_t **link = &zb.events;
+    while (*link && (*link)->due_us <= ev->due_us) link = &(*link)->next;
+    ev->next = *link;
+    *link = ev;
+    if (zb.task) sim_task_set_deadline(zb.task, ev->due_us);
+}
+
+static void signal_post(esp_zb_app_signal_type_t signal, esp_err_t status, int64_t delay_us) {
+    zb_event_t *ev = event_new(EV_SIGNAL, sim_kernel_now() + delay_us);
+    ev->signal = signal;
+    ev->status = status;
+    event_post(ev);
+}
+
+static void signal_deliver(esp_zb_app_signal_type_t signal, esp_err_t status) {
+    uint32_t sig = signal;
+    esp_zb_app_signal_t s = { .p_app_signal = &sig, .esp_err_status = status };
+    esp_zb_app_signal_handler(&s);
+}
+
+// Attributes
+
+static uint16_t value_size(uint8_t type, const void *value) {
+    switch (type) {
+    case ESP_ZB_ZCL_ATTR_TYPE_U16:
+    case ESP_ZB_ZCL_ATTR_TYPE_S16:
+        return 2;
+    case ESP_ZB_ZCL_ATTR_TYPE_U32:
+        return 4;
+    case ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING:
+    case ESP_ZB_ZCL_ATTR_TYPE_CHAR_STRING:
+        return (uint16_t)(*(const uint8_t *)value + 1);
+    default:
+        return 1;
+    }
+}
+
+static esp_err_t attr_add(esp_zb_attribute_list_t *list, uint16_t id, uint8_t type, uint8_t access, const void *value) {
+    if (!list || !value) return ESP_ERR_INVALID_ARG;
+    attr_node_t **link = &list->attrs;
+    while (*link) {
+        if ((*link)->attr.id == id) return ESP_ERR_INVALID_ARG;
+        link = &(*link)->next;
+    }
+    uint16_t size = value_size(type, value);
+    attr_node_t *node = calloc(1, sizeof(*node));
+    uint8_t *data = malloc(size);
+    if (!node || !data) sim_fatal("out of host memory");
+    memcpy(data, value, size);
+    node->attr = (esp_zb_zcl_attr_t){ .id = id, .type = type, .access = access, .data_p = data };
+    node->size = size;
+    *link = node;
+    sim_heap_take(sizeof(*node) + size);
+    return ESP_OK;
+}
+
+static attr_node_t *attr_find(uint8_t endpoint, uint16_t cluster_id, uint8_t role, uint16_t attr_id) {
+    for (esp_zb_ep_list_t *ep = zb.endpoints; ep; ep = ep->next) {
+        if (ep->config.endpoint != endpoint || !ep->clusters) continue;
+        for (esp_zb_attribute_list_t *c = ep->clusters->clusters; c; c = c->next) {
+            if (c->cluster_id != cluster_id || c->role != role) continue;
+            for (attr_node_t *a = c->attrs; a; a = a->next) {
+                if (a->attr.id == attr_id) return a;
+            }
+        }
+    }
+    return NULL;
+}
+
+static attr_node_t *attr_of(const esp_zb_zcl_attr_t *attr) {
+    return (attr_node_t *)((uint8_t *)attr - offsetof(attr_node_t, attr));
+}
+
+// Store a value; true if the stored bytes changed. Strings keep the size
+// they were created with.
+static bool attr_store(attr_node_t *node, const void *value) {
+    uint16_t size = value_size(node->attr.type, value);
+    if (size > node->size) size = node->size;
+    if (memcmp(node->attr.data_p, value, size) == 0) return false;
+    memcpy(node->attr.data_p, value, size);
+    return true;
+}
+
+esp_zb_attribute_list_t *esp_zb_zcl_attr_list_create(uint16_t cluster_id) {
+    esp_zb_attribute_list_t *list = calloc(1, sizeof(*list));
+    if (!list) sim_fatal("out of host memory");
+    list->cluster_id = cluster_id;
+    sim_heap_take(sizeof(*list));
+    return list;
+}
+
+esp_zb_attribute_list_t *esp_zb_basic_cluster_create(esp_zb_basic_cluster_cfg_t *basic_cfg) {
+    esp_zb_attribute_list_t *list = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_BASIC);
+    attr_add(list, ESP_ZB_ZCL_ATTR_BASIC_ZCL_VERSION_ID, ESP_ZB_ZCL_ATTR_TYPE_U8, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+             &basic_cfg->zcl_version);
+    attr_add(list, ESP_ZB_ZCL_ATTR_BASIC_POWER_SOURCE_ID, ESP_ZB_ZCL_ATTR_TYPE_8BIT_ENUM, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+             &basic_cfg->power_source);
+    return list;
+}
+
+esp_zb_attribute_list_t *esp_zb_identify_cluster_create(esp_zb_identify_cluster_cfg_t *identify_cfg) {
+    esp_zb_attribute_list_t *list = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_IDENTIFY);
+    attr_add(list, ESP_ZB_ZCL_ATTR_IDENTIFY_IDENTIFY_TIME_ID, ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+             &identify_cfg->identify_time);
+    return list;
+}
+
+esp_zb_attribute_list_t *esp_zb_on_off_cluster_create(esp_zb_on_off_cluster_cfg_t *on_off_cfg) {
+    esp_zb_attribute_list_t *list = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF);
+    attr_add(list, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, ESP_ZB_ZCL_ATTR_TYPE_BOOL,
+             ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &on_off_cfg->on_off);
+    return list;
+}
+
+esp_zb_attribute_list_t *esp_zb_level_cluster_create(esp_zb_level_cluster_cfg_t *level_cfg) {
+    esp_zb_attribute_list_t *list = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL);
+    attr_add(list, ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, ESP_ZB_ZCL_ATTR_TYPE_U8,
+             ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &level_cfg->current_level);
+    return list;
+}
+
+esp_zb_attribute_list_t *esp_zb_temperature_meas_cluster_create(esp_zb_temperature_meas_cluster_cfg_t *temperature_cfg) {
+    esp_zb_attribute_list_t *list = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT);
+    attr_add(list, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_S16,
+             ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &temperature_cfg->measured_value);
+    attr_add(list, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MIN_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_S16,
+             ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &temperature_cfg->min_value);
+    attr_add(list, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MAX_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_S16,
+             ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &temperature_cfg->max_value);
+    return list;
+}
+
+esp_err_t esp_zb_basic_cluster_add_attr(esp_zb_attribute_list_t *attr_list, uint16_t attr_id, void *value_p) {
+    switch (attr_id) {
+    case ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID:
+    case ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID:
+    case ESP_ZB_ZCL_ATTR_BASIC_SW_BUILD_ID:
+        return attr_add(attr_list, attr_id, ESP_ZB_ZCL_ATTR_TYPE_CHAR_STRING, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, value_p);
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+esp_err_t esp_zb_custom_cluster_add_custom_attr(esp_zb_attribute_list_t *attr_list, uint16_t attr_id, uint8_t attr_type,
+                                                uint8_t attr_access, void *value_p) {
+    return attr_add(attr_list, attr_id, attr_type, attr_access, value_p);
+}
+
+esp_zb_cluster_list_t *esp_zb_zcl_cluster_list_create(void) {
+    esp_zb_cluster_list_t *list = calloc(1, sizeof(*list));
+    if (!list) sim_fatal("out of host memory");
+    sim_heap_take(sizeof(*list));
+    return list;
+}
+
+static esp_err_t cluster_add(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list, uint16_t cluster_id,
+                             uint8_t role_mask) {
+    if (!cluster_list || !attr_list) return ESP_ERR_INVALID_ARG;
+    if (attr_list->cluster_id != cluster_id) return ESP_ERR_INVALID_ARG;
+    attr_list->role = role_mask;
+    esp_zb_attribute_list_t **link = &cluster_list->clusters;
+    while (*link) {
+        if ((*link)->cluster_id == cluster_id && (*link)->role == role_mask) return ESP_ERR_INVALID_ARG;
+        link = &(*link)->next;
+    }
+    *link = attr_list;
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_cluster_list_add_basic_cluster(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list,
+                                                uint8_t role_mask) {
+    return cluster_add(cluster_list, attr_list, ESP_ZB_ZCL_CLUSTER_ID_BASIC, role_mask);
+}
+
+esp_err_t esp_zb_cluster_list_add_identify_cluster(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list,
+                                                   uint8_t role_mask) {
+    return cluster_add(cluster_list, attr_list, ESP_ZB_ZCL_CLUSTER_ID_IDENTIFY, role_mask);
+}
+
+esp_err_t esp_zb_cluster_list_add_on_off_cluster(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list,
+                                                 uint8_t role_mask) {
+    return cluster_add(cluster_list, attr_list, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, role_mask);
+}
+
+esp_err_t esp_zb_cluster_list_add_level_cluster(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list,
+                                                uint8_t role_mask) {
+    return cluster_add(cluster_list, attr_list, ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL, role_mask);
+}
+
+esp_err_t esp_zb_cluster_list_add_temperature_meas_cluster(esp_zb_cluster_list_t *cluster_list,
+                                                           esp_zb_attribute_list_t *attr_list, uint8_t role_mask) {
+    return cluster_add(cluster_list, attr_list, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, role_mask);
+}
+
+esp_err_t esp_zb_cluster_list_add_custom_cluster(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list,
+                                                 uint8_t role_mask) {
+    return cluster_add(cluster_list, attr_list, attr_list ? attr_list->cluster_id : 0, role_mask);
+}
+
+esp_zb_ep_list_t *esp_zb_ep_list_create(void) {
+    esp_zb_ep_list_t *list = calloc(1, sizeof(*list));
+    if (!list) sim_fatal("out of host memory");
+    sim_heap_take(sizeof(*list));
+    return list;
+}
+
+// The list head holds the first endpoint; further ones are chained after it
+esp_err_t esp_zb_ep_list_add_ep(esp_zb_ep_list_t *ep_list, esp_zb_cluster_list_t *cluster_list,
+                                esp_zb_endpoint_config_t endpoint_config) {
+    if (!ep_list || !cluster_list) return ESP_ERR_INVALID_ARG;
+    esp_zb_ep_list_t *ep = ep_list;
+    if (ep_list->clusters) {
+        ep = esp_zb_ep_list_create();
+        while (ep_list->next) ep_list = ep_list->next;
+        ep_list->next = ep;
+    }
+    ep->config = endpoint_config;
+    ep->clusters = cluster_list;
+    return ESP_OK;
+}
+
+esp_zb_zcl_attr_t *esp_zb_zcl_get_attribute(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role, uint16_t attr_id) {
+    attr_node_t *node = attr_find(endpoint, cluster_id, cluster_role, attr_id);
+    return node ? &node->attr : NULL;
+}
+
+esp_zb_zcl_status_t esp_zb_zcl_set_attribute_val(uint8_t endpoint, uint16_t cluster_id, uint8_t cluster_role,
+                                                 uint16_t attr_id, void *value_p, bool check) {
+    attr_node_t *node = attr_find(endpoint, cluster_id, cluster_role, attr_id);
+    if (!node || !value_p) return ESP_ZB_ZCL_STATUS_FAIL;
+    if (attr_store(node, value_p) && zb.joined && (node->attr.access & ESP_ZB_ZCL_ATTR_ACCESS_REPORTING)) {
+        zb.reports++;
+    }
+    return ESP_ZB_ZCL_STATUS_SUCCESS;
+}
+
+// Stack setup
+
+esp_err_t esp_zb_platform_config(esp_zb_platform_config_t *config) {
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void esp_zb_init(esp_zb_cfg_t *nwk_cfg) {
+    if (nwk_cfg->esp_zb_role != ESP_ZB_DEVICE_TYPE_ED) sim_fatal("only the end device role is simulated");
+    zb.keep_alive_ms = nwk_cfg->nwk_cfg.zed_cfg.keep_alive;
+    zb.initialized = true;
+}
+
+esp_err_t esp_zb_device_register(esp_zb_ep_list_t *ep_list) {
+    if (!zb.initialized || !ep_list) return ESP_ERR_INVALID_STATE;
+    zb.endpoints = ep_list;
+    return ESP_OK;
+}
+
+void esp_zb_core_action_handler_register(esp_zb_core_action_callback_t cb) {
+    zb.action_cb = cb;
+}
+
+esp_err_t esp_zb_set_primary_network_channel_set(uint32_t channel_mask) {
+    return ESP_OK;
+}
+
+esp_err_t esp_zb_start(bool autostart) {
+    if (!zb.initialized || zb.started) return ESP_ERR_INVALID_STATE;
+    zb.started = true;
+    if (autostart) {
+        esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
+    } else {
+        signal_post(ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP, ESP_OK, 0);
+    }
+    return ESP_OK;
+}
+
+void esp_zb_sleep_enable(bool enable) {
+    zb.sleep_enabled = enable;
+}
+
+// Light sleep is taken by the idle accounting in the kernel
+void esp_zb_sleep_now(void) {
+}
+
+// Stack lock
+
+bool esp_zb_lock_acquire(TickType_t block_ticks) {
+    TaskHandle_t self = sim_current_task();
+    int64_t deadline = sim_tick_deadline(block_ticks);
+    while (zb.owner && zb.owner != self) {
+        if (sim_kernel_now() >= deadline) return false;
+        sim_block(&zb.owner, deadline);
+    }
+    zb.owner = self;
+    zb.depth++;
+    return true;
+}
+
+void esp_zb_lock_release(void) {
+    if (zb.owner != sim_current_task() || zb.depth == 0) sim_fatal("Zigbee lock released by a task not holding it");
+    if (--zb.depth == 0) {
+        zb.owner = NULL;
+        sim_wake_all(&zb.owner);
+    }
+}
+
+// Commissioning
+
+esp_err_t esp_zb_bdb_start_top_level_commissioning(uint8_t mode_mask) {
+    if (!zb.started) return ESP_ERR_INVALID_STATE;
+    int64_t now = sim_kernel_now();
+    if (mode_mask == ESP_ZB_BDB_MODE_INITIALIZATION) {
+        event_post(event_new(EV_INITIALIZED, now + SIM_ZB_INIT_US));
+    } else if (mode_mask == ESP_ZB_BDB_MODE_NETWORK_STEERING) {
+        zb.steering_attempts++;
+        event_post(event_new(EV_STEERING_DONE, now + SIM_ZB_STEERING_US));
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return ESP_OK;
+}
+
+bool esp_zb_bdb_is_factory_new(void) {
+    return !zb.commissioned;
+}
+
+void esp_zb_bdb_reset_via_local_action(void) {
+    event_post(event_new(EV_LEFT, sim_kernel_now() + SIM_ZB_LEAVE_US));
+}
+
+void esp_zb_factory_reset(void) {
+    zb.commissioned = false;
+    zb.joined = false;
+    esp_restart();
+}
+
+void esp_zb_get_extended_pan_id(esp_zb_ieee_addr_t ext_pan_id) {
+    static const esp_zb_ieee_addr_t id = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 };
+    memcpy(ext_pan_id, zb.joined ? id : (const esp_zb_ieee_addr_t){ 0 }, sizeof(esp_zb_ieee_addr_t));
+}
+
+uint16_t esp_zb_get_pan_id(void) {
+    return zb.joined ? ZB_PAN_ID : 0xffff;
+}
+
+uint8_t esp_zb_get_current_channel(void) {
+    return zb.joined ? ZB_CHANNEL : 0;
+}
+
+uint16_t esp_zb_get_short_address(void) {
+    return zb.joined ? ZB_SHORT_ADDRESS : 0xfffe;
+}
+
+const char *esp_zb_zdo_signal_to_string(esp_zb_app_signal_type_t signal) {
+    switch (signal) {
+    case ESP_ZB_ZDO_SIGNAL_DEFAULT_START: return "ZDO_SIGNAL_DEFAULT_START";
+    case ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP: return "ZDO_SIGNAL_SKIP_STARTUP";
+    case ESP_ZB_ZDO_SIGNAL_DEVICE_ANNCE: return "ZDO_SIGNAL_DEVICE_ANNCE";
+    case ESP_ZB_ZDO_SIGNAL_LEAVE: return "ZDO_SIGNAL_LEAVE";
+    case ESP_ZB_ZDO_SIGNAL_ERROR: return "ZDO_SIGNAL_ERROR";
+    case ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START: return "BDB_SIGNAL_DEVICE_FIRST_START";
+    case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT: return "BDB_SIGNAL_DEVICE_REBOOT";
+    case ESP_ZB_BDB_SIGNAL_STEERING: return "BDB_SIGNAL_STEERING";
+    case ESP_ZB_BDB_SIGNAL_FORMATION: return "BDB_SIGNAL_FORMATION";
+    case ESP_ZB_ZDO_SIGNAL_PRODUCTION_CONFIG_READY: return "ZDO_SIGNAL_PRODUCTION_CONFIG_READY";
+    case ESP_ZB_COMMON_SIGNAL_CAN_SLEEP: return "COMMON_SIGNAL_CAN_SLEEP";
+    default: return "UNKNOWN";
+    }
+}
+
+void esp_zb_scheduler_alarm(esp_zb_callback_t cb, uint8_t param, uint32_t time) {
+    zb_event_t *ev = event_new(EV_ALARM, sim_kernel_now() + (int64_t)time * 1000);
+    ev->cb = cb;
+    ev->param = param;
+    event_post(ev);
+}
+
+// The hub
+
+static void hub_write_deliver(zb_event_t *ev) {
+    if (!zb.joined) return;
+    attr_node_t *node = attr_of(ev->attr);
+    attr_store(node, ev->value);
+    if (!zb.action_cb) return;
+    esp_zb_zcl_set_attr_value_message_t message = {
+        .info = {
+            .status = ESP_ZB_ZCL_STATUS_SUCCESS,
+            .dst_endpoint = zb.endpoints->config.endpoint,
+            .src_endpoint = 1,
+            .cluster = ev->cluster,
+            .profile = zb.endpoints->config.app_profile_id,
+        },
+        .attribute = {
+            .id = node->attr.id,
+            .data = { .type = node->attr.type, .size = node->size, .value = node->attr.data_p },
+        },
+    };
+    zb.action_cb(ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID, &message);
+}
+
+// The hub addresses the first endpoint, as this device has only one
+bool sim_zb_hub_write(uint16_t cluster, uint16_t attr, const void *value) {
+    if (!zb.joined || !zb.endpoints || !value) return false;
+    attr_node_t *node = attr_find(zb.endpoints->config.endpoint, cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr);
+    if (!node || !(node->attr.access & ESP_ZB_ZCL_ATTR_ACCESS_WRITE_ONLY)) return false;
+    int64_t now = sim_kernel_now();
+    bool sleepy = zb.sleep_enabled && zb.keep_alive_ms > 0;
+    zb_event_t *ev = event_new(EV_HUB_WRITE, sleepy && zb.next_poll_us > now ? zb.next_poll_us : now);
+    ev->attr = &node->attr;
+    ev->cluster = cluster;
+    uint16_t size = value_size(node->attr.type, value);
+    ev->value = malloc(size);
+    if (!ev->value) sim_fatal("out of host memory");
+    memcpy(ev->value, value, size);
+    event_post(ev);
+    return true;
+}
+
+bool sim_zb_hub_read(uint16_t cluster, uint16_t attr, void *value, size_t size) {
+    if (!zb.joined || !zb.endpoints || !value) return false;
+    attr_node_t *node = attr_find(zb.endpoints->config.endpoint, cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr);
+    if (!node) return false;
+    memcpy(value, node->attr.data_p, size < node->size ? size : node->size);
+    return true;
+}
+
+// Stack loop
+
+static void join(void) {
+    zb.joined = true;
+    zb.commissioned = true;
+    zb.next_poll_us = sim_kernel_now() + (int64_t)zb.keep_alive_ms * 1000;
+}
+
+static void dispatch(zb_event_t *ev) {
+    switch (ev->kind) {
+    case EV_SIGNAL:
+        signal_deliver(ev->signal, ev->status);
+        break;
+    case EV_INITIALIZED:
+        if (zb.commissioned) {
+            join();
+            signal_deliver(ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT, ESP_OK);
+        } else {
+            signal_deliver(ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START, ESP_OK);
+        }
+        break;
+    case EV_STEERING_DONE:
+        if (zb.network && sim_env_random() % 1000 >= zb.fail_permille) {
+            join();
+            signal_deliver(ESP_ZB_BDB_SIGNAL_STEERING, ESP_OK);
+        } else {
+            signal_deliver(ESP_ZB_BDB_SIGNAL_STEERING, ESP_FAIL);
+        }
+        break;
+    case EV_LEFT:
+        zb.joined = false;
+        zb.commissioned = false;
+        signal_deliver(ESP_ZB_ZDO_SIGNAL_LEAVE, ESP_OK);
+        break;
+    case EV_ALARM:
+        ev->cb(ev->param);
+        break;
+    case EV_HUB_WRITE:
+        hub_write_deliver(ev);
+        break;
+    }
+}
+
+void esp_zb_main_loop_iteration(void) {
+    if (!zb.started) sim_fatal("esp_zb_main_loop_iteration() before esp_zb_start()");
+    zb.task = sim_current_task();
+    esp_zb_lock_acquire(portMAX_DELAY);
+    while (true) {
+        bool worked = false;
+        while (zb.events && zb.events->due_us <= sim_kernel_now()) {
+            zb_event_t *ev = zb.events;
+            zb.events = ev->next;
+            dispatch(ev);
+            free(ev->value);
+            free(ev);
+            worked = true;
+        }
+        if (zb.joined && zb.keep_alive_ms > 0 && sim_kernel_now() >= zb.next_poll_us) {
+            zb.next_poll_us = sim_kernel_now() + (int64_t)zb.keep_alive_ms * 1000;
+            sim_busy(SIM_ZB_POLL_US);
+            continue;
+        }
+        if (worked && zb.sleep_enabled) signal_deliver(ESP_ZB_COMMON_SIGNAL_CAN_SLEEP, ESP_OK);
+
+        int64_t next = zb.events ? zb.events->due_us : SIM_FOREVER;
+        if (zb.joined && zb.keep_alive_ms > 0 && zb.next_poll_us < next) next = zb.next_poll_us;
+
+        // Wait for the next event with the lock released, as the stack does
+        int depth = zb.depth;
+        zb.depth = 0;
+        zb.owner = NULL;
+        sim_wake_all(&zb.owner);
+        sim_block(&zb.events, next);
+        esp_zb_lock_acquire(portMAX_DELAY);
+        zb.depth = depth;
+    }
+}
+
+void esp_zb_stack_main_loop(void) {
+    esp_zb_main_loop_iteration();
+}
@@ -0,0 +1,145 @@
+#include "alloc_track.h"
+#include "console.h"
+#include "scheduler.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_trace.h"
+#include "esp_system.h"
+#include <stdio.h>
+
+static const char *TAG = "ALLOC";
+
+#if CONFIG_AIRTAP_ALLOC_TRACK
+
+// Updated from the heap hooks, which run inside the allocator with its lock
+// held; they must not allocate, log or block
+static volatile uint32_t alloc_count = 0;
+static volatile uint32_t free_count = 0;
+static volatile uint32_t alloc_bytes = 0;
+static volatile bool sealed = false;
+
+// Per-second rate, sampled by the rate job
+static uint32_t last_alloc_count = 0;
+static uint32_t last_second_allocs = 0;
+static uint32_t peak_second_allocs = 0;
+static sched_job_t rate_job;
+
+#if CONFIG_HEAP_TRACING_STANDALONE
+static heap_trace_record_t trace_records[CONFIG_AIRTAP_ALLOC_TRACK_RECORDS];
+#endif
+
+#if CONFIG_AIRTAP_ALLOC_ASSERT
+static sched_job_t seal_job;
+
+static void seal_job_callback(sched_job_t *job, void *arg) {
+    ESP_LOGI(TAG, "Boot allocations done (%lu), further allocations will abort", (unsigned long)alloc_count);
+    sealed = true;
+}
+#endif
+
+// Hook names and signatures are defined by the heap component
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+    alloc_count++;
+    alloc_bytes += size;
+    if (sealed) {
+        esp_system_abort("heap allocation after boot");
+    }
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr) {
+    free_count++;
+}
+
+// Logs only when something allocated, so a clean steady state stays quiet
+static void rate_job_callback(sched_job_t *job, void *arg) {
+    uint32_t count = alloc_count;
+    last_second_allocs = count - last_alloc_count;
+    last_alloc_count = count;
+    if (last_second_allocs > peak_second_allocs) {
+        peak_second_allocs = last_second_allocs;
+    }
+    if (last_second_allocs > 0) {
+        ESP_LOGD(TAG, "%lu allocations in the last second", (unsigned long)last_second_allocs);
+    }
+}
+
+#if CONFIG_HEAP_TRACING_STANDALONE
+typedef struct {
+    void *caller;
+    uint32_t count;
+    uint32_t bytes;
+} alloc_site_t;
+
+// Group the recorded allocations by their immediate caller
+static void dump_sites(void) {
+    alloc_site_t sites[ALLOC_TRACK_MAX_SITES] = {0};
+    int num_sites = 0;
+    uint32_t other = 0;
+
+    heap_trace_stop();
+    size_t count = heap_trace_get_count();
+    for (size_t i = 0; i < count; i++) {
+        heap_trace_record_t rec;
+        if (heap_trace_get(i, &rec) != ESP_OK) continue;
+        void *caller = rec.alloced_by[0];
+        int s = 0;
+        while (s < num_sites && sites[s].caller != caller) s++;
+        if (s == num_sites) {
+            if (num_sites == ALLOC_TRACK_MAX_SITES) {
+                other++;
+                continue;
+            }
+            sites[num_sites++].caller = caller;
+        }
+        sites[s].count++;
+        sites[s].bytes += rec.size;
+    }
+    heap_trace_resume();
+
+    printf("Call sites (decode with addr2line):\n");
+    for (int s = 0; s < num_sites; s++) {
+        printf("  %p  %5lu allocs  %7lu bytes\n", sites[s].caller,
+               (unsigned long)sites[s].count, (unsigned long)sites[s].bytes);
+    }
+    if (other) {
+        printf("  (%lu more at other sites)\n", (unsigned long)other);
+    }
+}
+#endif
+
+void alloc_track_dump(void) {
+    printf("Heap allocs %lu, frees %lu, %lu bytes allocated\n",
+           (unsigned long)alloc_count, (unsigned long)free_count, (unsigned long)alloc_bytes);
+    printf("Last second %lu allocs, peak %lu/s, heap free %lu (min %lu)\n",
+           (unsigned long)last_second_allocs, (unsigned long)peak_second_allocs,
+           (unsigned long)heap_caps_get_free_size(MALLOC_CAP_DEFAULT),
+           (unsigned long)heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT));
+#if CONFIG_HEAP_TRACING_STANDALONE
+    dump_sites();
+#endif
+}
+
+void alloc_track_init(void) {
+#if CONFIG_HEAP_TRACING_STANDALONE
+    ESP_ERROR_CHECK(heap_trace_init_standalone(trace_records, CONFIG_AIRTAP_ALLOC_TRACK_RECORDS));
+    ESP_ERROR_CHECK(heap_trace_start(HEAP_TRACE_ALL));
+#endif
+    scheduler_job_init(&rate_job, "alloc_rate", rate_job_callback, NULL);
+    scheduler_start(&rate_job, 1000, 1000, 0);
+#if CONFIG_AIRTAP_ALLOC_ASSERT
+    scheduler_job_init(&seal_job, "alloc_seal", seal_job_callback, NULL);
+    scheduler_start(&seal_job, CONFIG_AIRTAP_ALLOC_SEAL_MS, 0, 0);
+#endif
+    console_register("allocs", "heap allocation counters", alloc_track_dump);
+    ESP_LOGI(TAG, "Allocation tracking on, %lu allocations so far", (unsigned long)alloc_count);
+}
+
+#else
+
+void alloc_track_init(void) {}
+void alloc_track_dump(void) {
+    ESP_LOGW(TAG, "Allocation tracking disabled (CONFIG_AIRTAP_ALLOC_TRACK)");
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Heap allocation counters (CONFIG_AIRTAP_ALLOC_TRACK)
+#define ALLOC_TRACK_MAX_SITES   16
+
+// Function prototypes
+void alloc_track_init(void);
+void alloc_track_dump(void);
+
+#endif // ALLOC_TRACK_H
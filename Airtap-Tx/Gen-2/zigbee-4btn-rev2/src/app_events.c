@@ -0,0 +1,38 @@
+#include "app_events.h"
+
+static const char *TAG = "APP_EVENTS";
+
+static QueueHandle_t event_queue = NULL;
+
+void app_events_init(void) {
+    event_queue = xQueueCreate(APP_EVENT_QUEUE_LEN, sizeof(app_event_t));
+    if (event_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create event queue");
+        return;
+    }
+    ESP_LOGI(TAG, "Event queue initialized");
+}
+
+bool app_events_post(app_event_type_t type, uint32_t data) {
+    if (event_queue == NULL) return false;
+    app_event_t event = { .type = type, .data = data };
+    if (xQueueSend(event_queue, &event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Event queue full, dropping event %d", type);
+        return false;
+    }
+    return true;
+}
+
+bool app_events_post_from_isr(app_event_type_t type, uint32_t data, BaseType_t *higher_prio_woken) {
+    if (event_queue == NULL) return false;
+    app_event_t event = { .type = type, .data = data };
+    return xQueueSendFromISR(event_queue, &event, higher_prio_woken) == pdTRUE;
+}
+
+bool app_events_wait(app_event_t *event, TickType_t timeout) {
+    if (event_queue == NULL) {
+        vTaskDelay(timeout);
+        return false;
+    }
+    return xQueueReceive(event_queue, event, timeout) == pdTRUE;
+}
@@ -0,0 +1,33 @@
+#ifndef APP_EVENTS_H
+#define APP_EVENTS_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+// Queue depth for events waiting on the main loop
+#define APP_EVENT_QUEUE_LEN 16
+
+// Events that wake the main loop
+typedef enum {
+    APP_EVENT_NONE = 0,
+    APP_EVENT_BUTTON,           // Debounced button events are queued in buttons.c
+    APP_EVENT_STATE_CHANGED,    // device_state has undelivered changes
+    APP_EVENT_SCHEDULE_CHANGED, // A job was scheduled from another task
+    APP_EVENT_DISPLAY_READY,    // The OLED finished its init sequence
+    APP_EVENT_COMMAND,          // The Zigbee task queued commands
+    APP_EVENT_PANEL_BLOCKED,    // A button press was refused while the panel is locked
+} app_event_type_t;
+
+typedef struct {
+    app_event_type_t type;
+    uint32_t data;
+} app_event_t;
+
+// Function prototypes
+void app_events_init(void);
+bool app_events_post(app_event_type_t type, uint32_t data);
+bool app_events_post_from_isr(app_event_type_t type, uint32_t data, BaseType_t *higher_prio_woken);
+bool app_events_wait(app_event_t *event, TickType_t timeout);
+
+#endif // APP_EVENTS_H
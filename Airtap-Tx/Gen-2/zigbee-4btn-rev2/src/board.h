@@ -0,0 +1,43 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "sdkconfig.h"
+
+// Pin assignments of the supported boards, selected in menuconfig under
+// "AirTap Firmware" -> "Board". A pin of -1 means the board lacks that part.
+
+#if CONFIG_AIRTAP_BOARD_GEN4_TOUCH
+
+// Gen-4 panel (see Gen-4/Readme.md): TTP223 touch pads on IO5/6/7 and no
+// MODE pad, so pairing and factory reset use the UP+DOWN chord. The pad to
+// function mapping and the fan drive pin are still to be confirmed on
+// hardware. IO15/18/19/23 drive the louver motor and IO0 the piezo, so the
+// Gen-2 LED and OLED are left out.
+#define BOARD_NAME                  "Gen-4 touch"
+#define BOARD_PIN_BTN_MODE          -1
+#define BOARD_PIN_BTN_UP            5
+#define BOARD_PIN_BTN_DOWN          6
+#define BOARD_PIN_BTN_TOGGLE        7
+#define BOARD_BUTTONS_ACTIVE_LOW    (!CONFIG_AIRTAP_TOUCH_ACTIVE_HIGH)
+#define BOARD_BUTTONS_MAX_HOLD_MS   CONFIG_AIRTAP_TOUCH_MAX_HOLD_MS
+#define BOARD_PIN_FAN_PWM           1
+#define BOARD_PIN_LED               -1
+#define BOARD_HAS_OLED              0
+
+#else
+
+// Gen-2 4-button replacement PCB on a XIAO ESP32C6
+#define BOARD_NAME                  "Gen-2 4-button"
+#define BOARD_PIN_BTN_MODE          18
+#define BOARD_PIN_BTN_UP            17
+#define BOARD_PIN_BTN_DOWN          19
+#define BOARD_PIN_BTN_TOGGLE        20
+#define BOARD_BUTTONS_ACTIVE_LOW    1
+#define BOARD_BUTTONS_MAX_HOLD_MS   0
+#define BOARD_PIN_FAN_PWM           0
+#define BOARD_PIN_LED               15
+#define BOARD_HAS_OLED              1
+
+#endif
+
+#endif // BOARD_H
@@ -0,0 +1,54 @@
+#include "boot_timing.h"
+#include "scheduler.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "BOOT";
+
+typedef struct {
+    const char *phase;
+    int64_t time_us;
+} boot_phase_t;
+
+static boot_phase_t phases[BOOT_TIMING_MAX_PHASES];
+static int num_phases = 0;
+static portMUX_TYPE phases_lock = portMUX_INITIALIZER_UNLOCKED;
+static sched_job_t report_job;
+
+// Record the end of a boot phase. Safe to call from any task.
+void boot_timing_mark(const char *phase) {
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&phases_lock);
+    if (num_phases < BOOT_TIMING_MAX_PHASES) {
+        phases[num_phases].phase = phase;
+        phases[num_phases].time_us = now;
+        num_phases++;
+    }
+    taskEXIT_CRITICAL(&phases_lock);
+}
+
+static void report_job_callback(sched_job_t *job, void *arg) {
+    boot_timing_report();
+}
+
+void boot_timing_schedule_report(void) {
+    scheduler_job_init(&report_job, "boot_report", report_job_callback, NULL);
+    scheduler_start(&report_job, BOOT_TIMING_REPORT_DELAY_MS, 0, 0);
+}
+
+// Times are from esp_timer start, i.e. after the ROM and second-stage bootloader
+void boot_timing_report(void) {
+    taskENTER_CRITICAL(&phases_lock);
+    int count = num_phases;
+    taskEXIT_CRITICAL(&phases_lock);
+
+    int64_t prev = 0;
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "%-12s at %7lld us (+%lld us)", phases[i].phase, phases[i].time_us, phases[i].time_us - prev);
+        prev = phases[i].time_us;
+        if (strcmp(phases[i].phase, "fan") == 0 && phases[i].time_us > BOOT_TIMING_FAN_TARGET_US) {
+            ESP_LOGW(TAG, "Fan driven after %lld us, target is %d us", phases[i].time_us, BOOT_TIMING_FAN_TARGET_US);
+        }
+    }
+}
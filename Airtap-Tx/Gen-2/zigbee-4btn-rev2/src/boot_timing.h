@@ -0,0 +1,21 @@
+#ifndef BOOT_TIMING_H
+#define BOOT_TIMING_H
+
+#include <stdint.h>
+#include "esp_log.h"
+
+// Maximum number of boot phases recorded
+#define BOOT_TIMING_MAX_PHASES 16
+
+// Delay before the breakdown is printed, so phases finished by other tasks are included
+#define BOOT_TIMING_REPORT_DELAY_MS 5000
+
+// Target for the fan to be driven after power-up
+#define BOOT_TIMING_FAN_TARGET_US 100000
+
+// Function prototypes
+void boot_timing_mark(const char *phase);
+void boot_timing_schedule_report(void);
+void boot_timing_report(void);
+
+#endif // BOOT_TIMING_H
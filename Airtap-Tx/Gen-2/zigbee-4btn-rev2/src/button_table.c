@@ -0,0 +1,66 @@
+#include "button_table.h"
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+#endif
+
+#define BTN(b) (1u << (b))
+
+// Every button gesture and what it does. Debounced transitions go through
+// the gesture engine, which matches them against this table.
+const gesture_def_t button_gestures[] = {
+    { .kind = GESTURE_PRESS,        .mask = BTN(BTN_UP),     .action = BUTTON_EVENT_UP_PRESS, .repeat = true },
+    { .kind = GESTURE_DOUBLE_CLICK, .mask = BTN(BTN_UP),     .action = BUTTON_EVENT_SPEED_MAX,
+      .ms = BUTTONS_DOUBLE_CLICK_MS },
+    { .kind = GESTURE_PRESS,        .mask = BTN(BTN_DOWN),   .action = BUTTON_EVENT_DOWN_PRESS, .repeat = true },
+    { .kind = GESTURE_DOUBLE_CLICK, .mask = BTN(BTN_DOWN),   .action = BUTTON_EVENT_SPEED_OFF,
+      .ms = BUTTONS_DOUBLE_CLICK_MS },
+    { .kind = GESTURE_RELEASE,      .mask = BTN(BTN_TOGGLE), .action = BUTTON_EVENT_TOGGLE_PRESS },
+    { .kind = GESTURE_RELEASE,      .mask = BTN(BTN_MODE),   .action = BUTTON_EVENT_MODE_PRESS,
+      .max_ms = BUTTONS_RESET_HOLD_MS },
+    { .kind = GESTURE_HOLD,         .mask = BTN(BTN_MODE),   .action = BUTTON_EVENT_FACTORY_RESET,
+      .ms = BUTTONS_RESET_HOLD_MS },
+#if CONFIG_AIRTAP_BOARD_GEN4_TOUCH
+    // The same through UP+DOWN, as the Gen-4 panel has no MODE pad: pairing
+    // after 3 s, factory reset if still held at 10 s. UP and DOWN presses
+    // wait out the chord window so starting the chord does not step the fan.
+    { .kind = GESTURE_CHORD,        .mask = BTN(BTN_UP) | BTN(BTN_DOWN), .action = BUTTON_EVENT_MODE_PRESS,
+      .ms = BUTTONS_PAIR_CHORD_MS, .max_ms = BUTTONS_CHORD_WINDOW_MS },
+    { .kind = GESTURE_CHORD,        .mask = BTN(BTN_UP) | BTN(BTN_DOWN), .action = BUTTON_EVENT_FACTORY_RESET,
+      .ms = BUTTONS_RESET_HOLD_MS, .max_ms = BUTTONS_CHORD_WINDOW_MS },
+#endif
+    // Panel lock toggle, never hinted at on the display; the only gesture
+    // that gets through while the panel is locked. The window keeps DOWN
+    // from lowering the fan as the chord starts.
+    { .kind = GESTURE_CHORD,        .mask = BTN(BTN_TOGGLE) | BTN(BTN_DOWN), .action = BUTTON_EVENT_PANEL_LOCK,
+      .ms = BUTTONS_LOCK_CHORD_MS, .max_ms = BUTTONS_CHORD_WINDOW_MS },
+};
+const int button_gesture_count = sizeof(button_gestures) / sizeof(button_gestures[0]);
+
+// Hold-to-repeat acceleration for UP/DOWN. With 10 speed steps one step per
+// repeat is enough; a finer speed scale raises steps in the later stages so
+// a full sweep takes about as long.
+const gesture_repeat_stage_t button_repeat_stages[] = {
+    { .from_repeat = 0,  .interval_ms = 300, .steps = 1 },
+    { .from_repeat = 3,  .interval_ms = 200, .steps = 1 },
+    { .from_repeat = 6,  .interval_ms = 120, .steps = 1 },
+};
+const int button_repeat_stage_count = sizeof(button_repeat_stages) / sizeof(button_repeat_stages[0]);
+
+const char *button_name(button_id_t button) {
+    static const char *const names[BTN_COUNT] = { "MODE", "UP", "DOWN", "TOGGLE" };
+    return (button >= 0 && button < BTN_COUNT) ? names[button] : "?";
+}
+
+const char *button_event_name(button_event_t event) {
+    switch (event) {
+        case BUTTON_EVENT_UP_PRESS:         return "UP_PRESS";
+        case BUTTON_EVENT_DOWN_PRESS:       return "DOWN_PRESS";
+        case BUTTON_EVENT_TOGGLE_PRESS:     return "TOGGLE_PRESS";
+        case BUTTON_EVENT_FACTORY_RESET:    return "FACTORY_RESET";
+        case BUTTON_EVENT_MODE_PRESS:       return "MODE_PRESS";
+        case BUTTON_EVENT_SPEED_MAX:        return "SPEED_MAX";
+        case BUTTON_EVENT_SPEED_OFF:        return "SPEED_OFF";
+        case BUTTON_EVENT_PANEL_LOCK:       return "PANEL_LOCK";
+        default:                            return "NONE";
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef BUTTON_TABLE_H
+#define BUTTON_TABLE_H
+
+// The panel's buttons, their events and the gesture table that connects
+// them. Plain C with no ESP-IDF dependencies so tools/button_replay.c runs
+// the same table on the host; it gets the Gen-2 table unless built with
+// -DCONFIG_AIRTAP_BOARD_GEN4_TOUCH=1.
+
+#include <stdint.h>
+#include "gesture.h"
+
+// Sample period while a button's debouncer is integrating
+#define BUTTONS_SAMPLE_MS 2
+
+// Gesture timing
+#define BUTTONS_REPEAT_DELAY_MS     500     // UP/DOWN held this long start repeating
+#define BUTTONS_DOUBLE_CLICK_MS     400     // Max gap between the clicks of a double-click
+#define BUTTONS_RESET_HOLD_MS       10000   // MODE held this long requests a factory reset
+#define BUTTONS_CHORD_WINDOW_MS     100     // Chord buttons must go down this close together
+#define BUTTONS_PAIR_CHORD_MS       3000    // UP+DOWN held this long acts as a MODE press (Gen-4)
+#define BUTTONS_LOCK_CHORD_MS       5000    // TOGGLE+DOWN held this long locks or unlocks the panel
+
+// Button indices, used as gesture mask bits
+typedef enum {
+    BTN_MODE = 0,
+    BTN_UP,
+    BTN_DOWN,
+    BTN_TOGGLE,
+    BTN_COUNT
+} button_id_t;
+
+// Button events
+typedef enum {
+    BUTTON_EVENT_NONE = 0,
+    BUTTON_EVENT_UP_PRESS,
+    BUTTON_EVENT_DOWN_PRESS,
+    BUTTON_EVENT_TOGGLE_PRESS,
+    BUTTON_EVENT_FACTORY_RESET,
+    BUTTON_EVENT_MODE_PRESS,
+    BUTTON_EVENT_SPEED_MAX,
+    BUTTON_EVENT_SPEED_OFF,
+    BUTTON_EVENT_PANEL_LOCK,
+} button_event_t;
+
+extern const gesture_def_t button_gestures[];
+extern const int button_gesture_count;
+extern const gesture_repeat_stage_t button_repeat_stages[];
+extern const int button_repeat_stage_count;
+
+const char *button_name(button_id_t button);
+const char *button_event_name(button_event_t event);
+
+#endif // BUTTON_TABLE_H
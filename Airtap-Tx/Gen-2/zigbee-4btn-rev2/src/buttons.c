@@ -1,80 +1,339 @@
 #include "buttons.h"
+#include <stdio.h>
+#include "app_events.h"
+#include "console.h"
+#include "debounce.h"
+#include "edge_ring.h"
+#include "gesture.h"
+#include "trace.h"
 
 static const char *TAG = "BUTTONS";
 
-// Button scan state
-static uint32_t last_press_time = 0;
-static uint32_t toggle_press_start = 0;
-static bool toggle_pressed = false;
-static bool mode_prev_pressed = false;
+// An edge masks its pin and is queued with its time in the edge ring. The
+// sampler timer drains the ring in arrival order and, every
+// BUTTONS_SAMPLE_MS, feeds each unsettled button's level to its integrating
+// debouncer; once settled the pin is re-armed for the opposite level. Buttons
+// debounce independently and nothing runs between presses. Mechanical
+// buttons and touch pads go through the same path; only the active level,
+// debounce time and stuck-input limit differ per board.
+typedef struct {
+    gpio_num_t pin;                 // -1 = not fitted on this board
+    uint32_t debounce_ms;           // 0 = BUTTONS_DEBOUNCE_MS
+    debounce_t debounce;
+    int64_t edge_us;                // First edge of the current transition
+    bool settling;                  // Sampling in progress, pin masked
+    bool changed;                   // The debounced state changed during this burst
+    bool stuck;                     // Held past BUTTONS_MAX_HOLD_MS, ignored until released
+} button_t;
 
-void buttons_init(void) {
-    // Configure buttons as inputs with pull-up
-    gpio_config_t btn_conf = {
-        .intr_type = GPIO_INTR_DISABLE,
-        .mode = GPIO_MODE_INPUT,
-        .pin_bit_mask = (1ULL << PIN_BTN_MODE) | (1ULL << PIN_BTN_UP) | (1ULL << PIN_BTN_DOWN) | (1ULL << PIN_BTN_TOGGLE),
-        .pull_down_en = 0,
-        .pull_up_en = 1,
+static button_t buttons[] = {
+    [BTN_MODE]   = { .pin = PIN_BTN_MODE },
+    [BTN_UP]     = { .pin = PIN_BTN_UP },
+    [BTN_DOWN]   = { .pin = PIN_BTN_DOWN },
+    [BTN_TOGGLE] = { .pin = PIN_BTN_TOGGLE },
+};
+#define NUM_BUTTONS ((int)(sizeof(buttons) / sizeof(buttons[0])))
+
+// Button state, the gesture engine and both timers are only touched from
+// esp_timer callbacks, which all run in the esp_timer task
+static gesture_engine_t gesture_engine;
+static esp_timer_handle_t gesture_timer;
+static esp_timer_handle_t sample_timer;
+static esp_timer_handle_t stuck_timer;
+
+// Set from the main task; read where gesture events are emitted
+static volatile bool panel_locked = false;
+
+static edge_ring_t edge_ring;
+static QueueHandle_t button_queue = NULL;
+
+// End-to-end counters for the "buttons" console command. Every edge should
+// end up as a debounced change or a rejected glitch, and every queued event
+// should be consumed.
+static struct {
+    uint32_t changes;           // Debounced press/release transitions
+    uint32_t glitches;          // Edges that settled back without a change
+    uint32_t events;            // Gesture events queued for the main loop
+    uint32_t dropped;           // Gesture events lost to a full queue
+    uint32_t consumed;          // Events taken by buttons_get_event()
+    uint32_t stuck;             // Presses dropped for exceeding BUTTONS_MAX_HOLD_MS
+    uint32_t blocked;           // Gesture events refused while the panel is locked
+} stats;
+
+static bool button_fitted(const button_t *button) {
+    return button->pin >= 0;
+}
+
+static bool button_level_pressed(const button_t *button) {
+    return gpio_get_level(button->pin) == BUTTONS_ACTIVE_LEVEL;
+}
+
+// Mask the pin, record the edge and make sure the sampler is running. The
+// edge time is that of the first bounce so reported latency covers the
+// whole settle period. An overflowing ring is counted; the level trigger
+// re-fires once the pin is re-armed, so the transition itself is not lost.
+static void IRAM_ATTR button_isr_handler(void *arg) {
+    TRACE_ISR_ENTER("gpio");
+    int index = (intptr_t)arg;
+    gpio_intr_disable(buttons[index].pin);
+    button_edge_t edge = {
+        .time_us = esp_timer_get_time(),
+        .button = (uint8_t)index,
+        .level = (uint8_t)gpio_get_level(buttons[index].pin),
     };
-    gpio_config(&btn_conf);
-    ESP_LOGI(TAG, "Buttons initialized");
+    edge_ring_push(&edge_ring, &edge);
+    esp_timer_start_once(sample_timer, BUTTONS_SAMPLE_MS * 1000);
+    TRACE_ISR_EXIT("gpio");
+}
+
+// Wait for the opposite level. A level trigger rather than an edge means a
+// change that happened while the pin was masked fires at once, and it is the
+// only trigger that can wake the chip from light sleep.
+static void button_arm(button_t *button) {
+    int wait_for = button->debounce.pressed ? !BUTTONS_ACTIVE_LEVEL : BUTTONS_ACTIVE_LEVEL;
+    gpio_int_type_t level = wait_for ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL;
+    gpio_set_intr_type(button->pin, level);
+#if CONFIG_PM_ENABLE
+    gpio_wakeup_enable(button->pin, level);
+#endif
+    gpio_intr_enable(button->pin);
 }
 
-button_event_t buttons_scan(void) {
-    uint32_t current_time = (uint32_t)(esp_timer_get_time() / 1000);
-    
-    // Debounce time
-    if (current_time - last_press_time < 500) {
-        return BUTTON_EVENT_NONE;
+static void gesture_emit(const gesture_output_t *output, void *arg) {
+    // A locked panel still debounces and tracks gestures so the unlock chord
+    // works, but nothing else leaves this layer. The first event of a press
+    // asks the main loop for feedback; repeats are dropped silently.
+    if (panel_locked && output->action != BUTTON_EVENT_PANEL_LOCK) {
+        stats.blocked++;
+        if (output->repeat == 0) {
+            app_events_post(APP_EVENT_PANEL_BLOCKED, output->action);
+        }
+        return;
     }
-    
-    // UP button
-    if (gpio_get_level(PIN_BTN_UP) == 0) {
-        last_press_time = current_time;
-        return BUTTON_EVENT_UP_PRESS;
+    button_input_t input = {
+        .event = (button_event_t)output->action,
+        .steps = output->steps,
+        .repeat = output->repeat,
+        .time_us = output->time_us,
+    };
+    if (xQueueSend(button_queue, &input, 0) != pdTRUE) {
+        stats.dropped++;
+        ESP_LOGW(TAG, "Button queue full, dropped %lu events", (unsigned long)stats.dropped);
+        return;
     }
-    
-    // DOWN button
-    if (gpio_get_level(PIN_BTN_DOWN) == 0) {
-        last_press_time = current_time;
-        return BUTTON_EVENT_DOWN_PRESS;
+    stats.events++;
+    app_events_post(APP_EVENT_BUTTON, input.event);
+}
+
+// Wake for the engine's next hold, chord or repeat, if any
+static void gesture_reschedule(void) {
+    esp_timer_stop(gesture_timer);
+    int64_t deadline = gesture_next_deadline(&gesture_engine);
+    if (deadline == GESTURE_NO_DEADLINE) {
+        return;
     }
-    
-    // Toggle button with long-press detection for factory reset
-    if (gpio_get_level(PIN_BTN_TOGGLE) == 0) {
-        if (!toggle_pressed) {
-            toggle_pressed = true;
-            toggle_press_start = current_time;
-        } else {
-            // Check for long press (3 seconds)
-            if (current_time - toggle_press_start >= 3000) {
-                toggle_pressed = false;
-                last_press_time = current_time;
-                return BUTTON_EVENT_TOGGLE_LONG_PRESS;
+    int64_t delay_us = deadline - esp_timer_get_time();
+    esp_timer_start_once(gesture_timer, delay_us > 0 ? delay_us : 0);
+}
+
+static void gesture_timer_callback(void *arg) {
+    gesture_tick(&gesture_engine, esp_timer_get_time());
+    gesture_reschedule();
+}
+
+// Wake when the oldest trusted press would exceed BUTTONS_MAX_HOLD_MS
+static void stuck_reschedule(void) {
+    if (BUTTONS_MAX_HOLD_MS == 0) return;
+    esp_timer_stop(stuck_timer);
+    int64_t deadline = INT64_MAX;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        const gesture_button_t *state = &gesture_engine.buttons[i];
+        if (state->pressed && state->press_us < deadline) {
+            deadline = state->press_us;
+        }
+    }
+    if (deadline == INT64_MAX) return;
+    int64_t delay_us = deadline + (int64_t)BUTTONS_MAX_HOLD_MS * 1000 - esp_timer_get_time();
+    esp_timer_start_once(stuck_timer, delay_us > 0 ? delay_us : 0);
+}
+
+// A touch pad reads pressed for as long as something covers it, and one that
+// drifts before the TTP223 recalibrates can read pressed for seconds. Past
+// the limit the press is cancelled, so a release gesture such as TOGGLE does
+// not fire when it finally lets go, and the pad is ignored until it does.
+static void stuck_timer_callback(void *arg) {
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        const gesture_button_t *state = &gesture_engine.buttons[i];
+        if (!state->pressed || now - state->press_us < (int64_t)BUTTONS_MAX_HOLD_MS * 1000) continue;
+        buttons[i].stuck = true;
+        stats.stuck++;
+        gesture_cancel(&gesture_engine, i, now);
+        ESP_LOGW(TAG, "%s held over %d ms, ignoring it until released", button_name(i),
+                 BUTTONS_MAX_HOLD_MS);
+    }
+    gesture_reschedule();
+    stuck_reschedule();
+}
+
+// Sample tick while any debouncer integrates
+static void sample_timer_callback(void *arg) {
+    // Start settling every button with a queued edge, oldest first
+    button_edge_t edge;
+    while (edge_ring_pop(&edge_ring, &edge)) {
+        button_t *button = &buttons[edge.button];
+        if (!button->settling) {
+            button->settling = true;
+            button->changed = false;
+            button->edge_us = edge.time_us;
+        }
+    }
+
+    // Sample; changes from this tick go to the gesture engine in edge order
+    int64_t now = esp_timer_get_time();
+    int order[NUM_BUTTONS];
+    int changed = 0;
+    uint32_t settled = 0;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        button_t *button = &buttons[i];
+        if (!button->settling) continue;
+        if (debounce_sample(&button->debounce, button_level_pressed(button))) {
+            int j = changed++;
+            while (j > 0 && buttons[order[j - 1]].edge_us > button->edge_us) {
+                order[j] = order[j - 1];
+                j--;
             }
+            order[j] = i;
+            button->changed = true;
+            stats.changes++;
         }
-    } else {
-        if (toggle_pressed) {
-            // Short press - toggle fan
-            if (current_time - toggle_press_start < 3000) {
-                toggle_pressed = false;
-                last_press_time = current_time;
-                return BUTTON_EVENT_TOGGLE_PRESS;
+        if (debounce_settled(&button->debounce)) {
+            if (!button->changed) {
+                stats.glitches++;
             }
-            toggle_pressed = false;
-            last_press_time = current_time;
+            button->settling = false;
+            settled |= 1u << i;
         }
     }
-    
-    // MODE button: start pairing on falling edge and keep it active until Zigbee finishes
-    bool mode_pressed = (gpio_get_level(PIN_BTN_MODE) == 0);
-    if (mode_pressed && !mode_prev_pressed) {
-        last_press_time = current_time;
-        mode_prev_pressed = mode_pressed;
-        return BUTTON_EVENT_MODE_PRESS;
+
+    for (int k = 0; k < changed; k++) {
+        button_t *button = &buttons[order[k]];
+        if (button->stuck) {
+            // The engine already let go of this press
+            button->stuck = button->debounce.pressed;
+        } else {
+            // Run anything due first so events stay in time order
+            gesture_tick(&gesture_engine, button->edge_us);
+            gesture_button(&gesture_engine, order[k], button->debounce.pressed, button->edge_us);
+        }
+        // A further change in this burst is timed from here
+        button->edge_us = now;
+    }
+    if (changed) {
+        gesture_reschedule();
+        stuck_reschedule();
+    }
+
+    bool settling = false;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        if (settled & (1u << i)) {
+            button_arm(&buttons[i]);
+        }
+        settling |= buttons[i].settling;
+    }
+    if (settling) {
+        esp_timer_start_once(sample_timer, BUTTONS_SAMPLE_MS * 1000);
+    }
+}
+
+void buttons_init(void) {
+    button_queue = xQueueCreate(BUTTONS_QUEUE_LEN, sizeof(button_input_t));
+    if (button_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create button queue");
+        return;
+    }
+
+    gesture_init(&gesture_engine, button_gestures, button_gesture_count,
+                 button_repeat_stages, button_repeat_stage_count,
+                 BUTTONS_REPEAT_DELAY_MS, gesture_emit, NULL);
+    esp_timer_create_args_t gesture_timer_args = {
+        .callback = gesture_timer_callback,
+        .name = "gesture",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&gesture_timer_args, &gesture_timer));
+    esp_timer_create_args_t sample_timer_args = {
+        .callback = sample_timer_callback,
+        .name = "button_sample",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&sample_timer_args, &sample_timer));
+    esp_timer_create_args_t stuck_timer_args = {
+        .callback = stuck_timer_callback,
+        .name = "button_stuck",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&stuck_timer_args, &stuck_timer));
+    edge_ring_init(&edge_ring);
+
+    uint64_t pin_mask = 0;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        if (button_fitted(&buttons[i])) {
+            pin_mask |= 1ULL << buttons[i].pin;
+        }
+    }
+
+    // Inputs with pull-up, as the OEM firmware also sets the touch outputs;
+    // each pin's trigger level is set by button_arm()
+    gpio_config_t btn_conf = {
+        .intr_type = GPIO_INTR_DISABLE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = pin_mask,
+        .pull_down_en = 0,
+        .pull_up_en = 1,
+    };
+    gpio_config(&btn_conf);
+
+    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        if (!button_fitted(&buttons[i])) continue;
+        ESP_ERROR_CHECK(gpio_isr_handler_add(buttons[i].pin, button_isr_handler, (void *)(intptr_t)i));
+        // A button held through boot is debounced as pressed but never
+        // reaches the gesture engine, so its release matches nothing
+        bool pressed = button_level_pressed(&buttons[i]);
+        uint32_t debounce_ms = buttons[i].debounce_ms ? buttons[i].debounce_ms : BUTTONS_DEBOUNCE_MS;
+        debounce_init(&buttons[i].debounce, debounce_ms, BUTTONS_SAMPLE_MS, pressed);
+        button_arm(&buttons[i]);
     }
-    mode_prev_pressed = mode_pressed;
-    
-    return BUTTON_EVENT_NONE;
+    console_register("buttons", "button edge and event counters", buttons_dump_stats);
+    ESP_LOGI(TAG, "Buttons initialized on %s board (debounce %d ms, %d gestures)", BOARD_NAME,
+             BUTTONS_DEBOUNCE_MS, button_gesture_count);
+}
+
+void buttons_set_locked(bool locked) {
+    panel_locked = locked;
+    ESP_LOGI(TAG, "Panel %s", locked ? "locked" : "unlocked");
+}
+
+bool buttons_get_event(button_input_t *input) {
+    if (button_queue == NULL) return false;
+    if (xQueueReceive(button_queue, input, 0) != pdTRUE) {
+        return false;
+    }
+    stats.consumed++;
+    return true;
+}
+
+// Nothing was lost if every edge became a change or a glitch, the ring never
+// overflowed and every queued event was consumed. Counters are read without
+// a lock, so check them while no button is moving.
+void buttons_dump_stats(void) {
+    uint32_t edges = edge_ring_pushed(&edge_ring);
+    uint32_t overflows = edge_ring_overflows(&edge_ring);
+    uint32_t waiting = button_queue ? (uint32_t)uxQueueMessagesWaiting(button_queue) : 0;
+    printf("edges=%lu overflows=%lu changes=%lu glitches=%lu\n", (unsigned long)edges,
+           (unsigned long)overflows, (unsigned long)stats.changes, (unsigned long)stats.glitches);
+    printf("events=%lu dropped=%lu consumed=%lu waiting=%lu stuck=%lu blocked=%lu\n",
+           (unsigned long)stats.events, (unsigned long)stats.dropped, (unsigned long)stats.consumed,
+           (unsigned long)waiting, (unsigned long)stats.stuck, (unsigned long)stats.blocked);
+    bool lost = overflows != 0 || stats.dropped != 0 || edges != stats.changes + stats.glitches ||
+                stats.events != stats.consumed + waiting;
+    printf("%s\n", lost ? "LOST EVENTS" : "no events lost");
 }
@@ -3,15 +3,32 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "driver/gpio.h"
 #include "esp_timer.h"
 #include "esp_log.h"
+#include "sdkconfig.h"
+#include "board.h"
+#include "button_table.h"
 
-// Pin definitions
-#define PIN_BTN_MODE    18
-#define PIN_BTN_UP      17
-#define PIN_BTN_DOWN    19
-#define PIN_BTN_TOGGLE  20
+// Pin definitions, -1 where the board has no such button
+#define PIN_BTN_MODE    BOARD_PIN_BTN_MODE
+#define PIN_BTN_UP      BOARD_PIN_BTN_UP
+#define PIN_BTN_DOWN    BOARD_PIN_BTN_DOWN
+#define PIN_BTN_TOGGLE  BOARD_PIN_BTN_TOGGLE
+
+// Level of a pressed button: mechanical buttons pull to ground, TTP223 touch
+// outputs drive high by default
+#define BUTTONS_ACTIVE_LEVEL (BOARD_BUTTONS_ACTIVE_LOW ? 0 : 1)
+
+// Presses held longer are taken as a stuck input and dropped; 0 = no limit
+#define BUTTONS_MAX_HOLD_MS BOARD_BUTTONS_MAX_HOLD_MS
+
+// Default time a level must hold before it is trusted; buttons may override it
+#define BUTTONS_DEBOUNCE_MS CONFIG_AIRTAP_BUTTON_DEBOUNCE_MS
+
+// Debounced events waiting for the main loop
+#define BUTTONS_QUEUE_LEN 8
 
 // Button states
 typedef enum {
@@ -19,19 +36,21 @@ typedef enum {
     BUTTON_DOWN = 1
 } button_state_t;
 
-// Button events
-typedef enum {
-    BUTTON_EVENT_NONE = 0,
-    BUTTON_EVENT_UP_PRESS,
-    BUTTON_EVENT_DOWN_PRESS,
-    BUTTON_EVENT_TOGGLE_PRESS,
-    BUTTON_EVENT_TOGGLE_LONG_PRESS,
-    BUTTON_EVENT_MODE_PRESS
-} button_event_t;
+// A queued event with the time of the edge that caused it. Held UP/DOWN
+// buttons repeat their press event with repeat > 0 and may ask for more
+// than one speed step per event as the repeat accelerates.
+typedef struct {
+    button_event_t event;
+    uint8_t steps;
+    uint16_t repeat;
+    int64_t time_us;
+} button_input_t;
 
 // Function prototypes
 void buttons_init(void);
-button_event_t buttons_scan(void);
-void buttons_handle_event(button_event_t event);
+bool buttons_get_event(button_input_t *input);
+void buttons_dump_stats(void);
+void buttons_handle_event(const button_input_t *input);
+void buttons_set_locked(bool locked);
 
 #endif // BUTTONS_H
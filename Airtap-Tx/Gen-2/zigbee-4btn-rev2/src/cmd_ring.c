@@ -0,0 +1,39 @@
+#include "cmd_ring.h"
+
+// head and tail are free-running; their difference is the fill level. The
+// release store of an index publishes the slot it covers, and the acquire
+// load on the other side makes that slot visible before it is touched.
+
+void cmd_ring_init(cmd_ring_t *ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+}
+
+bool cmd_ring_push(cmd_ring_t *ring, command_t cmd) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= CMD_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    ring->slots[head & (CMD_RING_SIZE - 1)] = cmd;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool cmd_ring_pop(cmd_ring_t *ring, command_t *cmd) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *cmd = ring->slots[tail & (CMD_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool cmd_ring_empty(cmd_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) ==
+           atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
@@ -0,0 +1,38 @@
+#ifndef CMD_RING_H
+#define CMD_RING_H
+
+// Lock-free single-producer/single-consumer ring of typed commands. Plain C11
+// with no ESP-IDF dependencies. Exactly one task may push and exactly one
+// task may pop; neither side ever blocks or takes a lock.
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Must be a power of two
+#define CMD_RING_SIZE 16
+
+typedef enum {
+    CMD_NONE = 0,
+    CMD_SET_SPEED,      // value: fan speed
+    CMD_PANEL_LOCK,     // value: 1 lock, 0 unlock
+} command_type_t;
+
+typedef struct {
+    command_type_t type;
+    int32_t value;
+} command_t;
+
+typedef struct {
+    command_t slots[CMD_RING_SIZE];
+    _Atomic uint32_t head;      // Next slot to write, owned by the producer
+    _Atomic uint32_t tail;      // Next slot to read, owned by the consumer
+    _Atomic uint32_t dropped;   // Pushes rejected because the ring was full
+} cmd_ring_t;
+
+void cmd_ring_init(cmd_ring_t *ring);
+bool cmd_ring_push(cmd_ring_t *ring, command_t cmd);
+bool cmd_ring_pop(cmd_ring_t *ring, command_t *cmd);
+bool cmd_ring_empty(cmd_ring_t *ring);
+
+#endif // CMD_RING_H
@@ -0,0 +1,60 @@
+#include "commands.h"
+#include "app_events.h"
+#include "device_state.h"
+
+static const char *TAG = "COMMANDS";
+
+static cmd_ring_t ring;
+// Set by the producer when it has woken the main loop; cleared before each
+// drain so at most one wake-up event is queued however fast commands arrive
+static atomic_bool drain_requested;
+static uint32_t reported_drops = 0;
+
+void commands_init(void) {
+    cmd_ring_init(&ring);
+    atomic_init(&drain_requested, false);
+    ESP_LOGI(TAG, "Command ring initialized (%d slots)", CMD_RING_SIZE);
+}
+
+bool commands_post(command_type_t type, int32_t value) {
+    command_t cmd = { .type = type, .value = value };
+    bool ok = cmd_ring_push(&ring, cmd);
+    if (!atomic_exchange(&drain_requested, true)) {
+        if (!app_events_post(APP_EVENT_COMMAND, 0)) {
+            atomic_store(&drain_requested, false);
+        }
+    }
+    return ok;
+}
+
+// Apply everything queued since the last pass. Speed commands only update a
+// local target, so a burst of level writes ends in a single state change and
+// one PWM update on the following dispatch.
+void commands_drain(void) {
+    atomic_store(&drain_requested, false);
+
+    int target = -1;
+    command_t cmd;
+    while (cmd_ring_pop(&ring, &cmd)) {
+        switch (cmd.type) {
+            case CMD_SET_SPEED:
+                target = cmd.value;
+                break;
+            case CMD_PANEL_LOCK:
+                device_state_set_panel_locked(cmd.value != 0);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (target >= 0) {
+        device_state_set_fan_speed(target);
+    }
+
+    uint32_t dropped = atomic_load_explicit(&ring.dropped, memory_order_relaxed);
+    if (dropped != reported_drops) {
+        ESP_LOGW(TAG, "Command ring full, %lu commands dropped", (unsigned long)(dropped - reported_drops));
+        reported_drops = dropped;
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include "cmd_ring.h"
+#include "esp_log.h"
+
+// Commands from the Zigbee task to the main loop, which is the only context
+// that actuates the fan and the panel lock. commands_post() must only be
+// called from the Zigbee task (the ring has a single producer).
+
+// Function prototypes
+void commands_init(void);
+bool commands_post(command_type_t type, int32_t value);
+void commands_drain(void);
+
+#endif // COMMANDS_H
@@ -0,0 +1,75 @@
+#include "console.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "CONSOLE";
+
+typedef struct {
+    const char *name;
+    const char *help;
+    console_cmd_fn_t fn;
+} console_cmd_t;
+
+static console_cmd_t commands[CONSOLE_MAX_COMMANDS];
+static int num_commands = 0;
+
+static void print_help(void) {
+    printf("Commands:\n");
+    for (int i = 0; i < num_commands; i++) {
+        printf("  %-10s %s\n", commands[i].name, commands[i].help);
+    }
+}
+
+static void run_line(const char *line) {
+    if (line[0] == '\0') return;
+    for (int i = 0; i < num_commands; i++) {
+        if (strcmp(line, commands[i].name) == 0) {
+            commands[i].fn();
+            return;
+        }
+    }
+    if (strcmp(line, "help") != 0) {
+        printf("Unknown command '%s'\n", line);
+    }
+    print_help();
+}
+
+// Blocks on the UART driver, so an idle console costs nothing
+static void console_task(void *arg) {
+    char line[CONSOLE_LINE_MAX];
+    size_t len = 0;
+    while (true) {
+        uint8_t c;
+        if (uart_read_bytes(CONFIG_ESP_CONSOLE_UART_NUM, &c, 1, portMAX_DELAY) != 1) continue;
+        if (c == '\r' || c == '\n') {
+            line[len] = '\0';
+            run_line(line);
+            len = 0;
+        } else if (len < sizeof(line) - 1) {
+            line[len++] = (char)c;
+        }
+    }
+}
+
+void console_init(void) {
+    esp_err_t err = uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, 256, 0, 0, NULL, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install UART driver: %s", esp_err_to_name(err));
+        return;
+    }
+    xTaskCreate(console_task, "console", CONSOLE_TASK_STACK, NULL, 2, NULL);
+    ESP_LOGI(TAG, "Console ready, type 'help'");
+}
+
+// Commands run on the console task and must be safe to call from it
+bool console_register(const char *name, const char *help, console_cmd_fn_t fn) {
+    if (num_commands >= CONSOLE_MAX_COMMANDS) {
+        ESP_LOGE(TAG, "Too many console commands");
+        return false;
+    }
+    commands[num_commands++] = (console_cmd_t){ .name = name, .help = help, .fn = fn };
+    return true;
+}
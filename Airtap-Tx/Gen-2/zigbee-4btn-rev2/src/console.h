@@ -0,0 +1,19 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Line-based commands on the serial console (UART0, 115200 baud).
+// Type a command name and press enter; "help" lists them.
+#define CONSOLE_MAX_COMMANDS    8
+#define CONSOLE_LINE_MAX        32
+#define CONSOLE_TASK_STACK      CONFIG_AIRTAP_CONSOLE_TASK_STACK
+
+typedef void (*console_cmd_fn_t)(void);
+
+// Function prototypes
+void console_init(void);
+bool console_register(const char *name, const char *help, console_cmd_fn_t fn);
+
+#endif // CONSOLE_H
@@ -0,0 +1,252 @@
+#include "crash_log.h"
+#include "console.h"
+#include "scheduler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_core_dump.h"
+#include "esp_memory_utils.h"
+#include "esp_system.h"
+#include "nvs.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "CRASH";
+
+// Summary layout, little-endian. tools/crash_decode.py must match.
+//   header      crash_header_t
+//   backtrace   uint32_t[num_backtrace]
+//   tasks       crash_task_t[num_tasks]
+//   logs        num_logs x { uint8_t len; char text[len]; }
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reset_reason;       // esp_reset_reason_t of the boot that found the dump
+    uint8_t num_backtrace;
+    uint8_t num_tasks;
+    uint8_t num_logs;
+    uint8_t reserved;
+    uint16_t length;            // Whole summary, header included
+    char elf_sha[16];           // Leading hex digits of the crashed app's ELF SHA-256
+    char exc_task[CRASH_TASK_NAME_LEN];
+    uint32_t exc_pc;
+    uint32_t mcause;
+    uint32_t mtval;
+    uint32_t ra;
+    uint32_t sp;
+} crash_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[CRASH_TASK_NAME_LEN];
+    uint16_t stack_free;
+    uint8_t state;              // eTaskState
+    uint8_t priority;
+} crash_task_t;
+
+// Kept in RTC memory, which is not cleared by a panic reset
+typedef struct {
+    uint32_t magic;
+    uint32_t log_head;          // Total lines written; the ring keeps the last CRASH_LOG_LINES
+    char logs[CRASH_LOG_LINES][CRASH_LOG_LINE_LEN];
+    uint8_t num_tasks;
+    crash_task_t tasks[CRASH_MAX_TASKS];
+} crash_rtc_t;
+
+static RTC_NOINIT_ATTR crash_rtc_t rtc;
+static portMUX_TYPE rtc_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t summary[CRASH_SUMMARY_MAX];
+static size_t summary_len = 0;
+static esp_core_dump_summary_t core_summary;    // Large (stack dump), so not on the stack
+static vprintf_like_t prev_vprintf = NULL;
+static sched_job_t snapshot_job;
+
+// Copy every log line into the RTC ring before passing it on
+static int crash_log_vprintf(const char *fmt, va_list args) {
+    char line[CRASH_LOG_LINE_LEN];
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(line, sizeof(line), fmt, copy);
+    va_end(copy);
+    if (len > 0) {
+        size_t n = strnlen(line, sizeof(line) - 1);
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) n--;
+        taskENTER_CRITICAL(&rtc_lock);
+        char *slot = rtc.logs[rtc.log_head++ % CRASH_LOG_LINES];
+        memcpy(slot, line, n);
+        slot[n] = '\0';
+        taskEXIT_CRITICAL(&rtc_lock);
+    }
+    return prev_vprintf(fmt, args);
+}
+
+static void snapshot_tasks(void) {
+    TaskStatus_t status[CRASH_MAX_TASKS];
+    UBaseType_t count = uxTaskGetSystemState(status, CRASH_MAX_TASKS, NULL);
+    crash_task_t tasks[CRASH_MAX_TASKS];
+    for (UBaseType_t i = 0; i < count; i++) {
+        strncpy(tasks[i].name, status[i].pcTaskName, CRASH_TASK_NAME_LEN);
+        tasks[i].stack_free = status[i].usStackHighWaterMark > UINT16_MAX ? UINT16_MAX : status[i].usStackHighWaterMark;
+        tasks[i].state = (uint8_t)status[i].eCurrentState;
+        tasks[i].priority = (uint8_t)status[i].uxCurrentPriority;
+    }
+    taskENTER_CRITICAL(&rtc_lock);
+    memcpy(rtc.tasks, tasks, count * sizeof(crash_task_t));
+    rtc.num_tasks = count;
+    taskEXIT_CRITICAL(&rtc_lock);
+}
+
+static void snapshot_job_callback(sched_job_t *job, void *arg) {
+    snapshot_tasks();
+}
+
+static bool append(const void *data, size_t len) {
+    if (summary_len + len > sizeof(summary)) return false;
+    memcpy(summary + summary_len, data, len);
+    summary_len += len;
+    return true;
+}
+
+// RISC-V has no unwind info at panic time; the core dump keeps a copy of
+// the top of the crashed stack, and words in it that point into code are
+// the likely return addresses
+static uint8_t scan_backtrace(uint32_t *out, const uint8_t *stack, uint32_t size) {
+    uint8_t n = 0;
+    for (uint32_t off = 0; off + 4 <= size && n < CRASH_MAX_BACKTRACE; off += 4) {
+        uint32_t word;
+        memcpy(&word, stack + off, 4);
+        if (esp_ptr_executable((void *)word)) {
+            out[n++] = word;
+        }
+    }
+    return n;
+}
+
+static void build_summary(esp_reset_reason_t reason) {
+    crash_header_t header = {
+        .magic = CRASH_MAGIC,
+        .version = CRASH_VERSION,
+        .reset_reason = (uint8_t)reason,
+    };
+    uint32_t backtrace[CRASH_MAX_BACKTRACE];
+
+    strncpy(header.elf_sha, (const char *)core_summary.app_elf_sha256, sizeof(header.elf_sha));
+    strncpy(header.exc_task, core_summary.exc_task, sizeof(header.exc_task));
+    header.exc_pc = core_summary.exc_pc;
+#if CONFIG_IDF_TARGET_ARCH_RISCV
+    header.mcause = core_summary.ex_info.mcause;
+    header.mtval = core_summary.ex_info.mtval;
+    header.ra = core_summary.ex_info.ra;
+    header.sp = core_summary.ex_info.sp;
+    header.num_backtrace = scan_backtrace(backtrace, core_summary.exc_bt_info.stackdump,
+                                          core_summary.exc_bt_info.dump_size);
+#endif
+
+    bool rtc_valid = rtc.magic == CRASH_MAGIC;
+    header.num_tasks = rtc_valid && rtc.num_tasks <= CRASH_MAX_TASKS ? rtc.num_tasks : 0;
+    uint32_t first_log = 0;
+    if (rtc_valid) {
+        first_log = rtc.log_head > CRASH_LOG_LINES ? rtc.log_head - CRASH_LOG_LINES : 0;
+        header.num_logs = (uint8_t)(rtc.log_head - first_log);
+    }
+
+    summary_len = 0;
+    append(&header, sizeof(header));
+    append(backtrace, header.num_backtrace * sizeof(uint32_t));
+    append(rtc.tasks, header.num_tasks * sizeof(crash_task_t));
+    uint8_t logs_written = 0;
+    for (uint32_t i = first_log; rtc_valid && i < rtc.log_head; i++) {
+        const char *text = rtc.logs[i % CRASH_LOG_LINES];
+        uint8_t len = (uint8_t)strnlen(text, CRASH_LOG_LINE_LEN - 1);
+        if (summary_len + 1 + len > sizeof(summary)) break;
+        append(&len, 1);
+        append(text, len);
+        logs_written++;
+    }
+    ((crash_header_t *)summary)->num_logs = logs_written;
+    ((crash_header_t *)summary)->length = (uint16_t)summary_len;
+}
+
+static void save_summary(void) {
+    nvs_handle_t handle;
+    if (nvs_open(CRASH_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) return;
+    if (summary_len) {
+        nvs_set_blob(handle, CRASH_NVS_KEY_SUMMARY, summary, summary_len);
+    } else {
+        nvs_erase_key(handle, CRASH_NVS_KEY_SUMMARY);
+    }
+    nvs_commit(handle);
+    nvs_close(handle);
+}
+
+static void load_summary(void) {
+    nvs_handle_t handle;
+    summary_len = 0;
+    if (nvs_open(CRASH_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) return;
+    size_t len = sizeof(summary);
+    if (nvs_get_blob(handle, CRASH_NVS_KEY_SUMMARY, summary, &len) == ESP_OK) {
+        summary_len = len;
+    }
+    nvs_close(handle);
+}
+
+static bool is_crash_reset(esp_reset_reason_t reason) {
+    return reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+           reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+}
+
+// Must run after nvs_flash_init() and before anything worth logging, so the
+// previous boot's RTC log ring is read before this boot overwrites it
+void crash_log_init(void) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (is_crash_reset(reason) && esp_core_dump_image_check() == ESP_OK &&
+        esp_core_dump_get_summary(&core_summary) == ESP_OK) {
+        build_summary(reason);
+        save_summary();
+        ESP_LOGW(TAG, "Crash in task %s at 0x%08lx, summary %u bytes", core_summary.exc_task,
+                 (unsigned long)core_summary.exc_pc, (unsigned)summary_len);
+    } else {
+        load_summary();
+    }
+
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = CRASH_MAGIC;
+    prev_vprintf = esp_log_set_vprintf(crash_log_vprintf);
+
+    scheduler_job_init(&snapshot_job, "crash_tasks", snapshot_job_callback, NULL);
+    scheduler_start(&snapshot_job, CRASH_TASK_SNAPSHOT_MS, CRASH_TASK_SNAPSHOT_MS, SCHEDULER_COALESCE_MS);
+    console_register("crash", "print the last crash summary", crash_log_dump);
+    console_register("crashclr", "erase the crash summary and core dump", crash_log_clear);
+}
+
+size_t crash_log_size(void) {
+    return summary_len;
+}
+
+size_t crash_log_read(size_t offset, uint8_t *buf, size_t len) {
+    if (offset >= summary_len) return 0;
+    if (len > summary_len - offset) len = summary_len - offset;
+    memcpy(buf, summary + offset, len);
+    return len;
+}
+
+// One hex line for the decoder, prefixed like the other console dumps
+void crash_log_dump(void) {
+    if (summary_len == 0) {
+        printf("No crash recorded\n");
+        return;
+    }
+    printf("@crash,");
+    for (size_t i = 0; i < summary_len; i++) {
+        printf("%02x", summary[i]);
+    }
+    printf("\n");
+}
+
+void crash_log_clear(void) {
+    summary_len = 0;
+    save_summary();
+    esp_core_dump_image_erase();
+    printf("Crash summary cleared\n");
+}
@@ -0,0 +1,34 @@
+#ifndef CRASH_LOG_H
+#define CRASH_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_log.h"
+
+// Compact crash summary built at boot from the flash core dump, the task
+// list sampled before the crash and the last log lines, all kept in RTC
+// memory across the panic reset. Stored in NVS so it survives power loss.
+// Decode with tools/crash_decode.py.
+
+#define CRASH_MAGIC             0x53435441  // "ATCS"
+#define CRASH_VERSION           1
+#define CRASH_MAX_BACKTRACE     16
+#define CRASH_MAX_TASKS         10
+#define CRASH_TASK_NAME_LEN     16
+#define CRASH_LOG_LINES         8
+#define CRASH_LOG_LINE_LEN      80
+#define CRASH_SUMMARY_MAX       1024
+// Period of the task list snapshot kept for the next crash
+#define CRASH_TASK_SNAPSHOT_MS  10000
+
+#define CRASH_NVS_NAMESPACE     "crash"
+#define CRASH_NVS_KEY_SUMMARY   "summary"
+
+// Function prototypes
+void crash_log_init(void);
+size_t crash_log_size(void);
+size_t crash_log_read(size_t offset, uint8_t *buf, size_t len);
+void crash_log_dump(void);
+void crash_log_clear(void);
+
+#endif // CRASH_LOG_H
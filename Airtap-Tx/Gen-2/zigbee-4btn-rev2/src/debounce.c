@@ -0,0 +1,35 @@
+#include "debounce.h"
+
+void debounce_init(debounce_t *debounce, uint32_t debounce_ms, uint32_t sample_ms, bool pressed) {
+    uint32_t limit = sample_ms ? debounce_ms / sample_ms : 1;
+    if (limit < 1) limit = 1;
+    if (limit > UINT16_MAX) limit = UINT16_MAX;
+    debounce->limit = (uint16_t)limit;
+    debounce->pressed = pressed;
+    debounce->integrator = pressed ? debounce->limit : 0;
+}
+
+// Feed one raw sample. Returns true when the debounced state changed.
+bool debounce_sample(debounce_t *debounce, bool raw_pressed) {
+    if (raw_pressed) {
+        if (debounce->integrator < debounce->limit) debounce->integrator++;
+    } else {
+        if (debounce->integrator > 0) debounce->integrator--;
+    }
+
+    if (!debounce->pressed && debounce->integrator == debounce->limit) {
+        debounce->pressed = true;
+        return true;
+    }
+    if (debounce->pressed && debounce->integrator == 0) {
+        debounce->pressed = false;
+        return true;
+    }
+    return false;
+}
+
+// True once the counter sits on the rail of the debounced state, i.e. no
+// bounce is in progress and sampling can stop
+bool debounce_settled(const debounce_t *debounce) {
+    return debounce->integrator == (debounce->pressed ? debounce->limit : 0);
+}
@@ -0,0 +1,22 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+// Integrating debouncer for one contact. Each raw sample moves a counter one
+// step toward pressed or released; the debounced state only flips when the
+// counter reaches the matching rail. Plain C with no ESP-IDF dependencies so
+// it can be exercised on the host.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint16_t integrator;        // 0 = solidly released, limit = solidly pressed
+    uint16_t limit;             // Consecutive agreeing samples needed to flip
+    bool pressed;               // Debounced state
+} debounce_t;
+
+void debounce_init(debounce_t *debounce, uint32_t debounce_ms, uint32_t sample_ms, bool pressed);
+bool debounce_sample(debounce_t *debounce, bool raw_pressed);
+bool debounce_settled(const debounce_t *debounce);
+
+#endif // DEBOUNCE_H
@@ -0,0 +1,169 @@
+#include "device_state.h"
+#include "app_events.h"
+
+static const char *TAG = "DEVICE_STATE";
+
+typedef struct {
+    uint32_t mask;
+    device_state_cb_t cb;
+    void *arg;
+} subscriber_t;
+
+static device_state_t state = {
+    .temp_centi = 2200,
+};
+static uint32_t pending_changes = 0;
+static portMUX_TYPE state_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static subscriber_t subscribers[DEVICE_STATE_MAX_SUBSCRIBERS];
+static int num_subscribers = 0;
+
+// Record a change; only the first change since the last dispatch wakes the main loop,
+// so a burst of writes is delivered to subscribers as one notification.
+static void mark_changed_locked(uint32_t bits, bool *notify) {
+    *notify = (pending_changes == 0);
+    pending_changes |= bits;
+}
+
+static void notify_main_loop(bool notify) {
+    if (notify) {
+        app_events_post(APP_EVENT_STATE_CHANGED, 0);
+    }
+}
+
+static int clamp_fan_speed(int speed) {
+    if (speed < FAN_SPEED_MIN) return FAN_SPEED_MIN;
+    if (speed > FAN_SPEED_MAX) return FAN_SPEED_MAX;
+    return speed;
+}
+
+void device_state_init(void) {
+    ESP_LOGI(TAG, "Device state initialized");
+}
+
+device_state_t device_state_get(void) {
+    taskENTER_CRITICAL(&state_lock);
+    device_state_t snapshot = state;
+    taskEXIT_CRITICAL(&state_lock);
+    return snapshot;
+}
+
+bool device_state_subscribe(uint32_t mask, device_state_cb_t cb, void *arg) {
+    bool ok = false;
+    taskENTER_CRITICAL(&state_lock);
+    if (num_subscribers < DEVICE_STATE_MAX_SUBSCRIBERS) {
+        subscribers[num_subscribers++] = (subscriber_t){ .mask = mask, .cb = cb, .arg = arg };
+        ok = true;
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    if (!ok) {
+        ESP_LOGE(TAG, "Too many subscribers");
+    }
+    return ok;
+}
+
+void device_state_dispatch(void) {
+    taskENTER_CRITICAL(&state_lock);
+    uint32_t changed = pending_changes;
+    pending_changes = 0;
+    device_state_t snapshot = state;
+    int count = num_subscribers;
+    taskEXIT_CRITICAL(&state_lock);
+
+    if (changed == 0) return;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t relevant = subscribers[i].mask & changed;
+        if (relevant) {
+            subscribers[i].cb(&snapshot, relevant, subscribers[i].arg);
+        }
+    }
+}
+
+void device_state_set_fan_speed(int speed) {
+    bool notify = false;
+    speed = clamp_fan_speed(speed);
+    taskENTER_CRITICAL(&state_lock);
+    if (state.fan_speed != speed) {
+        state.fan_speed = speed;
+        mark_changed_locked(DEVICE_STATE_FAN_SPEED, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+}
+
+// Move by whole presets. A speed between presets, e.g. from a hub slider,
+// first snaps to the neighbouring preset in the direction of travel.
+static int step_fan_speed(int speed, int steps) {
+    int preset = steps > 0 ? speed / FAN_SPEED_STEP : (speed + FAN_SPEED_STEP - 1) / FAN_SPEED_STEP;
+    return clamp_fan_speed((preset + steps) * FAN_SPEED_STEP);
+}
+
+// Read-modify-write under the lock so button steps cannot race a Zigbee write
+int device_state_step_fan_speed(int steps) {
+    bool notify = false;
+    taskENTER_CRITICAL(&state_lock);
+    int speed = step_fan_speed(state.fan_speed, steps);
+    if (state.fan_speed != speed) {
+        state.fan_speed = speed;
+        mark_changed_locked(DEVICE_STATE_FAN_SPEED, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+    return speed;
+}
+
+void device_state_set_pairing(bool active) {
+    bool notify = false;
+    taskENTER_CRITICAL(&state_lock);
+    if (state.pairing_active != active) {
+        state.pairing_active = active;
+        mark_changed_locked(DEVICE_STATE_PAIRING, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+}
+
+void device_state_set_reset_pending(bool pending) {
+    bool notify = false;
+    taskENTER_CRITICAL(&state_lock);
+    if (state.factory_reset_pending != pending) {
+        state.factory_reset_pending = pending;
+        mark_changed_locked(DEVICE_STATE_RESET_PENDING, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+}
+
+void device_state_set_zb_joined(bool joined) {
+    bool notify = false;
+    taskENTER_CRITICAL(&state_lock);
+    if (state.zb_joined != joined) {
+        state.zb_joined = joined;
+        mark_changed_locked(DEVICE_STATE_ZB_JOINED, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+}
+
+void device_state_set_temperature(int16_t temp_centi) {
+    bool notify = false;
+    taskENTER_CRITICAL(&state_lock);
+    if (state.temp_centi != temp_centi) {
+        state.temp_centi = temp_centi;
+        mark_changed_locked(DEVICE_STATE_TEMPERATURE, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+}
+
+void device_state_set_panel_locked(bool locked) {
+    bool notify = false;
+    taskENTER_CRITICAL(&state_lock);
+    if (state.panel_locked != locked) {
+        state.panel_locked = locked;
+        mark_changed_locked(DEVICE_STATE_PANEL_LOCK, &notify);
+    }
+    taskEXIT_CRITICAL(&state_lock);
+    notify_main_loop(notify);
+}
@@ -0,0 +1,55 @@
+#ifndef DEVICE_STATE_H
+#define DEVICE_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_log.h"
+
+// Fan speed range, in per-mille of full PWM duty
+#define FAN_SPEED_MIN 0
+#define FAN_SPEED_MAX 1000
+
+// The buttons move between this many evenly spaced speed presets
+#define FAN_SPEED_PRESETS 10
+#define FAN_SPEED_STEP (FAN_SPEED_MAX / FAN_SPEED_PRESETS)
+
+// Change mask bits, one per field
+#define DEVICE_STATE_FAN_SPEED      (1u << 0)
+#define DEVICE_STATE_PAIRING        (1u << 1)
+#define DEVICE_STATE_RESET_PENDING  (1u << 2)
+#define DEVICE_STATE_ZB_JOINED      (1u << 3)
+#define DEVICE_STATE_TEMPERATURE    (1u << 4)
+#define DEVICE_STATE_PANEL_LOCK     (1u << 5)
+#define DEVICE_STATE_ALL            0x3Fu
+
+// Maximum number of change subscribers
+#define DEVICE_STATE_MAX_SUBSCRIBERS 8
+
+// The single copy of everything the display, PWM and Zigbee agree on
+typedef struct {
+    int fan_speed;              // FAN_SPEED_MIN..FAN_SPEED_MAX
+    bool pairing_active;
+    bool factory_reset_pending;
+    bool zb_joined;
+    int16_t temp_centi;         // Last sampled temperature in 0.01 °C
+    bool panel_locked;          // Buttons ignored except for the unlock chord
+} device_state_t;
+
+// Called from device_state_dispatch() with a snapshot and the subscribed bits that changed
+typedef void (*device_state_cb_t)(const device_state_t *state, uint32_t changed, void *arg);
+
+// Function prototypes
+void device_state_init(void);
+device_state_t device_state_get(void);
+bool device_state_subscribe(uint32_t mask, device_state_cb_t cb, void *arg);
+void device_state_dispatch(void);
+
+void device_state_set_fan_speed(int speed);
+int device_state_step_fan_speed(int steps);
+void device_state_set_pairing(bool active);
+void device_state_set_reset_pending(bool pending);
+void device_state_set_zb_joined(bool joined);
+void device_state_set_temperature(int16_t temp_centi);
+void device_state_set_panel_locked(bool locked);
+
+#endif // DEVICE_STATE_H
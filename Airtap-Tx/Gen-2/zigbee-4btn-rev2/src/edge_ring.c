@@ -0,0 +1,42 @@
+#include "edge_ring.h"
+
+// Same scheme as cmd_ring.c: free-running indices, the release store of an
+// index publishes its slot and the acquire load on the other side sees it.
+
+void edge_ring_init(edge_ring_t *ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overflows, 0);
+}
+
+bool edge_ring_push(edge_ring_t *ring, const button_edge_t *edge) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= EDGE_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+        return false;
+    }
+    ring->slots[head & (EDGE_RING_SIZE - 1)] = *edge;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool edge_ring_pop(edge_ring_t *ring, button_edge_t *edge) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *edge = ring->slots[tail & (EDGE_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Edges accepted since init
+uint32_t edge_ring_pushed(edge_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_relaxed);
+}
+
+uint32_t edge_ring_overflows(edge_ring_t *ring) {
+    return atomic_load_explicit(&ring->overflows, memory_order_relaxed);
+}
@@ -0,0 +1,34 @@
+#ifndef EDGE_RING_H
+#define EDGE_RING_H
+
+// Lock-free single-producer/single-consumer ring of timestamped button edges.
+// The GPIO ISR pushes and the button sampler pops, in arrival order. Plain
+// C11 with no ESP-IDF dependencies.
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Must be a power of two
+#define EDGE_RING_SIZE 32
+
+typedef struct {
+    int64_t time_us;
+    uint8_t button;             // Index into the button table
+    uint8_t level;              // Pin level read in the ISR
+} button_edge_t;
+
+typedef struct {
+    button_edge_t slots[EDGE_RING_SIZE];
+    _Atomic uint32_t head;      // Next slot to write, owned by the producer
+    _Atomic uint32_t tail;      // Next slot to read, owned by the consumer
+    _Atomic uint32_t overflows; // Pushes rejected because the ring was full
+} edge_ring_t;
+
+void edge_ring_init(edge_ring_t *ring);
+bool edge_ring_push(edge_ring_t *ring, const button_edge_t *edge);
+bool edge_ring_pop(edge_ring_t *ring, button_edge_t *edge);
+uint32_t edge_ring_pushed(edge_ring_t *ring);
+uint32_t edge_ring_overflows(edge_ring_t *ring);
+
+#endif // EDGE_RING_H
@@ -1,18 +1,79 @@
 #include "fan_control.h"
+#include "device_state.h"
+#include "scheduler.h"
+#include "rtc_state.h"
+#include "nvs.h"
 
 static const char *TAG = "FAN_CONTROL";
 
-// Global fan speed state
-static int current_fan_speed = 0;
+static nvs_handle_t fan_nvs = 0;
+static int persisted_speed = -1;
+static sched_job_t persist_job;
+static bool restored_from_rtc = false;
+
+// Runs once the speed has been stable for FAN_PERSIST_DELAY_MS. Rapid button
+// presses or hub ramps only restart the delay, so flash sees one write per
+// settled value.
+static void persist_job_callback(sched_job_t *job, void *arg) {
+    int speed = device_state_get().fan_speed;
+    if (fan_nvs == 0 || speed == persisted_speed) return;
+
+    esp_err_t err = nvs_set_u16(fan_nvs, FAN_NVS_KEY_SPEED, (uint16_t)speed);
+    if (err == ESP_OK) {
+        err = nvs_commit(fan_nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist fan speed: %s", esp_err_to_name(err));
+        return;
+    }
+    persisted_speed = speed;
+    ESP_LOGI(TAG, "Persisted fan speed %d", speed);
+}
+
+// The PWM follows the device state; it is only touched when the speed changes
+static void fan_state_changed(const device_state_t *state, uint32_t changed, void *arg) {
+    fan_apply_pwm(state->fan_speed);
+    if (state->fan_speed != persisted_speed) {
+        scheduler_start(&persist_job, FAN_PERSIST_DELAY_MS, 0, SCHEDULER_COALESCE_MS);
+    } else {
+        scheduler_cancel(&persist_job);
+    }
+}
+
+// Read the last persisted speed; requires nvs_flash_init() to have run
+static int fan_load_persisted(void) {
+    esp_err_t err = nvs_open(FAN_NVS_NAMESPACE, NVS_READWRITE, &fan_nvs);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
+        fan_nvs = 0;
+        return 0;
+    }
+    uint16_t stored = 0;
+    if (nvs_get_u16(fan_nvs, FAN_NVS_KEY_SPEED, &stored) == ESP_OK && stored <= FAN_SPEED_MAX) {
+        persisted_speed = stored;
+        return stored;
+    }
+    // Older firmware stored one of the 10 presets; the persist job rewrites
+    // it in the new form once the speed has settled
+    uint8_t preset = 0;
+    if (nvs_get_u8(fan_nvs, FAN_NVS_KEY_SPEED_OLD, &preset) == ESP_OK && preset <= FAN_SPEED_PRESETS) {
+        persisted_speed = -1;
+        return preset * FAN_SPEED_STEP;
+    }
+    persisted_speed = 0;
+    return 0;
+}
 
 void fan_control_init(void) {
-    // Initialize PWM for fan control
+    // Initialize PWM for fan control. RC_FAST is independent of the CPU/APB
+    // frequency and stays powered in light sleep, so a spinning fan no longer
+    // needs a PM lock and the chip can sleep between Zigbee polls.
     ledc_timer_config_t ledc_timer = {
-        .duty_resolution = LEDC_TIMER_13_BIT,
-        .freq_hz = 25000,
+        .duty_resolution = FAN_PWM_RESOLUTION,
+        .freq_hz = FAN_PWM_FREQ_HZ,
         .speed_mode = LEDC_LOW_SPEED_MODE,
         .timer_num = LEDC_TIMER_0,
-        .clk_cfg = LEDC_AUTO_CLK,
+        .clk_cfg = LEDC_USE_RC_FAST_CLK,
     };
     ledc_timer_config(&ledc_timer);
     
@@ -23,29 +84,44 @@ void fan_control_init(void) {
         .speed_mode = LEDC_LOW_SPEED_MODE,
         .hpoint = 0,
         .timer_sel = LEDC_TIMER_0,
+        .sleep_mode = LEDC_SLEEP_MODE_KEEP_ALIVE,
     };
     ledc_channel_config(&ledc_channel);
     
-    ESP_LOGI(TAG, "Fan control initialized");
+    // After a brownout or warm reset the speed is in RTC memory; drive it now
+    // rather than waiting for NVS and the first dispatch
+    snapshot_data_t snapshot;
+    int speed = 0;
+    if (rtc_state_restored(&snapshot) && snapshot.fan_speed >= FAN_SPEED_MIN && snapshot.fan_speed <= FAN_SPEED_MAX) {
+        speed = snapshot.fan_speed;
+        restored_from_rtc = true;
+        device_state_set_fan_speed(speed);
+        fan_apply_pwm(speed);
+    }
+    
+    scheduler_job_init(&persist_job, "fan_persist", persist_job_callback, NULL);
+    device_state_subscribe(DEVICE_STATE_FAN_SPEED, fan_state_changed, NULL);
+    
+    ESP_LOGI(TAG, "Fan control initialized%s, speed %d", restored_from_rtc ? " from RTC" : "", speed);
 }
 
-void fan_set_speed(int speed) {
-    if (speed < 0) speed = 0;
-    if (speed > 10) speed = 10;
-    current_fan_speed = speed;
-    fan_apply_pwm();
+// Second stage once NVS is up: load the persisted speed and, after a cold
+// power-on, drive it
+void fan_control_init_storage(void) {
+    int speed = fan_load_persisted();
+    if (!restored_from_rtc) {
+        device_state_set_fan_speed(speed);
+        fan_apply_pwm(speed);
+        ESP_LOGI(TAG, "Restored speed %d from NVS", speed);
+    }
 }
 
-void fan_apply_pwm(void) {
-    if (current_fan_speed == 0) {
+void fan_apply_pwm(int speed) {
+    if (speed == 0) {
         ledc_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, 0);
     } else {
-        uint32_t duty = (current_fan_speed * 8191) / 10; // 8191 is max duty for 13-bit resolution
+        uint32_t duty = (speed * FAN_PWM_DUTY_MAX + FAN_SPEED_MAX / 2) / FAN_SPEED_MAX;
         ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty);
         ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
     }
 }
-
-int fan_get_speed(void) {
-    return current_fan_speed;
-}
@@ -3,14 +3,28 @@
 
 #include "driver/ledc.h"
 #include "esp_log.h"
+#include "board.h"
 
 // Pin definitions
-#define PIN_PWM_FAN     0
+#define PIN_PWM_FAN     BOARD_PIN_FAN_PWM
+
+// 25 kHz PWM clocked from RC_FAST (about 17.5 MHz), the one LEDC source that
+// keeps running in light sleep. That leaves 9 bits of duty at this frequency,
+// still finer than the 254 Zigbee levels.
+#define FAN_PWM_FREQ_HZ     25000
+#define FAN_PWM_RESOLUTION  LEDC_TIMER_9_BIT
+#define FAN_PWM_DUTY_MAX    ((1u << FAN_PWM_RESOLUTION) - 1)
+
+// Last commanded speed is kept in NVS so the fan resumes after a power loss.
+// It is only written once the speed has been unchanged for FAN_PERSIST_DELAY_MS.
+#define FAN_NVS_NAMESPACE       "fan"
+#define FAN_NVS_KEY_SPEED       "speed_pm"  // U16 per-mille
+#define FAN_NVS_KEY_SPEED_OLD   "speed"     // U8 0-10 from before per-mille speeds
+#define FAN_PERSIST_DELAY_MS    30000
 
 // Function prototypes
 void fan_control_init(void);
-void fan_set_speed(int speed);
-void fan_apply_pwm(void);
-int fan_get_speed(void);
+void fan_control_init_storage(void);
+void fan_apply_pwm(int speed);
 
 #endif // FAN_CONTROL_H
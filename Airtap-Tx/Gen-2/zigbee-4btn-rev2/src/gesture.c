@@ -0,0 +1,284 @@
+#include "gesture.h"
+
+#include <stddef.h>
+
+void gesture_init(gesture_engine_t *engine, const gesture_def_t *defs, int def_count,
+                  const gesture_repeat_stage_t *stages, int stage_count, uint32_t repeat_delay_ms,
+                  gesture_emit_t emit, void *arg) {
+    engine->defs = defs;
+    engine->def_count = def_count < GESTURE_MAX_DEFS ? def_count : GESTURE_MAX_DEFS;
+    engine->stages = stages;
+    engine->stage_count = stage_count;
+    engine->repeat_delay_ms = repeat_delay_ms;
+    engine->emit = emit;
+    engine->arg = arg;
+    engine->fired = 0;
+    for (int i = 0; i < GESTURE_MAX_BUTTONS; i++) {
+        engine->buttons[i] = (gesture_button_t){ 0 };
+    }
+}
+
+static void emit(gesture_engine_t *engine, uint8_t action, int64_t time_us, uint16_t repeat, uint8_t steps) {
+    gesture_output_t output = { .action = action, .steps = steps, .repeat = repeat, .time_us = time_us };
+    engine->emit(&output, engine->arg);
+}
+
+static const gesture_repeat_stage_t *repeat_stage(const gesture_engine_t *engine, uint16_t repeats) {
+    if (engine->stage_count == 0) return NULL;
+    const gesture_repeat_stage_t *stage = &engine->stages[0];
+    for (int i = 1; i < engine->stage_count && repeats >= engine->stages[i].from_repeat; i++) {
+        stage = &engine->stages[i];
+    }
+    return stage;
+}
+
+// The repeating PRESS entry for a button, if any
+static const gesture_def_t *repeat_def(const gesture_engine_t *engine, int button) {
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (def->kind == GESTURE_PRESS && def->repeat && def->mask == (1u << button)) {
+            return def;
+        }
+    }
+    return NULL;
+}
+
+// When every button of a hold or chord is down, the time the last of them
+// went down. A chord takes its buttons over, so their own holds stop applying.
+// A chord with a window only counts when its presses fell inside it.
+static bool hold_start(const gesture_engine_t *engine, const gesture_def_t *def, int64_t *start_us) {
+    int64_t start = INT64_MIN;
+    int64_t first = INT64_MAX;
+    for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+        if (!(def->mask & (1u << b))) continue;
+        const gesture_button_t *state = &engine->buttons[b];
+        if (!state->pressed) return false;
+        if (def->kind == GESTURE_HOLD && state->chorded) return false;
+        if (state->press_us > start) start = state->press_us;
+        if (state->press_us < first) first = state->press_us;
+    }
+    if (def->kind == GESTURE_CHORD && def->max_ms && start - first > (int64_t)def->max_ms * 1000) {
+        return false;
+    }
+    *start_us = start;
+    return true;
+}
+
+// The PRESS and DOUBLE_CLICK entries of a button, run when it goes down or,
+// if a chord window held them back, once the window has passed
+static void press_actions(gesture_engine_t *engine, int button, int64_t now_us) {
+    gesture_button_t *state = &engine->buttons[button];
+    state->press_due_us = GESTURE_NO_DEADLINE;
+
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (def->mask != (1u << button)) continue;
+        if (def->kind == GESTURE_PRESS) {
+            emit(engine, def->action, now_us, 0, 1);
+            if (def->repeat) {
+                state->repeat_due_us = state->press_us + (int64_t)engine->repeat_delay_ms * 1000;
+            }
+        } else if (def->kind == GESTURE_DOUBLE_CLICK && state->click_gap_us >= 0 &&
+                   state->click_gap_us <= (int64_t)def->ms * 1000) {
+            emit(engine, def->action, now_us, 0, 1);
+        }
+    }
+}
+
+// Longest window among the chords this press may still complete, or 0. A
+// press that completes one hands its buttons to the chord: their held-back
+// presses are dropped and their releases match nothing.
+static int64_t chord_window(gesture_engine_t *engine, int button, int64_t now_us, bool *formed) {
+    int64_t window_us = 0;
+    *formed = false;
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (def->kind != GESTURE_CHORD || def->max_ms == 0 || !(def->mask & (1u << button))) continue;
+        int64_t def_window_us = (int64_t)def->max_ms * 1000;
+        bool possible = true;
+        bool complete = true;
+        for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+            if (b == button || !(def->mask & (1u << b))) continue;
+            const gesture_button_t *other = &engine->buttons[b];
+            if (!other->pressed) {
+                complete = false;
+            } else if (other->consumed || now_us - other->press_us > def_window_us) {
+                possible = false;
+            }
+        }
+        if (!possible) continue;
+        if (complete) {
+            *formed = true;
+            for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+                if (def->mask & (1u << b)) {
+                    engine->buttons[b].consumed = true;
+                    engine->buttons[b].chorded = true;
+                    engine->buttons[b].press_due_us = GESTURE_NO_DEADLINE;
+                    engine->buttons[b].repeat_due_us = GESTURE_NO_DEADLINE;
+                }
+            }
+        }
+        if (def_window_us > window_us) window_us = def_window_us;
+    }
+    return window_us;
+}
+
+static void press(gesture_engine_t *engine, int button, int64_t now_us) {
+    gesture_button_t *state = &engine->buttons[button];
+
+    state->pressed = true;
+    state->consumed = false;
+    state->chorded = false;
+    state->click_gap_us = state->click_pending ? now_us - state->release_us : -1;
+    state->click_pending = false;
+    state->repeats = 0;
+    state->press_us = now_us;
+    state->press_due_us = GESTURE_NO_DEADLINE;
+    state->repeat_due_us = GESTURE_NO_DEADLINE;
+
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (def->kind == GESTURE_HOLD && def->mask == (1u << button)) {
+            engine->fired &= ~(1u << i);
+        }
+    }
+
+    bool formed;
+    int64_t window_us = chord_window(engine, button, now_us, &formed);
+    if (formed) return;
+    if (window_us > 0) {
+        state->press_due_us = now_us + window_us;
+    } else {
+        press_actions(engine, button, now_us);
+    }
+
+    // Completing a chord stops its buttons repeating while it is timed
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        int64_t start_us;
+        if (def->kind != GESTURE_CHORD || !(def->mask & (1u << button))) continue;
+        if (!hold_start(engine, def, &start_us)) continue;
+        for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+            if (def->mask & (1u << b)) {
+                engine->buttons[b].repeat_due_us = GESTURE_NO_DEADLINE;
+            }
+        }
+    }
+}
+
+static void release(gesture_engine_t *engine, int button, int64_t now_us) {
+    gesture_button_t *state = &engine->buttons[button];
+    int64_t held_us = now_us - state->press_us;
+
+    // A tap shorter than the chord window still counts as a press
+    if (state->press_due_us != GESTURE_NO_DEADLINE) {
+        press_actions(engine, button, now_us);
+    }
+
+    state->pressed = false;
+    state->release_us = now_us;
+    state->repeat_due_us = GESTURE_NO_DEADLINE;
+    // A press that repeated or fired a hold is not the first half of a double-click
+    state->click_pending = !state->consumed && state->repeats == 0;
+
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (!(def->mask & (1u << button))) continue;
+        if (def->kind == GESTURE_CHORD) {
+            engine->fired &= ~(1u << i);
+        } else if (def->kind == GESTURE_RELEASE && !state->consumed &&
+                   held_us >= (int64_t)def->ms * 1000 &&
+                   (def->max_ms == 0 || held_us < (int64_t)def->max_ms * 1000)) {
+            emit(engine, def->action, now_us, 0, 1);
+        }
+    }
+}
+
+// Feed one debounced transition
+void gesture_button(gesture_engine_t *engine, int button, bool pressed, int64_t now_us) {
+    if (button < 0 || button >= GESTURE_MAX_BUTTONS) return;
+    if (engine->buttons[button].pressed == pressed) return;
+    if (pressed) {
+        press(engine, button, now_us);
+    } else {
+        release(engine, button, now_us);
+    }
+}
+
+// Drop a press without its release matching anything, for an input that is
+// no longer trusted
+void gesture_cancel(gesture_engine_t *engine, int button, int64_t now_us) {
+    if (button < 0 || button >= GESTURE_MAX_BUTTONS) return;
+    if (!engine->buttons[button].pressed) return;
+    engine->buttons[button].consumed = true;
+    engine->buttons[button].press_due_us = GESTURE_NO_DEADLINE;
+    release(engine, button, now_us);
+}
+
+// Fire held-back presses, holds, chords and repeats that are due
+void gesture_tick(gesture_engine_t *engine, int64_t now_us) {
+    for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+        gesture_button_t *state = &engine->buttons[b];
+        if (state->pressed && now_us >= state->press_due_us) {
+            press_actions(engine, b, now_us);
+        }
+    }
+
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (def->kind != GESTURE_HOLD && def->kind != GESTURE_CHORD) continue;
+        if (engine->fired & (1u << i)) continue;
+        int64_t start_us;
+        if (!hold_start(engine, def, &start_us)) continue;
+        if (now_us - start_us < (int64_t)def->ms * 1000) continue;
+
+        engine->fired |= 1u << i;
+        for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+            if (def->mask & (1u << b)) {
+                engine->buttons[b].consumed = true;
+                engine->buttons[b].chorded |= (def->kind == GESTURE_CHORD);
+                engine->buttons[b].repeat_due_us = GESTURE_NO_DEADLINE;
+            }
+        }
+        emit(engine, def->action, now_us, 0, 1);
+    }
+
+    for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+        gesture_button_t *state = &engine->buttons[b];
+        if (!state->pressed || state->consumed || now_us < state->repeat_due_us) continue;
+        const gesture_def_t *def = repeat_def(engine, b);
+        const gesture_repeat_stage_t *stage = repeat_stage(engine, state->repeats);
+        if (def == NULL || stage == NULL) {
+            state->repeat_due_us = GESTURE_NO_DEADLINE;
+            continue;
+        }
+        state->repeats++;
+        emit(engine, def->action, now_us, state->repeats, stage->steps);
+        state->repeat_due_us = now_us + (int64_t)repeat_stage(engine, state->repeats)->interval_ms * 1000;
+    }
+}
+
+// Earliest time gesture_tick() has something to do, or GESTURE_NO_DEADLINE
+int64_t gesture_next_deadline(const gesture_engine_t *engine) {
+    int64_t deadline = GESTURE_NO_DEADLINE;
+    for (int i = 0; i < engine->def_count; i++) {
+        const gesture_def_t *def = &engine->defs[i];
+        if (def->kind != GESTURE_HOLD && def->kind != GESTURE_CHORD) continue;
+        if (engine->fired & (1u << i)) continue;
+        int64_t start_us;
+        if (!hold_start(engine, def, &start_us)) continue;
+        int64_t due_us = start_us + (int64_t)def->ms * 1000;
+        if (due_us < deadline) deadline = due_us;
+    }
+    for (int b = 0; b < GESTURE_MAX_BUTTONS; b++) {
+        const gesture_button_t *state = &engine->buttons[b];
+        if (!state->pressed) continue;
+        if (state->press_due_us < deadline) {
+            deadline = state->press_due_us;
+        }
+        if (!state->consumed && state->repeat_due_us < deadline) {
+            deadline = state->repeat_due_us;
+        }
+    }
+    return deadline;
+}
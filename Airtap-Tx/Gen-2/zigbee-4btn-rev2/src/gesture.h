@@ -0,0 +1,86 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+// Table-driven gesture recognizer over a few debounced buttons. The caller
+// feeds press/release transitions and calls gesture_tick() at
+// gesture_next_deadline(); matching table entries emit their action.
+// Plain C with no ESP-IDF dependencies and no allocation; each call is
+// bounded by the number of buttons and table entries.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GESTURE_MAX_BUTTONS 8
+#define GESTURE_MAX_DEFS    32
+#define GESTURE_NO_DEADLINE INT64_MAX
+
+typedef enum {
+    GESTURE_PRESS,          // On press; repeats while held if the entry sets repeat
+    GESTURE_RELEASE,        // On release after a press lasting [ms, max_ms); max_ms 0 = no limit
+    GESTURE_DOUBLE_CLICK,   // On a press within ms of releasing a plain click
+    GESTURE_HOLD,           // Once, after held for ms; the release then matches nothing
+    GESTURE_CHORD,          // Once, after every button in mask is held for ms; max_ms > 0 is
+                            // the window the presses must fall in, and holds back member
+                            // PRESS and DOUBLE_CLICK entries until the chord is ruled out
+} gesture_kind_t;
+
+// One table entry. mask has one bit per button index, two or more for a chord.
+typedef struct {
+    gesture_kind_t kind;
+    uint8_t mask;
+    uint8_t action;
+    bool repeat;
+    uint32_t ms;
+    uint32_t max_ms;
+} gesture_def_t;
+
+// Hold-to-repeat acceleration; each stage applies from its repeat count on
+typedef struct {
+    uint16_t from_repeat;
+    uint16_t interval_ms;
+    uint8_t steps;
+} gesture_repeat_stage_t;
+
+typedef struct {
+    uint8_t action;
+    uint8_t steps;              // Steps asked for by the repeat stage, 1 otherwise
+    uint16_t repeat;            // 0 for the press itself
+    int64_t time_us;            // Edge that triggered it, or the deadline that expired
+} gesture_output_t;
+
+typedef void (*gesture_emit_t)(const gesture_output_t *output, void *arg);
+
+typedef struct {
+    bool pressed;
+    bool consumed;              // A hold or chord fired; the release matches nothing
+    bool chorded;               // A chord fired; holds of this button no longer apply
+    bool click_pending;         // Last press was a plain click, for double-click
+    uint16_t repeats;
+    int64_t press_us;
+    int64_t release_us;
+    int64_t click_gap_us;       // This press since the previous plain click, or -1
+    int64_t press_due_us;       // Held-back PRESS while a chord may still form
+    int64_t repeat_due_us;
+} gesture_button_t;
+
+typedef struct {
+    const gesture_def_t *defs;
+    int def_count;
+    const gesture_repeat_stage_t *stages;
+    int stage_count;
+    uint32_t repeat_delay_ms;
+    gesture_emit_t emit;
+    void *arg;
+    gesture_button_t buttons[GESTURE_MAX_BUTTONS];
+    uint32_t fired;             // Hold and chord entries already fired, one bit per def
+} gesture_engine_t;
+
+void gesture_init(gesture_engine_t *engine, const gesture_def_t *defs, int def_count,
+                  const gesture_repeat_stage_t *stages, int stage_count, uint32_t repeat_delay_ms,
+                  gesture_emit_t emit, void *arg);
+void gesture_button(gesture_engine_t *engine, int button, bool pressed, int64_t now_us);
+void gesture_cancel(gesture_engine_t *engine, int button, int64_t now_us);
+void gesture_tick(gesture_engine_t *engine, int64_t now_us);
+int64_t gesture_next_deadline(const gesture_engine_t *engine);
+
+#endif // GESTURE_H
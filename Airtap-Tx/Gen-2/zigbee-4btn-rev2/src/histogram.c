@@ -0,0 +1,72 @@
+#include "histogram.h"
+#include <stdio.h>
+#include <string.h>
+
+void histogram_init(histogram_t *hist, const char *name, const uint32_t *bounds, int num_bounds) {
+    if (num_bounds > HISTOGRAM_MAX_BUCKETS) num_bounds = HISTOGRAM_MAX_BUCKETS;
+    hist->name = name;
+    hist->bounds = bounds;
+    hist->num_bounds = num_bounds;
+    histogram_reset(hist);
+}
+
+void histogram_reset(histogram_t *hist) {
+    memset(hist->counts, 0, sizeof(hist->counts));
+    hist->samples = 0;
+    hist->min = UINT32_MAX;
+    hist->max = 0;
+    hist->sum = 0;
+}
+
+void histogram_record(histogram_t *hist, uint32_t value) {
+    // Bucket lists are short, a linear scan beats a binary search here
+    int bucket = 0;
+    while (bucket < hist->num_bounds && value >= hist->bounds[bucket]) {
+        bucket++;
+    }
+    hist->counts[bucket]++;
+    hist->samples++;
+    hist->sum += value;
+    if (value < hist->min) hist->min = value;
+    if (value > hist->max) hist->max = value;
+}
+
+// Upper bound of the bucket holding the given percentile. Samples in the
+// overflow bucket report the observed maximum instead.
+uint32_t histogram_percentile(const histogram_t *hist, uint32_t percent) {
+    if (hist->samples == 0) return 0;
+    if (percent > 100) percent = 100;
+
+    uint64_t target = ((uint64_t)hist->samples * percent + 99) / 100;
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < hist->num_bounds; i++) {
+        seen += hist->counts[i];
+        if (seen >= target) {
+            return hist->bounds[i] < hist->max ? hist->bounds[i] : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+// One-line summary, e.g. "oled_push n=30 avg=812 min=790 max=950 p90<1000 [0 0 28 2|0]"
+int histogram_format(const histogram_t *hist, char *buf, size_t len) {
+    if (hist->samples == 0) {
+        return snprintf(buf, len, "%s n=0", hist->name);
+    }
+
+    int written = snprintf(buf, len, "%s n=%lu avg=%lu min=%lu max=%lu p90<%lu [",
+                           hist->name, (unsigned long)hist->samples,
+                           (unsigned long)(hist->sum / hist->samples),
+                           (unsigned long)hist->min, (unsigned long)hist->max,
+                           (unsigned long)histogram_percentile(hist, 90));
+    for (int i = 0; i <= hist->num_bounds && written >= 0 && (size_t)written < len; i++) {
+        const char *sep = (i == 0) ? "" : (i == hist->num_bounds ? "|" : " ");
+        written += snprintf(buf + written, len - written, "%s%lu", sep, (unsigned long)hist->counts[i]);
+    }
+    if (written >= 0 && (size_t)written < len) {
+        written += snprintf(buf + written, len - written, "]");
+    }
+    return written;
+}
@@ -0,0 +1,31 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// Fixed-bucket latency histogram. Plain C with no ESP-IDF dependencies so it
+// can be compiled and exercised on the host.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HISTOGRAM_MAX_BUCKETS 8
+
+typedef struct {
+    const char *name;
+    const uint32_t *bounds;         // Ascending upper bounds (exclusive) of each bucket
+    int num_bounds;                 // Buckets = num_bounds + 1 (last one catches overflow)
+    uint32_t counts[HISTOGRAM_MAX_BUCKETS + 1];
+    uint32_t samples;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} histogram_t;
+
+// Function prototypes
+void histogram_init(histogram_t *hist, const char *name, const uint32_t *bounds, int num_bounds);
+void histogram_reset(histogram_t *hist);
+void histogram_record(histogram_t *hist, uint32_t value);
+uint32_t histogram_percentile(const histogram_t *hist, uint32_t percent);
+int histogram_format(const histogram_t *hist, char *buf, size_t len);
+
+#endif // HISTOGRAM_H
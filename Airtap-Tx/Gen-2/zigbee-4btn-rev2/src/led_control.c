@@ -3,6 +3,9 @@
 static const char *TAG = "LED_CONTROL";
 
 void led_control_init(void) {
+#if PIN_LED < 0
+    ESP_LOGI(TAG, "No LED on this board");
+#else
     // Initialize GPIO for LED
     gpio_config_t io_conf = {
         .intr_type = GPIO_INTR_DISABLE,
@@ -14,8 +17,11 @@ void led_control_init(void) {
     gpio_config(&io_conf);
     
     ESP_LOGI(TAG, "LED control initialized");
+#endif
 }
 
 void led_set(bool state) {
+#if PIN_LED >= 0
     gpio_set_level(PIN_LED, !state); // Invert the state for correct LED behavior
+#endif
 }
@@ -3,9 +3,10 @@
 
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "board.h"
 
 // Pin definitions
-#define PIN_LED         15  // Built-in LED on XIAO ESP32C6
+#define PIN_LED         BOARD_PIN_LED   // Built-in LED on XIAO ESP32C6, -1 if none
 
 // Function prototypes
 void led_control_init(void);
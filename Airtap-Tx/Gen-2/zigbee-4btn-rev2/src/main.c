@@ -9,61 +9,90 @@
 #include "esp_check.h"
 
 // Include our modular components
+#include "app_events.h"
+#include "boot_timing.h"
+#include "commands.h"
+#include "device_state.h"
 #include "buttons.h"
 #include "led_control.h"
 #include "fan_control.h"
 #include "temperature.h"
 #include "oled_display.h"
+#include "power.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "console.h"
+#include "trace.h"
+#include "soak.h"
+#include "alloc_track.h"
+#include "stack_monitor.h"
+#include "crash_log.h"
+#include "rtc_state.h"
+#include "panel_lock.h"
 #include "zigbee.h"
 
 static const char *TAG = "AIRTapZB";
 
-// Global state
-static int current_fan_speed = 0;
+// Display refresh period (uptime counter)
+#define DISPLAY_UPDATE_MS 1000
+
+// Set when a displayed field changes; the display is redrawn on the next loop pass
+static bool display_dirty = true;
+
+// The display is inverted until this time after a press on a locked panel
+static int64_t lock_flash_until_us = 0;
 
 // Button event handler
-void buttons_handle_event(button_event_t event) {
-    switch (event) {
-        case BUTTON_EVENT_UP_PRESS: // SW4 button
-            if (current_fan_speed < 10) {
-                current_fan_speed++;
-                fan_set_speed(current_fan_speed);
-                ESP_LOGI(TAG, "Fan speed increased to %d", current_fan_speed);
-            }
+void buttons_handle_event(const button_input_t *input) {
+    int speed;
+    switch (input->event) {
+        case BUTTON_EVENT_UP_PRESS: // SW4 button, repeats while held
+            speed = device_state_step_fan_speed(+input->steps);
+            ESP_LOGI(TAG, "Fan speed increased to %d/%d", speed, FAN_SPEED_MAX);
             break;
             
-        case BUTTON_EVENT_DOWN_PRESS: // SW3 button
-            if (current_fan_speed > 0) {
-                current_fan_speed--;
-                fan_set_speed(current_fan_speed);
-                ESP_LOGI(TAG, "Fan speed decreased to %d", current_fan_speed);
-            }
+        case BUTTON_EVENT_DOWN_PRESS: // SW3 button, repeats while held
+            speed = device_state_step_fan_speed(-input->steps);
+            ESP_LOGI(TAG, "Fan speed decreased to %d/%d", speed, FAN_SPEED_MAX);
             break;
             
         case BUTTON_EVENT_TOGGLE_PRESS: // SW2 button
-            if (current_fan_speed == 0) {
+            if (device_state_get().fan_speed == 0) {
                 // Turn fan on to max speed
-                current_fan_speed = 10;
                 // led_set(true);
-                fan_set_speed(current_fan_speed);
-                ESP_LOGI(TAG, "Fan toggled ON to speed %d", current_fan_speed);
+                device_state_set_fan_speed(FAN_SPEED_MAX);
+                ESP_LOGI(TAG, "Fan toggled ON to speed %d", FAN_SPEED_MAX);
             } else {
                 // Turn fan off
-                current_fan_speed = 0;
                 // led_set(false);
-                fan_set_speed(current_fan_speed);
-                ESP_LOGI(TAG, "Fan toggled OFF (speed %d)", current_fan_speed);
+                device_state_set_fan_speed(0);
+                ESP_LOGI(TAG, "Fan toggled OFF (speed 0)");
             }
             break;
             
-        case BUTTON_EVENT_TOGGLE_LONG_PRESS: // SW2 button
+        case BUTTON_EVENT_SPEED_MAX: // Double-click UP
+            device_state_set_fan_speed(FAN_SPEED_MAX);
+            ESP_LOGI(TAG, "Fan set to full speed");
+            break;
+            
+        case BUTTON_EVENT_SPEED_OFF: // Double-click DOWN
+            device_state_set_fan_speed(0);
+            ESP_LOGI(TAG, "Fan turned off");
+            break;
+            
+        case BUTTON_EVENT_FACTORY_RESET: // SW1 button held
             ESP_LOGI(TAG, "Factory reset requested");
             zigbee_factory_reset();
             break;
             
-        case BUTTON_EVENT_MODE_PRESS: // SW1 button
+        case BUTTON_EVENT_PANEL_LOCK: // TOGGLE+DOWN chord, the only event passed while locked
+            ESP_LOGI(TAG, "Panel lock toggled from the buttons");
+            device_state_set_panel_locked(!device_state_get().panel_locked);
+            break;
+            
+        case BUTTON_EVENT_MODE_PRESS: // SW1 button released before the reset hold
             ESP_LOGI(TAG, "Pairing mode requested");
-            if (!pairing_mode_active) {
+            if (!device_state_get().pairing_active) {
                 ESP_LOGI(TAG, "Starting pairing mode");
                 zigbee_start_pairing();
             } else {
@@ -77,48 +106,129 @@ void buttons_handle_event(button_event_t event) {
     }
 }
 
+// Drain debounced button events in the order they happened
+static void handle_button_events(void) {
+    button_input_t input;
+    while (buttons_get_event(&input)) {
+        PROF_END(PROF_BUTTON_LATENCY, input.time_us);
+        buttons_handle_event(&input);
+    }
+}
+
+static sched_job_t display_job;
+
+static void display_job_callback(sched_job_t *job, void *arg) {
+    display_dirty = true;
+}
+
+static void display_state_changed(const device_state_t *state, uint32_t changed, void *arg) {
+    display_dirty = true;
+}
+
+static sched_job_t lock_flash_job;
+
+// Flash the display, then redraw normally once the flash has run out
+static void flash_panel_locked(void) {
+    lock_flash_until_us = esp_timer_get_time() + (int64_t)PANEL_LOCK_FLASH_MS * 1000;
+    scheduler_start(&lock_flash_job, PANEL_LOCK_FLASH_MS, 0, 0);
+    display_dirty = true;
+    ESP_LOGI(TAG, "Button press ignored, panel is locked");
+}
+
+static void refresh_display(void) {
+    device_state_t state = device_state_get();
+    uint32_t uptime_seconds = (uint32_t)(esp_timer_get_time() / 1000000);
+    oled_update_display((float)state.temp_centi / 100.0f, state.fan_speed, state.pairing_active,
+                      state.factory_reset_pending, state.zb_joined, uptime_seconds,
+                      state.panel_locked, esp_timer_get_time() < lock_flash_until_us);
+    display_dirty = false;
+}
+
 void app_main(void) {
+    boot_timing_mark("app_main");
     ESP_LOGI(TAG, "Starting AirTap T-Series with Zigbee");
     
-    // Initialize NVS
-    ESP_ERROR_CHECK(nvs_flash_init());
+    // Core services the rest depends on; these do no I/O
+    app_events_init();
+    scheduler_init();
+    device_state_init();
+    commands_init();
+    
+    // Drive the fan first so it is running as soon as possible after an outage.
+    // After a brownout the speed comes from RTC memory, before the NVS scan.
+    rtc_state_init();
+    fan_control_init();
+    boot_timing_mark("fan");
+    
+    // Initialize NVS; after a cold power-on the fan restores its last speed from it
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+    fan_control_init_storage();
+    panel_lock_init();
+    rtc_state_start();
+    boot_timing_mark("nvs");
+    
+    // Summarize a core dump left by the previous boot, before the log ring is reused
+    crash_log_init();
     
-    // Initialize all components
+    // Local inputs and sensors
     buttons_init();
     led_control_init();
-    fan_control_init();
     temperature_init();
-    oled_init();
+    boot_timing_mark("inputs");
+    
+    // Slow peripherals come up concurrently with the rest of boot
+    oled_init_async();
     zigbee_init();
+    xTaskCreate(zigbee_task, "Zigbee_main", CONFIG_AIRTAP_ZIGBEE_TASK_STACK, NULL, 5, NULL);
+    boot_timing_mark("zigbee_task");
     
-    // Create Zigbee task
-    xTaskCreate(zigbee_task, "Zigbee_main", 4096, NULL, 5, NULL);
+    power_init();
+    profiler_init();
+    console_init();
+    trace_init();
+    soak_init();
+    alloc_track_init();
+    stack_monitor_init();
+    device_state_subscribe(DEVICE_STATE_ALL, display_state_changed, NULL);
+    scheduler_job_init(&display_job, "display", display_job_callback, NULL);
+    scheduler_job_init(&lock_flash_job, "lock_flash", display_job_callback, NULL);
+    scheduler_start(&display_job, DISPLAY_UPDATE_MS, DISPLAY_UPDATE_MS, SCHEDULER_COALESCE_MS);
+    boot_timing_mark("main_loop");
+    boot_timing_schedule_report();
     
-    // Main loop
-    uint32_t last_update = 0;
+    // Main loop: block until a button event, a state change or the next
+    // scheduled job
     while (true) {
-        uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
-        
-        // Update display every second
-        if (now - last_update >= 1000) {
-            last_update = now;
-            
-            // Read temperature
-            float temp_c = temperature_read_celsius();
-            
-            // Update display
-            uint32_t uptime_seconds = (uint32_t)(esp_timer_get_time() / 1000000);
-            oled_update_display(temp_c, current_fan_speed, pairing_mode_active, 
-                              factory_reset_pending, zb_joined, uptime_seconds);
+        TickType_t timeout = scheduler_wait_ticks();
+
+        app_event_t app_event;
+        if (app_events_wait(&app_event, timeout)) {
+            switch (app_event.type) {
+                case APP_EVENT_BUTTON:
+                    handle_button_events();
+                    break;
+                case APP_EVENT_DISPLAY_READY:
+                    display_dirty = true;
+                    break;
+                case APP_EVENT_PANEL_BLOCKED:
+                    flash_panel_locked();
+                    break;
+                default:
+                    break;
+            }
         }
-        
-        // Scan buttons and handle events
-        button_event_t event = buttons_scan();
-        if (event != BUTTON_EVENT_NONE) {
-            buttons_handle_event(event);
+
+        scheduler_run_expired();
+        commands_drain();
+        device_state_dispatch();
+
+        if (display_dirty) {
+            refresh_display();
         }
-        
-        // Small delay
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
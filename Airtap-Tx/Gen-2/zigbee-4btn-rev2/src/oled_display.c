@@ -1,4 +1,12 @@
 #include "oled_display.h"
+#include "profiler.h"
+#include "app_events.h"
+#include "boot_timing.h"
+#include "trace.h"
+#include "freertos/task.h"
+#include "esp_pm.h"
+#include "esp_rom_sys.h"
+#include "board.h"
 #include <stdio.h>
 
 static const char *TAG = "OLED_DISPLAY";
@@ -28,7 +36,24 @@ static const char *TAG = "OLED_DISPLAY";
 
 // Display buffer
 static uint8_t display_buffer[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
-static bool display_initialized = false;
+static volatile bool display_initialized = false;
+
+#if CONFIG_PM_ENABLE
+// Keeps APB at full speed and blocks light sleep for the duration of a transfer
+static esp_pm_lock_handle_t i2c_pm_lock = NULL;
+#endif
+
+static void i2c_pm_acquire(void) {
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(i2c_pm_lock);
+#endif
+}
+
+static void i2c_pm_release(void) {
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(i2c_pm_lock);
+#endif
+}
 
 // Simple 6x8 font (basic ASCII)
 static const uint8_t font_6x8[][6] = {
@@ -144,27 +169,36 @@ static esp_err_t init_i2c(void) {
     return i2c_driver_install(I2C_NUM_0, conf.mode, 0, 0, 0);
 }
 
+// Command links are built in a static buffer instead of the heap. Transfers
+// come from one task at a time (the init task, then the main loop), so a
+// single buffer is enough. Room for three writes between start and stop.
+static uint8_t i2c_link_buf[I2C_LINK_RECOMMENDED_SIZE(3)];
+
 static esp_err_t ssd1306_write_cmd(uint8_t cmd) {
-    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create_static(i2c_link_buf, sizeof(i2c_link_buf));
     i2c_master_start(cmd_handle);
     i2c_master_write_byte(cmd_handle, (SCREEN_ADDRESS << 1) | I2C_MASTER_WRITE, true);
     i2c_master_write_byte(cmd_handle, 0x00, true); // Command mode
     i2c_master_write_byte(cmd_handle, cmd, true);
     i2c_master_stop(cmd_handle);
+    TRACE_BEGIN("i2c");
     esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(100));
-    i2c_cmd_link_delete(cmd_handle);
+    TRACE_END("i2c");
+    i2c_cmd_link_delete_static(cmd_handle);
     return ret;
 }
 
 static esp_err_t ssd1306_write_data(uint8_t *data, size_t len) {
-    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create_static(i2c_link_buf, sizeof(i2c_link_buf));
     i2c_master_start(cmd_handle);
     i2c_master_write_byte(cmd_handle, (SCREEN_ADDRESS << 1) | I2C_MASTER_WRITE, true);
     i2c_master_write_byte(cmd_handle, 0x40, true); // Data mode
     i2c_master_write(cmd_handle, data, len, true);
     i2c_master_stop(cmd_handle);
+    TRACE_BEGIN("i2c");
     esp_err_t ret = i2c_master_cmd_begin(I2C_NUM_0, cmd_handle, pdMS_TO_TICKS(100));
-    i2c_cmd_link_delete(cmd_handle);
+    TRACE_END("i2c");
+    i2c_cmd_link_delete_static(cmd_handle);
     return ret;
 }
 
@@ -201,10 +235,14 @@ void oled_draw_text(int x, int y, const char *text) {
 
 void oled_init(void) {
     ESP_ERROR_CHECK(init_i2c());
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "oled_i2c", &i2c_pm_lock));
+#endif
     
     esp_err_t ret;
     
     // Initialize display
+    i2c_pm_acquire();
     ret = ssd1306_write_cmd(SSD1306_DISPLAYOFF);
     ret |= ssd1306_write_cmd(SSD1306_SETDISPLAYCLOCKDIV);
     ret |= ssd1306_write_cmd(0x80);
@@ -231,6 +269,7 @@ void oled_init(void) {
     ret |= ssd1306_write_cmd(SSD1306_DISPLAYALLON_RESUME);
     ret |= ssd1306_write_cmd(SSD1306_NORMALDISPLAY);
     ret |= ssd1306_write_cmd(SSD1306_DISPLAYON);
+    i2c_pm_release();
     
     if (ret == ESP_OK) {
         display_initialized = true;
@@ -240,18 +279,39 @@ void oled_init(void) {
     }
 }
 
+// The init sequence is ~25 blocking I2C transactions; run it off the main task
+// so the fan and buttons are live while the panel comes up
+static void oled_init_task(void *arg) {
+    oled_init();
+    boot_timing_mark("oled");
+    app_events_post(APP_EVENT_DISPLAY_READY, 0);
+    vTaskDelete(NULL);
+}
+
+void oled_init_async(void) {
+    if (!BOARD_HAS_OLED) {
+        ESP_LOGI(TAG, "No OLED on this board");
+        return;
+    }
+    if (xTaskCreate(oled_init_task, "oled_init", OLED_INIT_TASK_STACK, NULL, 1, NULL) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to start OLED init task, initializing inline");
+        oled_init();
+    }
+}
+
 void oled_clear(void) {
     memset(display_buffer, 0, sizeof(display_buffer));
 }
 
-void oled_update_display(float temp_c, int fan_speed, bool pairing_active, bool factory_reset_pending, bool zb_joined, uint32_t uptime_seconds) {
+void oled_update_display(float temp_c, int fan_speed, bool pairing_active, bool factory_reset_pending, bool zb_joined, uint32_t uptime_seconds,
+                         bool panel_locked, bool lock_flash) {
     if (!display_initialized) return;
     
     // Clear display buffer
     memset(display_buffer, 0, sizeof(display_buffer));
     
-    // Draw title (flipped Y for 180° rotation)
-    oled_draw_text(0, 56, "AirTap T-Series");
+    // Draw title (flipped Y for 180° rotation); a locked panel says so instead
+    oled_draw_text(0, 56, panel_locked ? "** PANEL LOCKED **" : "AirTap T-Series");
     
     // Draw temperature (convert to Fahrenheit)
     float temp_f = temp_c * 9.0f / 5.0f + 32.0f;
@@ -261,7 +321,7 @@ void oled_update_display(float temp_c, int fan_speed, bool pairing_active, bool
     
     // Draw fan speed
     char fan_str[32];
-    snprintf(fan_str, sizeof(fan_str), "Fan: %d/10", fan_speed);
+    snprintf(fan_str, sizeof(fan_str), "Fan: %d.%d%%", fan_speed / 10, fan_speed % 10);
     oled_draw_text(0, 32, fan_str);
     
     // Draw Zigbee status
@@ -282,6 +342,21 @@ void oled_update_display(float temp_c, int fan_speed, bool pairing_active, bool
     snprintf(uptime_str, sizeof(uptime_str), "Uptime: %lu sec", uptime_seconds);
     oled_draw_text(0, 8, uptime_str);
     
+    // Invert the whole frame briefly when a press is refused
+    if (lock_flash) {
+        for (size_t i = 0; i < sizeof(display_buffer); i++) {
+            display_buffer[i] ^= 0xFF;
+        }
+    }
+    
     // Send buffer to display
+    PROF_START(push_start);
+    i2c_pm_acquire();
     ssd1306_write_data(display_buffer, sizeof(display_buffer));
+    i2c_pm_release();
+#if CONFIG_AIRTAP_I2C_STALL_MS
+    // Measurement mode: hold the caller as a bus stuck until its timeout would
+    esp_rom_delay_us(CONFIG_AIRTAP_I2C_STALL_MS * 1000);
+#endif
+    PROF_END(PROF_OLED_PUSH, push_start);
 }
@@ -10,10 +10,15 @@
 #define SCREEN_HEIGHT 64
 #define SCREEN_ADDRESS 0x3C
 
+// Stack for the one-shot init task
+#define OLED_INIT_TASK_STACK 3072
+
 // Function prototypes
 void oled_init(void);
+void oled_init_async(void);
 void oled_clear(void);
 void oled_draw_text(int x, int y, const char *text);
-void oled_update_display(float temp_c, int fan_speed, bool pairing_active, bool factory_reset_pending, bool zb_joined, uint32_t uptime_seconds);
+void oled_update_display(float temp_c, int fan_speed, bool pairing_active, bool factory_reset_pending, bool zb_joined, uint32_t uptime_seconds,
+                         bool panel_locked, bool lock_flash);
 
 #endif // OLED_DISPLAY_H
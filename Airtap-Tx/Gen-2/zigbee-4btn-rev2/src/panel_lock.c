@@ -0,0 +1,46 @@
+#include "panel_lock.h"
+#include "buttons.h"
+#include "device_state.h"
+#include "nvs.h"
+
+static const char *TAG = "PANEL_LOCK";
+
+static nvs_handle_t lock_nvs = 0;
+static int persisted_lock = -1;
+
+// Lock changes are rare, so each one is written straight away
+static void panel_lock_changed(const device_state_t *state, uint32_t changed, void *arg) {
+    buttons_set_locked(state->panel_locked);
+    if (lock_nvs == 0 || state->panel_locked == persisted_lock) return;
+
+    esp_err_t err = nvs_set_u8(lock_nvs, PANEL_LOCK_NVS_KEY, state->panel_locked ? 1 : 0);
+    if (err == ESP_OK) {
+        err = nvs_commit(lock_nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist panel lock: %s", esp_err_to_name(err));
+        return;
+    }
+    persisted_lock = state->panel_locked;
+}
+
+// Requires nvs_flash_init() to have run; applies the stored lock before the
+// buttons can produce an event
+void panel_lock_init(void) {
+    uint8_t stored = 0;
+    esp_err_t err = nvs_open(PANEL_LOCK_NVS_NAMESPACE, NVS_READWRITE, &lock_nvs);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
+        lock_nvs = 0;
+    } else if (nvs_get_u8(lock_nvs, PANEL_LOCK_NVS_KEY, &stored) == ESP_OK) {
+        persisted_lock = stored != 0;
+    } else {
+        stored = 0;
+    }
+
+    bool locked = stored != 0;
+    device_state_set_panel_locked(locked);
+    buttons_set_locked(locked);
+    device_state_subscribe(DEVICE_STATE_PANEL_LOCK, panel_lock_changed, NULL);
+    ESP_LOGI(TAG, "Panel lock initialized (%s)", locked ? "locked" : "unlocked");
+}
@@ -0,0 +1,18 @@
+#ifndef PANEL_LOCK_H
+#define PANEL_LOCK_H
+
+#include "esp_log.h"
+
+// Panel lock persistence, counterpart of the ESPHome "Disable Panel Buttons"
+// switch. The lock lives in device_state; it is set from Zigbee or the
+// TOGGLE+DOWN chord and survives reboots.
+#define PANEL_LOCK_NVS_NAMESPACE    "panel"
+#define PANEL_LOCK_NVS_KEY          "locked"
+
+// How long the display stays inverted after a refused press
+#define PANEL_LOCK_FLASH_MS         1500
+
+// Function prototypes
+void panel_lock_init(void);
+
+#endif // PANEL_LOCK_H
@@ -0,0 +1,87 @@
+#include "power.h"
+#include "esp_timer.h"
+#include "scheduler.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "POWER";
+
+#if CONFIG_PM_ENABLE
+
+// Light sleep accounting, updated from the PM sleep callbacks
+static volatile int64_t total_sleep_us = 0;
+static volatile uint32_t sleep_count = 0;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Values at the previous report, so each log line covers one interval
+static int64_t last_report_time_us = 0;
+static int64_t last_report_sleep_us = 0;
+static uint32_t last_report_sleep_count = 0;
+
+static sched_job_t stats_job;
+
+static esp_err_t IRAM_ATTR light_sleep_exit_cb(int64_t sleep_time_us, void *arg) {
+    total_sleep_us += sleep_time_us;
+    sleep_count++;
+    return ESP_OK;
+}
+
+static void stats_job_callback(sched_job_t *job, void *arg) {
+    power_log_stats();
+}
+
+void power_init(void) {
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+
+    // Button pins are armed as level wakeup sources by buttons.c
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+
+    esp_pm_sleep_cbs_register_config_t cbs_conf = {
+        .exit_cb = light_sleep_exit_cb,
+    };
+    ESP_ERROR_CHECK(esp_pm_light_sleep_register_cbs(&cbs_conf));
+
+    last_report_time_us = esp_timer_get_time();
+
+    scheduler_job_init(&stats_job, "power_stats", stats_job_callback, NULL);
+    scheduler_start(&stats_job, POWER_STATS_INTERVAL_MS, POWER_STATS_INTERVAL_MS, SCHEDULER_COALESCE_MS);
+
+    ESP_LOGI(TAG, "Power management enabled (%d-%d MHz, auto light sleep)", POWER_MIN_FREQ_MHZ, POWER_MAX_FREQ_MHZ);
+}
+
+void power_log_stats(void) {
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&stats_lock);
+    int64_t slept = total_sleep_us;
+    uint32_t count = sleep_count;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    int64_t elapsed = now - last_report_time_us;
+    int64_t slept_delta = slept - last_report_sleep_us;
+    uint32_t count_delta = count - last_report_sleep_count;
+    if (elapsed <= 0) return;
+
+    uint32_t permille = (uint32_t)((slept_delta * 1000) / elapsed);
+    ESP_LOGI(TAG, "Light sleep %lu.%lu%% of last %lld s (%lu sleeps), %lu.%lu%% since boot",
+             permille / 10, permille % 10, elapsed / 1000000, count_delta,
+             (uint32_t)((slept * 1000) / now) / 10, (uint32_t)((slept * 1000) / now) % 10);
+
+    last_report_time_us = now;
+    last_report_sleep_us = slept;
+    last_report_sleep_count = count;
+}
+
+#else
+
+void power_init(void) {
+    ESP_LOGI(TAG, "Power management disabled (CONFIG_PM_ENABLE not set)");
+}
+
+void power_log_stats(void) {
+}
+
+#endif // CONFIG_PM_ENABLE
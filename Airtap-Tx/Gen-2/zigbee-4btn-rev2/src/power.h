@@ -0,0 +1,19 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_log.h"
+
+// DFS range; the CPU drops to XTAL speed when no lock is held
+#define POWER_MAX_FREQ_MHZ      160
+#define POWER_MIN_FREQ_MHZ      40
+
+// How often the light-sleep share is logged
+#define POWER_STATS_INTERVAL_MS 60000
+
+// Function prototypes
+void power_init(void);
+void power_log_stats(void);
+
+#endif // POWER_H
@@ -0,0 +1,126 @@
+#include "profiler.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "PROFILER";
+
+#if CONFIG_AIRTAP_PROFILER
+
+// Bucket bounds in microseconds
+static const uint32_t lateness_bounds[] = { 100, 500, 1000, 5000, 10000, 20000, 50000 };
+static const uint32_t i2c_bounds[] = { 5000, 10000, 20000, 25000, 30000, 50000, 100000 };
+static const uint32_t adc_bounds[] = { 20, 50, 100, 200, 500, 1000 };
+static const uint32_t zb_bounds[] = { 50, 100, 500, 1000, 5000, 10000, 50000 };
+static const uint32_t button_bounds[] = { 5000, 10000, 20000, 30000, 50000, 100000, 200000 };
+
+static histogram_t histograms[PROF_NUM_SECTIONS];
+static portMUX_TYPE hist_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Run-time counters at the previous dump, matched by task handle
+static TaskStatus_t task_status[PROFILER_MAX_TASKS];
+static TaskHandle_t prev_handles[PROFILER_MAX_TASKS];
+static configRUN_TIME_COUNTER_TYPE prev_runtime[PROFILER_MAX_TASKS];
+static int prev_count = 0;
+static configRUN_TIME_COUNTER_TYPE prev_total = 0;
+
+static sched_job_t dump_job;
+
+static void dump_job_callback(sched_job_t *job, void *arg) {
+    profiler_dump();
+}
+
+void profiler_init(void) {
+    histogram_init(&histograms[PROF_MAIN_LOOP_LATENESS], "loop_late", lateness_bounds,
+                   sizeof(lateness_bounds) / sizeof(lateness_bounds[0]));
+    histogram_init(&histograms[PROF_OLED_PUSH], "oled_push", i2c_bounds,
+                   sizeof(i2c_bounds) / sizeof(i2c_bounds[0]));
+    histogram_init(&histograms[PROF_ADC_READ], "adc_read", adc_bounds,
+                   sizeof(adc_bounds) / sizeof(adc_bounds[0]));
+    histogram_init(&histograms[PROF_ZB_ITERATION], "zb_iter", zb_bounds,
+                   sizeof(zb_bounds) / sizeof(zb_bounds[0]));
+    histogram_init(&histograms[PROF_BUTTON_LATENCY], "btn_latency", button_bounds,
+                   sizeof(button_bounds) / sizeof(button_bounds[0]));
+
+    scheduler_job_init(&dump_job, "profiler_dump", dump_job_callback, NULL);
+    scheduler_start(&dump_job, CONFIG_AIRTAP_PROFILER_DUMP_INTERVAL_MS, CONFIG_AIRTAP_PROFILER_DUMP_INTERVAL_MS,
+                    SCHEDULER_COALESCE_MS);
+
+    ESP_LOGI(TAG, "Profiler initialized (dump every %d ms)", CONFIG_AIRTAP_PROFILER_DUMP_INTERVAL_MS);
+}
+
+void profiler_record(prof_section_t section, uint32_t value_us) {
+    if (section >= PROF_NUM_SECTIONS) return;
+    taskENTER_CRITICAL(&hist_lock);
+    histogram_record(&histograms[section], value_us);
+    taskEXIT_CRITICAL(&hist_lock);
+}
+
+static configRUN_TIME_COUNTER_TYPE prev_runtime_for(TaskHandle_t handle) {
+    for (int i = 0; i < prev_count; i++) {
+        if (prev_handles[i] == handle) return prev_runtime[i];
+    }
+    return 0;
+}
+
+// CPU share of each task since the previous dump, in one line
+static void dump_task_usage(void) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(task_status, PROFILER_MAX_TASKS, &total);
+    if (count == 0) {
+        ESP_LOGW(TAG, "cpu: more than %d tasks, skipping", PROFILER_MAX_TASKS);
+        return;
+    }
+
+    configRUN_TIME_COUNTER_TYPE elapsed = total - prev_total;
+    char line[256];
+    int written = snprintf(line, sizeof(line), "cpu:");
+    for (UBaseType_t i = 0; i < count && written < (int)sizeof(line); i++) {
+        configRUN_TIME_COUNTER_TYPE used = task_status[i].ulRunTimeCounter - prev_runtime_for(task_status[i].xHandle);
+        uint32_t permille = elapsed ? (uint32_t)(((uint64_t)used * 1000) / elapsed) : 0;
+        written += snprintf(line + written, sizeof(line) - written, " %s=%lu.%lu%%",
+                            task_status[i].pcTaskName, permille / 10, permille % 10);
+    }
+    ESP_LOGI(TAG, "%s", line);
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        prev_handles[i] = task_status[i].xHandle;
+        prev_runtime[i] = task_status[i].ulRunTimeCounter;
+    }
+    prev_count = count;
+    prev_total = total;
+}
+
+void profiler_dump(void) {
+    dump_task_usage();
+
+    // Copy and reset under the lock so each dump covers one interval
+    static histogram_t snapshot[PROF_NUM_SECTIONS];
+    taskENTER_CRITICAL(&hist_lock);
+    for (int i = 0; i < PROF_NUM_SECTIONS; i++) {
+        snapshot[i] = histograms[i];
+        histogram_reset(&histograms[i]);
+    }
+    taskEXIT_CRITICAL(&hist_lock);
+
+    char line[160];
+    for (int i = 0; i < PROF_NUM_SECTIONS; i++) {
+        histogram_format(&snapshot[i], line, sizeof(line));
+        ESP_LOGI(TAG, "%s", line);
+    }
+}
+
+#else
+
+void profiler_init(void) {
+}
+
+void profiler_record(prof_section_t section, uint32_t value_us) {
+}
+
+void profiler_dump(void) {
+    ESP_LOGI(TAG, "Profiler disabled (CONFIG_AIRTAP_PROFILER not set)");
+}
+
+#endif // CONFIG_AIRTAP_PROFILER
@@ -0,0 +1,35 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Maximum number of tasks tracked in the CPU usage dump
+#define PROFILER_MAX_TASKS 16
+
+// Timed sections, each with its own histogram
+typedef enum {
+    PROF_MAIN_LOOP_LATENESS = 0,    // Scheduler job start vs. its deadline
+    PROF_OLED_PUSH,                 // I2C frame push in oled_update_display
+    PROF_ADC_READ,                  // Temperature ADC read
+    PROF_ZB_ITERATION,              // Zigbee signal and action handler runs
+    PROF_BUTTON_LATENCY,            // Button edge to main-loop handling
+    PROF_NUM_SECTIONS
+} prof_section_t;
+
+// Function prototypes
+void profiler_init(void);
+void profiler_record(prof_section_t section, uint32_t value_us);
+void profiler_dump(void);
+
+#if CONFIG_AIRTAP_PROFILER
+#define PROF_START(var)             int64_t var = esp_timer_get_time()
+#define PROF_END(section, var)      profiler_record((section), (uint32_t)(esp_timer_get_time() - (var)))
+#else
+#define PROF_START(var)
+#define PROF_END(section, var)
+#endif
+
+#endif // PROFILER_H
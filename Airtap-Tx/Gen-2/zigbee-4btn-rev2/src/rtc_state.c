@@ -0,0 +1,82 @@
+#include "rtc_state.h"
+#include "device_state.h"
+#include "scheduler.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+static const char *TAG = "RTC_STATE";
+
+static RTC_NOINIT_ATTR snapshot_store_t store;
+
+static snapshot_data_t current;
+static bool restored = false;
+static int64_t fan_on_since_us = -1;
+static sched_job_t runtime_job;
+
+// Fold the fan-on time since the last call into the counter
+static void account_runtime(int speed) {
+    int64_t now = esp_timer_get_time();
+    if (fan_on_since_us >= 0) {
+        current.fan_runtime_s += (uint32_t)((now - fan_on_since_us) / 1000000);
+        fan_on_since_us += (int64_t)((now - fan_on_since_us) / 1000000) * 1000000;
+    }
+    if (speed > 0 && fan_on_since_us < 0) {
+        fan_on_since_us = now;
+    } else if (speed == 0) {
+        fan_on_since_us = -1;
+    }
+}
+
+// A few dozen bytes of RAM stores; cheap enough to do on every change, so
+// nothing needs to happen inside the brownout interrupt window
+static void rtc_state_changed(const device_state_t *state, uint32_t changed, void *arg) {
+    account_runtime(state->fan_speed);
+    current.fan_speed = state->fan_speed;
+    snapshot_write(&store, &current);
+}
+
+static void runtime_job_callback(sched_job_t *job, void *arg) {
+    account_runtime(device_state_get().fan_speed);
+    snapshot_write(&store, &current);
+}
+
+// Runs before NVS is touched. RTC memory holds garbage after power-on, and
+// the checksum rejects it; the reset reason check makes that explicit.
+void rtc_state_init(void) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason != ESP_RST_POWERON && reason != ESP_RST_UNKNOWN && snapshot_read(&store, &current)) {
+        restored = true;
+        current.resets++;
+        if (reason == ESP_RST_BROWNOUT) {
+            current.brownouts++;
+        }
+        // Left by firmware that counted speed in 10 steps
+        if (!(current.flags & SNAPSHOT_FLAG_SPEED_PERMILLE)) {
+            current.fan_speed *= FAN_SPEED_STEP;
+        }
+        ESP_LOGI(TAG, "Restored after reset %d: speed %ld, fan run time %lu h, %lu brownouts",
+                 reason, (long)current.fan_speed, (unsigned long)(current.fan_runtime_s / 3600),
+                 (unsigned long)current.brownouts);
+    } else {
+        snapshot_clear(&store);
+        current = (snapshot_data_t){0};
+    }
+    current.flags |= SNAPSHOT_FLAG_SPEED_PERMILLE;
+    snapshot_write(&store, &current);
+}
+
+bool rtc_state_restored(snapshot_data_t *data) {
+    if (restored) {
+        *data = current;
+    }
+    return restored;
+}
+
+// Call once the fan speed is settled, so the first snapshot is the real one
+void rtc_state_start(void) {
+    account_runtime(device_state_get().fan_speed);
+    device_state_subscribe(DEVICE_STATE_FAN_SPEED, rtc_state_changed, NULL);
+    scheduler_job_init(&runtime_job, "rtc_runtime", runtime_job_callback, NULL);
+    scheduler_start(&runtime_job, RTC_STATE_RUNTIME_MS, RTC_STATE_RUNTIME_MS, SCHEDULER_COALESCE_MS);
+}
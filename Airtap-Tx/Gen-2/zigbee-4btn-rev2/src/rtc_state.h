@@ -0,0 +1,21 @@
+#ifndef RTC_STATE_H
+#define RTC_STATE_H
+
+#include <stdbool.h>
+#include "snapshot.h"
+#include "esp_log.h"
+
+// Device state mirrored into RTC memory on every change. RTC memory is kept
+// through brownout, watchdog and software resets, so after a brownout the
+// fan comes back from here without waiting for NVS. A full power loss clears
+// it, and the NVS copy written by fan_control is used instead.
+
+// How often the fan run-time counter is folded into the snapshot
+#define RTC_STATE_RUNTIME_MS 60000
+
+// Function prototypes
+void rtc_state_init(void);
+bool rtc_state_restored(snapshot_data_t *data);
+void rtc_state_start(void);
+
+#endif // RTC_STATE_H
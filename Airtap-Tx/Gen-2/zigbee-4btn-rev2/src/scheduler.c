@@ -0,0 +1,112 @@
+#include "scheduler.h"
+#include "app_events.h"
+#include "profiler.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+static const char *TAG = "SCHEDULER";
+
+// All periodic and deferred work runs from the main loop off this wheel, so
+// jobs due close together share a single wakeup.
+static timer_wheel_t wheel;
+static portMUX_TYPE wheel_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t owner_task = NULL;
+
+#define TICK_US (SCHEDULER_TICK_MS * 1000)
+
+static uint32_t now_ticks(void) {
+    return (uint32_t)(esp_timer_get_time() / TICK_US);
+}
+
+static uint32_t ms_to_ticks(uint32_t ms) {
+    return (ms + SCHEDULER_TICK_MS - 1) / SCHEDULER_TICK_MS;
+}
+
+void scheduler_init(void) {
+    timer_wheel_init(&wheel, now_ticks());
+    owner_task = xTaskGetCurrentTaskHandle();
+    ESP_LOGI(TAG, "Scheduler initialized (%d ms tick)", SCHEDULER_TICK_MS);
+}
+
+void scheduler_job_init(sched_job_t *job, const char *name, wheel_timer_cb_t cb, void *arg) {
+    timer_wheel_timer_init(job, name, cb, arg);
+}
+
+// Schedule a job after delay_ms, repeating every period_ms if non-zero. The
+// deadline may be pushed back by up to slack_ms to line up with other jobs.
+void scheduler_start(sched_job_t *job, uint32_t delay_ms, uint32_t period_ms, uint32_t slack_ms) {
+    uint32_t slack = ms_to_ticks(slack_ms);
+
+    taskENTER_CRITICAL(&wheel_lock);
+    job->period = ms_to_ticks(period_ms);
+    job->slack = slack;
+    timer_wheel_add(&wheel, job, timer_wheel_align(now_ticks() + ms_to_ticks(delay_ms), slack));
+    taskEXIT_CRITICAL(&wheel_lock);
+
+    // The main loop may be blocked on an older, later deadline
+    if (xTaskGetCurrentTaskHandle() != owner_task) {
+        app_events_post(APP_EVENT_SCHEDULE_CHANGED, 0);
+    }
+}
+
+void scheduler_cancel(sched_job_t *job) {
+    taskENTER_CRITICAL(&wheel_lock);
+    timer_wheel_cancel(&wheel, job);
+    taskEXIT_CRITICAL(&wheel_lock);
+}
+
+bool scheduler_is_pending(const sched_job_t *job) {
+    return job->pending;
+}
+
+// Jobs currently scheduled; should stay flat once boot has finished
+uint32_t scheduler_pending_count(void) {
+    taskENTER_CRITICAL(&wheel_lock);
+    uint32_t count = wheel.pending;
+    taskEXIT_CRITICAL(&wheel_lock);
+    return count;
+}
+
+// How long the main loop may block before the next job is due
+TickType_t scheduler_wait_ticks(void) {
+    uint32_t expires;
+    taskENTER_CRITICAL(&wheel_lock);
+    bool found = timer_wheel_next_expiry(&wheel, &expires);
+    taskEXIT_CRITICAL(&wheel_lock);
+    if (!found) return portMAX_DELAY;
+
+    // Work in tick deltas so the 32-bit tick counter may wrap
+    int64_t now_us = esp_timer_get_time();
+    int32_t delta = (int32_t)(expires - (uint32_t)(now_us / TICK_US));
+    int64_t wait_us = (int64_t)delta * TICK_US - now_us % TICK_US;
+    if (wait_us <= 0) return 0;
+    return pdMS_TO_TICKS((wait_us + 999) / 1000) + 1;
+}
+
+void scheduler_run_expired(void) {
+    int64_t now_us = esp_timer_get_time();
+    uint32_t now = (uint32_t)(now_us / TICK_US);
+
+    taskENTER_CRITICAL(&wheel_lock);
+    timer_wheel_advance(&wheel, now);
+    taskEXIT_CRITICAL(&wheel_lock);
+
+    while (true) {
+        taskENTER_CRITICAL(&wheel_lock);
+        sched_job_t *job = timer_wheel_pop_expired(&wheel);
+        uint32_t due = job ? job->expires : 0;
+        if (job && job->period) {
+            // Keep the cadence of periodic jobs, skipping runs missed while blocked
+            uint32_t next = job->expires + job->period;
+            while ((int32_t)(next - now) <= 0) {
+                next += job->period;
+            }
+            timer_wheel_add(&wheel, job, timer_wheel_align(next, job->slack));
+        }
+        taskEXIT_CRITICAL(&wheel_lock);
+        if (job == NULL) break;
+
+        profiler_record(PROF_MAIN_LOOP_LATENESS, (uint32_t)((now - due) * TICK_US + now_us % TICK_US));
+        job->cb(job, job->arg);
+    }
+}
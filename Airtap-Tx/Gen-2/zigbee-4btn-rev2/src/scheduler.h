@@ -0,0 +1,28 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "timer_wheel.h"
+
+// Scheduler resolution, matches the FreeRTOS tick
+#define SCHEDULER_TICK_MS 10
+
+// Slack for once-a-second-or-slower housekeeping; aligns those jobs to whole
+// seconds so they fire together with the display refresh
+#define SCHEDULER_COALESCE_MS 1000
+
+// Jobs are timer-wheel nodes owned by the module that schedules them
+typedef wheel_timer_t sched_job_t;
+
+// Function prototypes
+void scheduler_init(void);
+void scheduler_job_init(sched_job_t *job, const char *name, wheel_timer_cb_t cb, void *arg);
+void scheduler_start(sched_job_t *job, uint32_t delay_ms, uint32_t period_ms, uint32_t slack_ms);
+void scheduler_cancel(sched_job_t *job);
+bool scheduler_is_pending(const sched_job_t *job);
+uint32_t scheduler_pending_count(void);
+TickType_t scheduler_wait_ticks(void);
+void scheduler_run_expired(void);
+
+#endif // SCHEDULER_H
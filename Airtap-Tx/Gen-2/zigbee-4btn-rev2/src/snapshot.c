@@ -0,0 +1,59 @@
+#include "snapshot.h"
+#include <stddef.h>
+#include <string.h>
+
+// Bitwise CRC-32 (reflected, poly 0xEDB88320); the record is a few dozen bytes
+static uint32_t crc32(const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t slot_crc(const snapshot_slot_t *slot) {
+    return crc32(slot, offsetof(snapshot_slot_t, crc));
+}
+
+static bool slot_valid(const snapshot_slot_t *slot) {
+    return slot->magic == SNAPSHOT_MAGIC && slot->crc == slot_crc(slot);
+}
+
+// Index of the newest valid slot, or -1. seq is compared by difference so
+// it may wrap.
+static int newest_slot(const snapshot_store_t *store) {
+    bool v0 = slot_valid(&store->slots[0]);
+    bool v1 = slot_valid(&store->slots[1]);
+    if (v0 && v1) {
+        return (int32_t)(store->slots[1].seq - store->slots[0].seq) > 0 ? 1 : 0;
+    }
+    return v0 ? 0 : (v1 ? 1 : -1);
+}
+
+void snapshot_write(snapshot_store_t *store, const snapshot_data_t *data) {
+    int newest = newest_slot(store);
+    uint32_t seq = newest >= 0 ? store->slots[newest].seq + 1 : 1;
+    snapshot_slot_t *slot = &store->slots[newest == 0 ? 1 : 0];
+
+    // Invalidate first, so a cut during the copy cannot pair old crc and new data
+    slot->crc = ~slot->crc;
+    slot->magic = SNAPSHOT_MAGIC;
+    slot->seq = seq;
+    slot->data = *data;
+    slot->crc = slot_crc(slot);
+}
+
+bool snapshot_read(const snapshot_store_t *store, snapshot_data_t *data) {
+    int newest = newest_slot(store);
+    if (newest < 0) return false;
+    *data = store->slots[newest].data;
+    return true;
+}
+
+void snapshot_clear(snapshot_store_t *store) {
+    memset(store, 0, sizeof(*store));
+}
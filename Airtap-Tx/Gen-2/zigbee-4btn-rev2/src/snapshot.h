@@ -0,0 +1,40 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// Double-buffered, checksummed state record for memory that survives a
+// reset but may be cut off mid-write. Plain C with no ESP-IDF dependencies.
+// Each write goes to the older slot and its checksum is stored last, so a
+// torn write leaves the previous record intact.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SNAPSHOT_MAGIC 0x41545353  // "ATSS"
+
+// flags bits
+#define SNAPSHOT_FLAG_SPEED_PERMILLE (1u << 0)  // fan_speed is per-mille, not one of 10 steps
+
+typedef struct {
+    int32_t fan_speed;
+    uint32_t flags;             // SNAPSHOT_FLAG_*
+    uint32_t fan_runtime_s;     // Accumulated fan-on time
+    uint32_t brownouts;         // Brownout resets seen
+    uint32_t resets;            // Warm resets of any kind
+} snapshot_data_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    snapshot_data_t data;
+    uint32_t crc;               // Over magic, seq and data; written last
+} snapshot_slot_t;
+
+typedef struct {
+    snapshot_slot_t slots[2];
+} snapshot_store_t;
+
+void snapshot_write(snapshot_store_t *store, const snapshot_data_t *data);
+bool snapshot_read(const snapshot_store_t *store, snapshot_data_t *data);
+void snapshot_clear(snapshot_store_t *store);
+
+#endif // SNAPSHOT_H
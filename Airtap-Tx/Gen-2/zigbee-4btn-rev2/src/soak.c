@@ -0,0 +1,178 @@
+#include "soak.h"
+#include "buttons.h"
+#include "commands.h"
+#include "device_state.h"
+#include "scheduler.h"
+#include "zigbee.h"
+#include "zb_level.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include <stdio.h>
+
+#if CONFIG_AIRTAP_SOAK
+
+static const char *TAG = "SOAK";
+
+#define SOAK_MAX_TASKS 16
+
+// Tracks one metric that must not keep moving in one direction
+typedef struct {
+    const char *name;
+    bool leak_falls;            // A leak shows as a falling value (free space)
+    uint32_t last;
+    uint32_t run;               // Consecutive samples moving the leaking way
+    bool failed;
+} soak_metric_t;
+
+typedef enum {
+    METRIC_HEAP_USED = 0,
+    METRIC_JOBS,
+    METRIC_TASKS,
+    METRIC_STACK_FREE,
+    METRIC_COUNT
+} soak_metric_id_t;
+
+static soak_metric_t metrics[METRIC_COUNT] = {
+    [METRIC_HEAP_USED]  = { .name = "heap_used" },
+    [METRIC_JOBS]       = { .name = "sched_jobs" },
+    [METRIC_TASKS]      = { .name = "tasks" },
+    [METRIC_STACK_FREE] = { .name = "stack_free", .leak_falls = true },
+};
+
+static sched_job_t sample_job;
+static sched_job_t stimulus_job;
+static uint32_t sample_count = 0;
+static uint32_t stimulus_count = 0;
+static uint32_t zb_fault_count = 0;
+
+// Flat or noisy values reset the run; only a steady trend fails
+static void metric_update(soak_metric_t *m, uint32_t value) {
+    if (sample_count > 0) {
+        bool leaking = m->leak_falls ? value < m->last : value > m->last;
+        bool recovering = m->leak_falls ? value > m->last : value < m->last;
+        if (leaking) {
+            m->run++;
+        } else if (recovering) {
+            m->run = 0;
+        }
+    }
+    m->last = value;
+    if (!m->failed && m->run >= CONFIG_AIRTAP_SOAK_WINDOW) {
+        m->failed = true;
+        ESP_LOGE(TAG, "SOAK FAIL: %s moved the same way for %lu consecutive samples (now %lu)",
+                 m->name, (unsigned long)m->run, (unsigned long)value);
+    }
+}
+
+// Sum of the stack high-water marks (bytes never used), plus the tightest task
+static uint32_t stack_free(const char **tightest, uint32_t *tightest_free) {
+    TaskStatus_t tasks[SOAK_MAX_TASKS];
+    UBaseType_t count = uxTaskGetSystemState(tasks, SOAK_MAX_TASKS, NULL);
+    uint32_t total = 0;
+    *tightest = "-";
+    *tightest_free = UINT32_MAX;
+    for (UBaseType_t i = 0; i < count; i++) {
+        total += tasks[i].usStackHighWaterMark;
+        if (tasks[i].usStackHighWaterMark < *tightest_free) {
+            *tightest_free = tasks[i].usStackHighWaterMark;
+            *tightest = tasks[i].pcTaskName;
+        }
+    }
+    return total;
+}
+
+static void sample_job_callback(sched_job_t *job, void *arg) {
+    uint32_t heap_total = heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+    uint32_t heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    uint32_t heap_min = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    uint32_t heap_block = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    uint32_t jobs = scheduler_pending_count();
+    uint32_t tasks = uxTaskGetNumberOfTasks();
+    const char *tightest;
+    uint32_t tightest_free;
+    uint32_t stack = stack_free(&tightest, &tightest_free);
+
+    if (sample_count == 0) {
+        printf("@soak,uptime_s,heap_free,heap_min_free,heap_largest_block,sched_jobs,tasks,"
+               "min_stack_free,min_stack_task,stimuli,zb_faults,failures\n");
+    }
+
+    metric_update(&metrics[METRIC_HEAP_USED], heap_total - heap_free);
+    metric_update(&metrics[METRIC_JOBS], jobs);
+    metric_update(&metrics[METRIC_TASKS], tasks);
+    metric_update(&metrics[METRIC_STACK_FREE], stack);
+    sample_count++;
+
+    int failures = 0;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        failures += metrics[i].failed;
+    }
+    printf("@soak,%lld,%lu,%lu,%lu,%lu,%lu,%lu,%s,%lu,%lu,%d\n",
+           esp_timer_get_time() / 1000000, (unsigned long)heap_free, (unsigned long)heap_min,
+           (unsigned long)heap_block, (unsigned long)jobs, (unsigned long)tasks,
+           (unsigned long)tightest_free, tightest, (unsigned long)stimulus_count,
+           (unsigned long)zb_fault_count, failures);
+}
+
+// A hub level write as zb_attribute_handler() applies it: posted from the
+// Zigbee task into the command ring and actuated by the main loop
+static void hub_level_alarm(uint8_t level) {
+    commands_post(CMD_SET_SPEED, zb_level_to_speed(level));
+}
+
+// One random action per run: button presses, hub level writes and pairing
+// start/cancel. Factory reset is left out as it would end the run.
+static void stimulus_job_callback(sched_job_t *job, void *arg) {
+    static const button_event_t presses[] = {
+        BUTTON_EVENT_UP_PRESS, BUTTON_EVENT_DOWN_PRESS, BUTTON_EVENT_TOGGLE_PRESS,
+    };
+    uint32_t r = esp_random();
+    switch (r % 4) {
+        case 0:
+        case 1: {
+            button_input_t input = { .event = presses[(r >> 8) % 3], .steps = 1 };
+            buttons_handle_event(&input);
+            break;
+        }
+        case 2:
+            esp_zb_lock_acquire(portMAX_DELAY);
+            esp_zb_scheduler_alarm(hub_level_alarm, (r >> 8) % (ZB_LEVEL_MAX + 1), 0);
+            esp_zb_lock_release();
+            break;
+        case 3:
+            if (device_state_get().pairing_active) {
+                zigbee_cancel_pairing();
+            } else {
+                zigbee_start_pairing();
+            }
+            break;
+    }
+    stimulus_count++;
+    scheduler_start(&stimulus_job, 100 + (esp_random() % CONFIG_AIRTAP_SOAK_STIMULUS_MAX_MS), 0, 0);
+}
+
+bool soak_zb_fault(void) {
+    if (esp_random() % 100 >= CONFIG_AIRTAP_SOAK_ZB_FAULT_PCT) {
+        return false;
+    }
+    zb_fault_count++;
+    ESP_LOGI(TAG, "Injecting a Zigbee failure");
+    return true;
+}
+
+void soak_init(void) {
+    scheduler_job_init(&sample_job, "soak_sample", sample_job_callback, NULL);
+    scheduler_job_init(&stimulus_job, "soak_stimulus", stimulus_job_callback, NULL);
+    scheduler_start(&sample_job, CONFIG_AIRTAP_SOAK_SAMPLE_MS, CONFIG_AIRTAP_SOAK_SAMPLE_MS, 0);
+    scheduler_start(&stimulus_job, CONFIG_AIRTAP_SOAK_STIMULUS_MAX_MS, 0, 0);
+    ESP_LOGW(TAG, "Soak-test mode active, the device will act on its own");
+}
+
+#else
+
+void soak_init(void) {}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Soak-test mode (CONFIG_AIRTAP_SOAK). CSV rows are printed with a "@soak,"
+// prefix so they can be grepped out of a long monitor capture.
+// soak_zb_fault() tells the Zigbee task to treat a good result as failed,
+// at random; it only exists in soak builds.
+
+// Function prototypes
+void soak_init(void);
+#if CONFIG_AIRTAP_SOAK
+bool soak_zb_fault(void);
+#endif
+
+#endif // SOAK_H
@@ -0,0 +1,138 @@
+#include "stack_monitor.h"
+#include "console.h"
+#include "scheduler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "STACKS";
+
+#if CONFIG_AIRTAP_STACK_MONITOR
+
+// Stack sizes we know, and the option that sets each one. FreeRTOS does not
+// report the size, only the high-water mark (bytes never touched).
+typedef struct {
+    const char *name;           // Task name, matched as a prefix (IDLE may carry a core suffix)
+    uint32_t size;
+    const char *option;
+} known_task_t;
+
+static const known_task_t known_tasks[] = {
+    { "main",        CONFIG_ESP_MAIN_TASK_STACK_SIZE,         "CONFIG_ESP_MAIN_TASK_STACK_SIZE" },
+    { "Zigbee_main", CONFIG_AIRTAP_ZIGBEE_TASK_STACK,         "CONFIG_AIRTAP_ZIGBEE_TASK_STACK" },
+    { "esp_timer",   CONFIG_ESP_TIMER_TASK_STACK_SIZE,        "CONFIG_ESP_TIMER_TASK_STACK_SIZE" },
+    { "IDLE",        CONFIG_FREERTOS_IDLE_TASK_STACKSIZE,     "CONFIG_FREERTOS_IDLE_TASK_STACKSIZE" },
+    { "Tmr Svc",     CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH,  "CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH" },
+    { "console",     CONFIG_AIRTAP_CONSOLE_TASK_STACK,        "CONFIG_AIRTAP_CONSOLE_TASK_STACK" },
+};
+#define NUM_KNOWN_TASKS (sizeof(known_tasks) / sizeof(known_tasks[0]))
+
+static TaskStatus_t tasks[STACK_MONITOR_MAX_TASKS];
+static TaskHandle_t warned[STACK_MONITOR_MAX_TASKS];
+static int num_warned = 0;
+static uint32_t min_free = UINT32_MAX;
+static uint8_t low_count = 0;
+static sched_job_t sample_job;
+
+static const known_task_t *find_known(const char *name) {
+    for (size_t i = 0; i < NUM_KNOWN_TASKS; i++) {
+        if (strncmp(name, known_tasks[i].name, strlen(known_tasks[i].name)) == 0) {
+            return &known_tasks[i];
+        }
+    }
+    return NULL;
+}
+
+// Warn once per task; the high-water mark only ever falls
+static void warn_once(const TaskStatus_t *task) {
+    for (int i = 0; i < num_warned; i++) {
+        if (warned[i] == task->xHandle) return;
+    }
+    if (num_warned < STACK_MONITOR_MAX_TASKS) {
+        warned[num_warned++] = task->xHandle;
+    }
+    ESP_LOGW(TAG, "Task %s has only %lu bytes of stack left", task->pcTaskName,
+             (unsigned long)task->usStackHighWaterMark);
+}
+
+static uint32_t suggested_size(uint32_t size, uint32_t free) {
+    uint32_t want = size - free + CONFIG_AIRTAP_STACK_MARGIN;
+    return (want + STACK_MONITOR_ROUND - 1) / STACK_MONITOR_ROUND * STACK_MONITOR_ROUND;
+}
+
+void stack_monitor_sample(void) {
+    UBaseType_t count = uxTaskGetSystemState(tasks, STACK_MONITOR_MAX_TASKS, NULL);
+    uint32_t lowest = UINT32_MAX;
+    uint8_t low = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint32_t free = tasks[i].usStackHighWaterMark;
+        if (free < lowest) lowest = free;
+        if (free < CONFIG_AIRTAP_STACK_WARN_BYTES) {
+            low++;
+            warn_once(&tasks[i]);
+        }
+    }
+    min_free = lowest;
+    low_count = low;
+}
+
+static void sample_job_callback(sched_job_t *job, void *arg) {
+    stack_monitor_sample();
+}
+
+// Table for the console, then one "@stack,option,size,used,suggested" line
+// per known task. tools/stack_sizes.py folds captures of these into an
+// sdkconfig.stacks fragment that the build applies on top of the defaults.
+void stack_monitor_dump(void) {
+    UBaseType_t count = uxTaskGetSystemState(tasks, STACK_MONITOR_MAX_TASKS, NULL);
+    printf("%-16s %6s %6s %6s\n", "task", "size", "used", "free");
+    for (UBaseType_t i = 0; i < count; i++) {
+        const known_task_t *known = find_known(tasks[i].pcTaskName);
+        uint32_t free = tasks[i].usStackHighWaterMark;
+        if (known) {
+            printf("%-16s %6lu %6lu %6lu%s\n", tasks[i].pcTaskName, (unsigned long)known->size,
+                   (unsigned long)(known->size - free), (unsigned long)free,
+                   free < CONFIG_AIRTAP_STACK_WARN_BYTES ? "  LOW" : "");
+        } else {
+            printf("%-16s %6s %6s %6lu%s\n", tasks[i].pcTaskName, "?", "?", (unsigned long)free,
+                   free < CONFIG_AIRTAP_STACK_WARN_BYTES ? "  LOW" : "");
+        }
+    }
+    printf("Suggested sizes (used + %d margin):\n", CONFIG_AIRTAP_STACK_MARGIN);
+    for (UBaseType_t i = 0; i < count; i++) {
+        const known_task_t *known = find_known(tasks[i].pcTaskName);
+        if (known) {
+            uint32_t free = tasks[i].usStackHighWaterMark;
+            printf("@stack,%s,%lu,%lu,%lu\n", known->option, (unsigned long)known->size,
+                   (unsigned long)(known->size - free), (unsigned long)suggested_size(known->size, free));
+        }
+    }
+}
+
+uint32_t stack_monitor_min_free(void) {
+    return min_free;
+}
+
+uint8_t stack_monitor_low_count(void) {
+    return low_count;
+}
+
+void stack_monitor_init(void) {
+    scheduler_job_init(&sample_job, "stack_sample", sample_job_callback, NULL);
+    scheduler_start(&sample_job, CONFIG_AIRTAP_STACK_SAMPLE_MS, CONFIG_AIRTAP_STACK_SAMPLE_MS, SCHEDULER_COALESCE_MS);
+    console_register("stacks", "task stack usage and suggested sizes", stack_monitor_dump);
+    ESP_LOGI(TAG, "Stack monitor on (warn below %d bytes)", CONFIG_AIRTAP_STACK_WARN_BYTES);
+}
+
+#else
+
+void stack_monitor_init(void) {}
+void stack_monitor_sample(void) {}
+void stack_monitor_dump(void) {
+    ESP_LOGW(TAG, "Stack monitor disabled (CONFIG_AIRTAP_STACK_MONITOR)");
+}
+uint32_t stack_monitor_min_free(void) { return UINT32_MAX; }
+uint8_t stack_monitor_low_count(void) { return 0; }
+
+#endif
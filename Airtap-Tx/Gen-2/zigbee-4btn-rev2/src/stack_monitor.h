@@ -0,0 +1,20 @@
+#ifndef STACK_MONITOR_H
+#define STACK_MONITOR_H
+
+#include <stdint.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Periodic stack high-water sampling for every task
+#define STACK_MONITOR_MAX_TASKS 16
+// Suggested sizes are rounded up to this
+#define STACK_MONITOR_ROUND     256
+
+// Function prototypes
+void stack_monitor_init(void);
+void stack_monitor_sample(void);
+void stack_monitor_dump(void);
+uint32_t stack_monitor_min_free(void);
+uint8_t stack_monitor_low_count(void);
+
+#endif // STACK_MONITOR_H
@@ -0,0 +1,38 @@
+#include "temp_filter.h"
+
+void temp_filter_init(temp_filter_t *filter, uint8_t shift, int16_t threshold) {
+    filter->acc = 0;
+    filter->shift = shift;
+    filter->primed = false;
+    filter->reported = 0;
+    filter->threshold = threshold;
+}
+
+int16_t temp_filter_value(const temp_filter_t *filter) {
+    // Round to nearest; a plain shift would bias negative values downward
+    int32_t half = filter->shift ? (1 << (filter->shift - 1)) : 0;
+    return (int16_t)((filter->acc + half) >> filter->shift);
+}
+
+// Feed one sample. Returns true when the filtered value has moved at least
+// threshold away from the last reported value (and on the first sample).
+bool temp_filter_update(temp_filter_t *filter, int16_t sample) {
+    if (!filter->primed) {
+        // Multiply rather than shift: shifting a negative value left is undefined
+        filter->acc = (int32_t)sample * (1 << filter->shift);
+        filter->primed = true;
+        filter->reported = sample;
+        return true;
+    }
+
+    filter->acc += sample - temp_filter_value(filter);
+
+    int16_t value = temp_filter_value(filter);
+    int32_t delta = value - filter->reported;
+    if (delta < 0) delta = -delta;
+    if (delta < filter->threshold) {
+        return false;
+    }
+    filter->reported = value;
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef TEMP_FILTER_H
+#define TEMP_FILTER_H
+
+// Fixed-point exponential filter with a report threshold for the NTC reading.
+// Plain C with no ESP-IDF dependencies and no floating point, so it can be
+// exercised on the host or run on a core without an FPU.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    int32_t acc;                // Filtered value scaled by 2^shift
+    uint8_t shift;              // Smoothing; each sample moves the output by 1/2^shift
+    bool primed;                // The first sample seeds the filter directly
+    int16_t reported;           // Last value handed out by temp_filter_update()
+    int16_t threshold;          // Change needed before a new value is reported
+} temp_filter_t;
+
+void temp_filter_init(temp_filter_t *filter, uint8_t shift, int16_t threshold);
+bool temp_filter_update(temp_filter_t *filter, int16_t sample);
+int16_t temp_filter_value(const temp_filter_t *filter);
+
+#endif // TEMP_FILTER_H
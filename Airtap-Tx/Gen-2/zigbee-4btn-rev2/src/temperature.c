@@ -1,4 +1,10 @@
 #include "temperature.h"
+#include "profiler.h"
+#include "trace.h"
+#include "device_state.h"
+#include "scheduler.h"
+#include "temp_filter.h"
+#include "esp_pm.h"
 #include <math.h>
 
 static const char *TAG = "TEMPERATURE";
@@ -8,6 +14,21 @@ static adc_oneshot_unit_handle_t adc1_handle;
 static adc_cali_handle_t adc1_cali_handle = NULL;
 static bool adc_calibration_init_done = false;
 
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t adc_pm_lock = NULL;
+#endif
+
+static sched_job_t sample_job;
+static temp_filter_t filter;
+
+// Samples are smoothed here; subscribers (display, Zigbee report) only hear
+// about the temperature when it has actually moved
+static void sample_job_callback(sched_job_t *job, void *arg) {
+    if (temp_filter_update(&filter, temperature_read_centi())) {
+        device_state_set_temperature(temp_filter_value(&filter));
+    }
+}
+
 void temperature_init(void) {
     // Initialize ADC for temperature
     adc_oneshot_unit_init_cfg_t init_config1 = {
@@ -19,7 +40,15 @@ void temperature_init(void) {
         .bitwidth = ADC_BITWIDTH_DEFAULT,
         .atten = ADC_ATTEN_DB_12,
     };
-    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, ADC_CHANNEL_0, &config));
+    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, TEMPERATURE_ADC_CHANNEL, &config));
+    
+#if CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "adc_temp", &adc_pm_lock));
+#endif
+    
+    temp_filter_init(&filter, TEMPERATURE_FILTER_SHIFT, TEMPERATURE_REPORT_DELTA_CENTI);
+    scheduler_job_init(&sample_job, "temp_sample", sample_job_callback, NULL);
+    scheduler_start(&sample_job, 0, TEMPERATURE_SAMPLE_MS, SCHEDULER_COALESCE_MS);
     
     ESP_LOGI(TAG, "Temperature sensor initialized");
 }
@@ -27,7 +56,17 @@ void temperature_init(void) {
 int16_t temperature_read_centi(void) {
     int adc_raw;
     int voltage;
-    esp_err_t ret = adc_oneshot_read(adc1_handle, ADC_CHANNEL_0, &adc_raw);
+    PROF_START(read_start);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(adc_pm_lock);
+#endif
+    TRACE_BEGIN("adc");
+    esp_err_t ret = adc_oneshot_read(adc1_handle, TEMPERATURE_ADC_CHANNEL, &adc_raw);
+    TRACE_END("adc");
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(adc_pm_lock);
+#endif
+    PROF_END(PROF_ADC_READ, read_start);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Error reading ADC");
         return 2200; // Return 22.0°C as default
@@ -7,6 +7,14 @@
 
 // Pin definitions
 #define PIN_ADC_TEMP    2
+#define TEMPERATURE_ADC_CHANNEL ADC_CHANNEL_2   // ADC1 channel of GPIO2
+
+// Sampling period of the NTC
+#define TEMPERATURE_SAMPLE_MS 1000
+// Filter smoothing (time constant ~2^shift samples) and the change in
+// centidegrees needed before the device state is updated
+#define TEMPERATURE_FILTER_SHIFT        3
+#define TEMPERATURE_REPORT_DELTA_CENTI  10
 
 // Function prototypes
 void temperature_init(void);
@@ -0,0 +1,220 @@
+#include "timer_wheel.h"
+#include <stddef.h>
+
+static void slot_init(wheel_slot_t *slot) {
+    slot->head.next = &slot->head;
+    slot->head.prev = &slot->head;
+}
+
+static bool slot_empty(const wheel_slot_t *slot) {
+    return slot->head.next == &slot->head;
+}
+
+static void slot_append(wheel_slot_t *slot, wheel_timer_t *timer) {
+    timer->prev = slot->head.prev;
+    timer->next = &slot->head;
+    slot->head.prev->next = timer;
+    slot->head.prev = timer;
+}
+
+static void unlink_timer(wheel_timer_t *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+// Place a timer by its distance from the current tick. Anything already due
+// lands in the current level-0 slot and fires on the next advance.
+static void place_timer(timer_wheel_t *wheel, wheel_timer_t *timer) {
+    uint32_t expires = timer->expires;
+    uint32_t delta = expires - wheel->now;
+
+    if ((int32_t)delta < 0) {
+        expires = wheel->now;
+        delta = 0;
+    } else if (delta >= TIMER_WHEEL_RANGE) {
+        // Kept out of the slots, whose index would wrap onto an earlier
+        // deadline; moved in by migrate_overflow() once within range
+        slot_append(&wheel->overflow, timer);
+        return;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    uint32_t index = (expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    slot_append(&wheel->slots[level][index], timer);
+}
+
+// Move every timer of one higher-level slot down to the level it now belongs to
+static void cascade(timer_wheel_t *wheel, int level) {
+    uint32_t index = (wheel->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    wheel_slot_t *slot = &wheel->slots[level][index];
+    while (!slot_empty(slot)) {
+        wheel_timer_t *timer = slot->head.next;
+        unlink_timer(timer);
+        place_timer(wheel, timer);
+    }
+}
+
+// Runs on every top-level slot boundary. A timer still in the overflow list
+// is at least TIMER_WHEEL_RANGE minus one top-level slot away, so it always
+// lands in a top-level slot other than the one just cascaded.
+static void migrate_overflow(timer_wheel_t *wheel) {
+    wheel_timer_t *timer = wheel->overflow.head.next;
+    while (timer != &wheel->overflow.head) {
+        wheel_timer_t *next = timer->next;
+        if (timer->expires - wheel->now < TIMER_WHEEL_RANGE) {
+            unlink_timer(timer);
+            place_timer(wheel, timer);
+        }
+        timer = next;
+    }
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t now) {
+    wheel->now = now;
+    wheel->pending = 0;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+            slot_init(&wheel->slots[level][i]);
+        }
+    }
+    slot_init(&wheel->overflow);
+    slot_init(&wheel->expired);
+}
+
+void timer_wheel_timer_init(wheel_timer_t *timer, const char *name, wheel_timer_cb_t cb, void *arg) {
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->expires = 0;
+    timer->period = 0;
+    timer->slack = 0;
+    timer->cb = cb;
+    timer->arg = arg;
+    timer->name = name;
+    timer->pending = false;
+}
+
+// Earliest multiple of the slack at or after expires (round up). Timers with
+// compatible slack then share a deadline, and so a wakeup.
+uint32_t timer_wheel_align(uint32_t expires, uint32_t slack) {
+    if (slack <= 1) return expires;
+    uint32_t remainder = expires % slack;
+    return remainder == 0 ? expires : expires + (slack - remainder);
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, wheel_timer_t *timer, uint32_t expires) {
+    if (timer->pending) {
+        timer_wheel_cancel(wheel, timer);
+    }
+    timer->expires = expires;
+    timer->pending = true;
+    wheel->pending++;
+    place_timer(wheel, timer);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, wheel_timer_t *timer) {
+    if (!timer->pending) return;
+    unlink_timer(timer);
+    timer->pending = false;
+    wheel->pending--;
+}
+
+// Process ticks up to and including 'now', moving due timers to the expired list
+void timer_wheel_advance(timer_wheel_t *wheel, uint32_t now) {
+    while ((int32_t)(now - wheel->now) >= 0) {
+        uint32_t index = wheel->now & TIMER_WHEEL_MASK;
+        if (index == 0) {
+            // Cascade from the highest level that wrapped, so timers can fall
+            // through more than one level on the same tick
+            int level = 1;
+            while (level < TIMER_WHEEL_LEVELS - 1 && ((wheel->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK) == 0) {
+                level++;
+            }
+            if (level == TIMER_WHEEL_LEVELS - 1) {
+                migrate_overflow(wheel);
+            }
+            for (; level >= 1; level--) {
+                cascade(wheel, level);
+            }
+        }
+
+        wheel_slot_t *slot = &wheel->slots[0][index];
+        while (!slot_empty(slot)) {
+            wheel_timer_t *timer = slot->head.next;
+            unlink_timer(timer);
+            slot_append(&wheel->expired, timer);
+        }
+        wheel->now++;
+
+        // Nothing left anywhere: jump straight to the target tick
+        if (wheel->pending == 0) {
+            wheel->now = now + 1;
+            break;
+        }
+    }
+}
+
+wheel_timer_t *timer_wheel_pop_expired(timer_wheel_t *wheel) {
+    if (slot_empty(&wheel->expired)) return NULL;
+    wheel_timer_t *timer = wheel->expired.head.next;
+    unlink_timer(timer);
+    timer->pending = false;
+    wheel->pending--;
+    return timer;
+}
+
+static bool slot_min_expiry(const wheel_slot_t *slot, uint32_t *best, bool found) {
+    for (const wheel_timer_t *t = slot->head.next; t != &slot->head; t = t->next) {
+        if (!found || (int32_t)(t->expires - *best) < 0) {
+            *best = t->expires;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Earliest pending deadline. Scans at most one non-empty slot per level, plus
+// the overflow list.
+bool timer_wheel_next_expiry(const timer_wheel_t *wheel, uint32_t *expires) {
+    bool found = false;
+    uint32_t best = 0;
+
+    if (!slot_empty(&wheel->expired)) {
+        *expires = wheel->now;
+        return true;
+    }
+    if (wheel->pending == 0) return false;
+
+    for (uint32_t k = 0; k < TIMER_WHEEL_SLOTS; k++) {
+        const wheel_slot_t *slot = &wheel->slots[0][(wheel->now + k) & TIMER_WHEEL_MASK];
+        if (!slot_empty(slot)) {
+            found = slot_min_expiry(slot, &best, found);
+            break;
+        }
+    }
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        uint32_t base = wheel->now >> (TIMER_WHEEL_BITS * level);
+        // On a slot boundary the current slot has not been cascaded yet
+        uint32_t first = (wheel->now & ((1u << (TIMER_WHEEL_BITS * level)) - 1)) == 0 ? 0 : 1;
+        for (uint32_t k = first; k < first + TIMER_WHEEL_SLOTS; k++) {
+            const wheel_slot_t *slot = &wheel->slots[level][(base + k) & TIMER_WHEEL_MASK];
+            if (!slot_empty(slot)) {
+                found = slot_min_expiry(slot, &best, found);
+                break;
+            }
+        }
+    }
+
+    found = slot_min_expiry(&wheel->overflow, &best, found);
+
+    // Bound the ticks a single advance has to walk when only far timers remain
+    if (found && (int32_t)(best - wheel->now) >= (int32_t)TIMER_WHEEL_RANGE) {
+        best = wheel->now + TIMER_WHEEL_RANGE - 1;
+    }
+    if (found) *expires = best;
+    return found;
+}
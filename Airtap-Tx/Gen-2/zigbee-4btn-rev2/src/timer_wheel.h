@@ -0,0 +1,56 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+// Hierarchical timer wheel with O(1) insert and cancel. Plain C with no
+// ESP-IDF dependencies; the caller supplies the tick count and the locking.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_BITS    6
+#define TIMER_WHEEL_SLOTS   (1u << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK    (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS  3
+// Longest delay held in the wheel itself (64^3 ticks, ~43 min at 10 ms);
+// later timers wait on an overflow list until they come within range
+#define TIMER_WHEEL_RANGE   (1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+struct wheel_timer;
+typedef void (*wheel_timer_cb_t)(struct wheel_timer *timer, void *arg);
+
+// Intrusive timer node; owned by the caller, never allocated by the wheel
+typedef struct wheel_timer {
+    struct wheel_timer *next;
+    struct wheel_timer *prev;
+    uint32_t expires;           // Absolute tick
+    uint32_t period;            // Ticks between runs, 0 for one-shot
+    uint32_t slack;             // Allowed lateness used to align deadlines
+    wheel_timer_cb_t cb;
+    void *arg;
+    const char *name;
+    bool pending;
+} wheel_timer_t;
+
+typedef struct {
+    wheel_timer_t head;         // Sentinel of a circular list
+} wheel_slot_t;
+
+typedef struct {
+    uint32_t now;               // Next tick to be processed
+    uint32_t pending;           // Timers currently in the wheel or expired list
+    wheel_slot_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    wheel_slot_t overflow;      // Beyond TIMER_WHEEL_RANGE, in no particular order
+    wheel_slot_t expired;
+} timer_wheel_t;
+
+// Function prototypes
+void timer_wheel_init(timer_wheel_t *wheel, uint32_t now);
+void timer_wheel_timer_init(wheel_timer_t *timer, const char *name, wheel_timer_cb_t cb, void *arg);
+uint32_t timer_wheel_align(uint32_t expires, uint32_t slack);
+void timer_wheel_add(timer_wheel_t *wheel, wheel_timer_t *timer, uint32_t expires);
+void timer_wheel_cancel(timer_wheel_t *wheel, wheel_timer_t *timer);
+void timer_wheel_advance(timer_wheel_t *wheel, uint32_t now);
+wheel_timer_t *timer_wheel_pop_expired(timer_wheel_t *wheel);
+bool timer_wheel_next_expiry(const timer_wheel_t *wheel, uint32_t *expires);
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,127 @@
+#include "trace.h"
+#include "trace_hooks.h"
+#include "console.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include <stdio.h>
+
+static const char *TAG = "TRACE";
+
+#if CONFIG_AIRTAP_TRACE
+
+#define TRACE_RING_LEN  CONFIG_AIRTAP_TRACE_EVENTS
+#define TRACE_BENCH_CALLS   1000
+#define TRACE_BUDGET_NS     1000    // Recording must stay under 1 us per event
+_Static_assert((TRACE_RING_LEN & (TRACE_RING_LEN - 1)) == 0, "trace ring length must be a power of two");
+
+typedef struct {
+    uint32_t time_us;           // Low 32 bits of esp_timer, wraps every ~71 min
+    const void *id;
+    uint32_t type;
+} trace_event_t;
+
+static trace_event_t events[TRACE_RING_LEN];
+static uint32_t head = 0;       // Total events recorded; the ring keeps the last TRACE_RING_LEN
+static volatile bool recording = false;
+
+// Called from the scheduler with interrupts masked, and from ISRs, so it must
+// stay in IRAM and do nothing but a timestamp read and a slot store
+void IRAM_ATTR trace_record(trace_event_type_t type, const void *id) {
+    if (!recording) return;
+    UBaseType_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_event_t *ev = &events[head++ & (TRACE_RING_LEN - 1)];
+    ev->time_us = (uint32_t)esp_timer_get_time();
+    ev->id = id;
+    ev->type = type;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+void IRAM_ATTR trace_task_switched_in(void) {
+    trace_record(TRACE_EV_TASK_IN, xTaskGetCurrentTaskHandle());
+}
+
+// One line per record, prefixed with '@' so the converter can pick them out
+// of regular log output. Recording pauses while the ring is printed.
+void trace_dump(void) {
+    recording = false;
+
+    TaskStatus_t tasks[16];
+    UBaseType_t num_tasks = uxTaskGetSystemState(tasks, 16, NULL);
+    uint32_t total = head;
+    uint32_t count = total < TRACE_RING_LEN ? total : TRACE_RING_LEN;
+
+    printf("@begin,%lu,%lu\n", (unsigned long)count, (unsigned long)(total - count));
+    for (UBaseType_t i = 0; i < num_tasks; i++) {
+        printf("@task,%p,%s\n", tasks[i].xHandle, tasks[i].pcTaskName);
+    }
+    for (uint32_t i = total - count; i != total; i++) {
+        const trace_event_t *ev = &events[i & (TRACE_RING_LEN - 1)];
+        if (ev->type == TRACE_EV_TASK_IN) {
+            printf("@ev,%lu,%lu,%p\n", (unsigned long)ev->time_us, (unsigned long)ev->type, ev->id);
+        } else {
+            printf("@ev,%lu,%lu,%s\n", (unsigned long)ev->time_us, (unsigned long)ev->type, (const char *)ev->id);
+        }
+    }
+    printf("@end\n");
+
+    head = 0;
+    recording = true;
+}
+
+// Times TRACE_BENCH_CALLS records (loop overhead included) and derives the
+// clock from the cycle count, so the figure says which DFS step it is for
+static void trace_bench_run(void) {
+    int64_t start_us = esp_timer_get_time();
+    esp_cpu_cycle_count_t start_cycles = esp_cpu_get_cycle_count();
+    for (int i = 0; i < TRACE_BENCH_CALLS; i++) {
+        trace_record(TRACE_EV_INSTANT, "trace_bench");
+    }
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    uint32_t ns = (uint32_t)(elapsed_us * 1000 / TRACE_BENCH_CALLS);
+    uint32_t mhz = elapsed_us > 0 ? (uint32_t)(cycles / elapsed_us) : 0;
+    printf("trace_record: %lu cycles, %lu ns per event at %lu MHz (budget %d ns)%s\n",
+           (unsigned long)(cycles / TRACE_BENCH_CALLS), (unsigned long)ns, (unsigned long)mhz, TRACE_BUDGET_NS,
+           ns > TRACE_BUDGET_NS ? " OVER" : "");
+}
+
+// Runs at the clock the console task gets (the DFS floor unless something
+// holds a frequency lock), then at the maximum. The bench events push the
+// captured ones out, so the ring starts over afterwards.
+static void trace_bench(void) {
+    trace_bench_run();
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t lock;
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "trace_bench", &lock) == ESP_OK) {
+        esp_pm_lock_acquire(lock);
+        trace_bench_run();
+        esp_pm_lock_release(lock);
+        esp_pm_lock_delete(lock);
+    }
+#endif
+    recording = false;
+    head = 0;
+    recording = true;
+}
+
+void trace_init(void) {
+    console_register("trace", "dump the scheduling trace", trace_dump);
+    console_register("tracebench", "time trace_record (clears the trace)", trace_bench);
+    recording = true;
+    ESP_LOGI(TAG, "Tracing %d events (%u bytes)", TRACE_RING_LEN, (unsigned)sizeof(events));
+}
+
+#else
+
+void trace_init(void) {}
+void trace_record(trace_event_type_t type, const void *id) {}
+void trace_dump(void) {
+    ESP_LOGW(TAG, "Tracing disabled (CONFIG_AIRTAP_TRACE)");
+}
+
+#endif
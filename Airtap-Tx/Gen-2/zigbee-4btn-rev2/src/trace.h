@@ -0,0 +1,41 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Scheduling trace: context switches, ISR entry/exit and user markers in a
+// fixed RAM ring that keeps the most recent events. Type "trace" on the
+// console to dump it, then convert with tools/trace_to_chrome.py.
+
+typedef enum {
+    TRACE_EV_TASK_IN = 1,   // id: task handle
+    TRACE_EV_ISR_ENTER,     // id: ISR name
+    TRACE_EV_ISR_EXIT,
+    TRACE_EV_BEGIN,         // id: marker name
+    TRACE_EV_END,
+    TRACE_EV_INSTANT,
+} trace_event_type_t;
+
+// Function prototypes
+void trace_init(void);
+void trace_record(trace_event_type_t type, const void *id);
+void trace_dump(void);
+
+// Names must be string literals; the dump reads them by address
+#if CONFIG_AIRTAP_TRACE
+#define TRACE_ISR_ENTER(name)   trace_record(TRACE_EV_ISR_ENTER, (name))
+#define TRACE_ISR_EXIT(name)    trace_record(TRACE_EV_ISR_EXIT, (name))
+#define TRACE_BEGIN(name)       trace_record(TRACE_EV_BEGIN, (name))
+#define TRACE_END(name)         trace_record(TRACE_EV_END, (name))
+#define TRACE_INSTANT(name)     trace_record(TRACE_EV_INSTANT, (name))
+#else
+#define TRACE_ISR_ENTER(name)
+#define TRACE_ISR_EXIT(name)
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#define TRACE_INSTANT(name)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,20 @@
+#ifndef TRACE_HOOKS_H
+#define TRACE_HOOKS_H
+
+// Force-included into every translation unit (see the project CMakeLists.txt)
+// so the FreeRTOS kernel picks up these trace macros instead of its empty
+// defaults. Keep this header to macros and prototypes only.
+
+#if !defined(__ASSEMBLER__) && defined(__has_include)
+#if __has_include("sdkconfig.h")
+#include "sdkconfig.h"
+
+#if CONFIG_AIRTAP_TRACE
+void trace_task_switched_in(void);
+#define traceTASK_SWITCHED_IN() trace_task_switched_in()
+#endif
+
+#endif
+#endif
+
+#endif // TRACE_HOOKS_H
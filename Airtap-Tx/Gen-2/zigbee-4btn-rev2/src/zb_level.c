@@ -0,0 +1,17 @@
+#include "zb_level.h"
+
+// Both directions round to the nearest. A speed step is finer than a level
+// step, so any level a hub writes reads back unchanged; a running fan never
+// reports level 0.
+int zb_level_to_speed(uint8_t level) {
+    if (level > ZB_LEVEL_MAX) level = ZB_LEVEL_MAX;
+    return (level * ZB_LEVEL_SPEED_MAX + ZB_LEVEL_MAX / 2) / ZB_LEVEL_MAX;
+}
+
+uint8_t zb_speed_to_level(int speed) {
+    if (speed < 0) speed = 0;
+    if (speed > ZB_LEVEL_SPEED_MAX) speed = ZB_LEVEL_SPEED_MAX;
+    int level = (speed * ZB_LEVEL_MAX + ZB_LEVEL_SPEED_MAX / 2) / ZB_LEVEL_SPEED_MAX;
+    if (speed > 0 && level == 0) level = 1;
+    return (uint8_t)level;
+}
@@ -0,0 +1,19 @@
+#ifndef ZB_LEVEL_H
+#define ZB_LEVEL_H
+
+// Mapping between the Zigbee Level Control CurrentLevel and the per-mille
+// fan speed. Plain C with no ESP-IDF dependencies so it can be exercised on
+// the host.
+
+#include <stdint.h>
+
+// Highest valid Level Control CurrentLevel; 255 is reserved by the ZCL
+#define ZB_LEVEL_MAX    254
+
+// Full scale of the speed side, the same as FAN_SPEED_MAX in device_state.h
+#define ZB_LEVEL_SPEED_MAX 1000
+
+int zb_level_to_speed(uint8_t level);
+uint8_t zb_speed_to_level(int speed);
+
+#endif // ZB_LEVEL_H
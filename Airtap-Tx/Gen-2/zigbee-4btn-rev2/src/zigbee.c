@@ -1,37 +1,96 @@
 #include "zigbee.h"
+#include "device_state.h"
 #include "led_control.h"
 #include "fan_control.h"
 #include "temperature.h"
 #include "oled_display.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "boot_timing.h"
+#include "commands.h"
+#include "trace.h"
+#include "stack_monitor.h"
+#include "crash_log.h"
+#include "zb_level.h"
+#include "soak.h"
 #include "esp_timer.h"
+#include <string.h>
+
+_Static_assert(ZB_LEVEL_SPEED_MAX == FAN_SPEED_MAX, "zb_level.c must scale to the fan speed range");
 
 static const char *TAG = "ZIGBEE";
 
-// Zigbee state variables
-bool pairing_mode_active = false;
-bool factory_reset_pending = false;
-bool zb_joined = false;
+// Zigbee state variables (pairing/joined/reset flags live in device_state)
 static uint8_t pairing_retry_count = 0;
+static volatile bool zb_stack_started = false;
+
+// Deferred work on the main-loop scheduler; static so retries never allocate
+static sched_job_t retry_job;
+static sched_job_t report_job;
 
-// Retry callback function
-static void zigbee_retry_callback(void* arg) {
-    if (pairing_mode_active) {
-        ESP_LOGI(TAG, "Retrying network steering now (attempt %d/5)", pairing_retry_count);
+// Retry callback function (main task, so the stack lock is required)
+static void zigbee_retry_callback(sched_job_t *job, void *arg) {
+    if (device_state_get().pairing_active) {
+        ESP_LOGI(TAG, "Retrying network steering now (attempt %d/%d)", pairing_retry_count, ZB_STEERING_MAX_RETRIES);
+        esp_zb_lock_acquire(portMAX_DELAY);
         esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
+        esp_zb_lock_release();
+    }
+}
+
+// Update a diagnostics attribute if it changed; caller holds the stack lock
+static void zb_update_diag_attr(uint16_t attr_id, void *value, size_t size) {
+    esp_zb_zcl_attr_t *attr = esp_zb_zcl_get_attribute(HA_ESP_LIGHT_ENDPOINT, ZB_DIAG_CLUSTER_ID,
+                                                       ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr_id);
+    if (attr && memcmp(attr->data_p, value, size) != 0) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_LIGHT_ENDPOINT, ZB_DIAG_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     attr_id, value, false);
     }
 }
 
-// ZCL state variables
-static uint8_t zcl_onoff_attr = 0;
-static uint8_t zcl_level_attr = 0;
-static int16_t zcl_temp_measured = 0;
+// Load the crash summary chunk at offset into the chunk attribute (octet
+// string: length byte, then data); Zigbee task only
+static void zb_load_crash_chunk(uint16_t offset) {
+    uint8_t chunk[ZB_DIAG_CRASH_CHUNK_LEN + 1];
+    chunk[0] = (uint8_t)crash_log_read(offset, &chunk[1], ZB_DIAG_CRASH_CHUNK_LEN);
+    esp_zb_zcl_set_attribute_val(HA_ESP_LIGHT_ENDPOINT, ZB_DIAG_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ZB_DIAG_ATTR_CRASH_CHUNK, chunk, false);
+}
+
+// Offset written by the hub, loaded once the attribute write has completed;
+// only touched in the Zigbee task
+static uint16_t crash_chunk_offset;
+
+static void zb_crash_chunk_alarm(uint8_t param) {
+    zb_load_crash_chunk(crash_chunk_offset);
+}
+
+// Push the latest temperature sample and diagnostics into the ZCL attributes when they changed
+static void zigbee_report_callback(sched_job_t *job, void *arg) {
+    if (!zb_stack_started) return;
+
+    int16_t temp_centi = device_state_get().temp_centi;
+    uint32_t stack_free = stack_monitor_min_free();
+    uint16_t min_stack_free = stack_free > UINT16_MAX ? UINT16_MAX : (uint16_t)stack_free;
+    uint8_t low_stack_tasks = stack_monitor_low_count();
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_attr_t *temp_attr = esp_zb_zcl_get_attribute(HA_ESP_LIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
+                                                            ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID);
+    if (temp_attr && *(int16_t *)temp_attr->data_p != temp_centi) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_LIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID, &temp_centi, false);
+    }
+    zb_update_diag_attr(ZB_DIAG_ATTR_MIN_STACK_FREE, &min_stack_free, sizeof(min_stack_free));
+    zb_update_diag_attr(ZB_DIAG_ATTR_LOW_STACK_TASKS, &low_stack_tasks, sizeof(low_stack_tasks));
+    esp_zb_lock_release();
+}
 
 // Forward declarations
 static void trigger_factory_reset(void);
 static void trigger_pairing_mode(void);
 static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message);
 static esp_err_t zb_action_handler(esp_zb_core_action_callback_id_t callback_id, const void *message);
-
+static void zb_state_changed(const device_state_t *state, uint32_t changed, void *arg);
 
 void zigbee_init(void) {
     // Initialize Zigbee platform
@@ -44,28 +103,38 @@ void zigbee_init(void) {
         },
     };
     ESP_ERROR_CHECK(esp_zb_platform_config(&config_zb));
+    device_state_subscribe(DEVICE_STATE_FAN_SPEED | DEVICE_STATE_PANEL_LOCK, zb_state_changed, NULL);
+    scheduler_job_init(&retry_job, "zb_retry", zigbee_retry_callback, NULL);
+    scheduler_job_init(&report_job, "zb_report", zigbee_report_callback, NULL);
     ESP_LOGI(TAG, "Zigbee platform initialized");
 }
 
+// Pairing and reset are requested from the main loop, so the stack lock is
+// required around the BDB calls (the signal handler calls them directly)
 void zigbee_start_pairing(void) {
     ESP_LOGI(TAG, "Starting Zigbee pairing mode with extended scanning");
-    pairing_mode_active = true;
+    device_state_set_pairing(true);
     pairing_retry_count = 0; // Reset retry counter
     
     // Start network steering with extended parameters
+    esp_zb_lock_acquire(portMAX_DELAY);
     esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
+    esp_zb_lock_release();
 }
 
 void zigbee_cancel_pairing(void) {
     ESP_LOGI(TAG, "Cancelling pairing mode");
-    pairing_mode_active = false;
+    device_state_set_pairing(false);
     pairing_retry_count = 0; // Reset retry counter
+    scheduler_cancel(&retry_job);
 }
 
 void zigbee_factory_reset(void) {
     ESP_LOGI(TAG, "Factory reset triggered");
-    factory_reset_pending = true;
+    device_state_set_reset_pending(true);
+    esp_zb_lock_acquire(portMAX_DELAY);
     esp_zb_bdb_reset_via_local_action();
+    esp_zb_lock_release();
 }
 
 static void trigger_factory_reset(void) {
@@ -78,6 +147,8 @@ static void trigger_pairing_mode(void) {
 
 // Zigbee signal handler
 void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct) {
+    PROF_START(handler_start);
+    TRACE_BEGIN("zb_signal");
     uint32_t *p_sg_p = signal_struct->p_app_signal;
     esp_err_t err_status = signal_struct->esp_err_status;
     esp_zb_app_signal_type_t sig_type = *p_sg_p;
@@ -91,10 +162,10 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct) {
     case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT:
         if (err_status == ESP_OK) {
             ESP_LOGI(TAG, "Device started up in %s factory-reset mode", esp_zb_bdb_is_factory_new() ? "" : "non");
-            zb_joined = !esp_zb_bdb_is_factory_new();
+            device_state_set_zb_joined(!esp_zb_bdb_is_factory_new());
             if (esp_zb_bdb_is_factory_new()) {
                 ESP_LOGI(TAG, "Starting network steering (factory new device)");
-                pairing_mode_active = true;
+                device_state_set_pairing(true);
                 esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
             } else {
                 ESP_LOGI(TAG, "Device rebooted - already joined to network");
@@ -104,6 +175,11 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct) {
         }
         break;
     case ESP_ZB_BDB_SIGNAL_STEERING:
+#if CONFIG_AIRTAP_SOAK
+        if (err_status == ESP_OK && soak_zb_fault()) {
+            err_status = ESP_FAIL;
+        }
+#endif
         if (err_status == ESP_OK) {
             esp_zb_ieee_addr_t extended_pan_id;
             esp_zb_get_extended_pan_id(extended_pan_id);
@@ -111,38 +187,37 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct) {
                      extended_pan_id[7], extended_pan_id[6], extended_pan_id[5], extended_pan_id[4],
                      extended_pan_id[3], extended_pan_id[2], extended_pan_id[1], extended_pan_id[0],
                      esp_zb_get_pan_id(), esp_zb_get_current_channel(), esp_zb_get_short_address());
-            zb_joined = true;
-            pairing_mode_active = false;
+            device_state_set_zb_joined(true);
+            device_state_set_pairing(false);
             pairing_retry_count = 0; // Reset retry counter on success
         } else {
             ESP_LOGI(TAG, "Network steering was not successful (status: %s)", esp_err_to_name(err_status));
-            zb_joined = false;
+            device_state_set_zb_joined(false);
             
-            // Implement retry logic with proper timing
-            if (pairing_mode_active && pairing_retry_count < 5) {
+            // Retry with exponential backoff
+            if (device_state_get().pairing_active && pairing_retry_count < ZB_STEERING_MAX_RETRIES) {
+                uint32_t delay_ms = ZB_STEERING_RETRY_BASE_MS << pairing_retry_count;
+                if (delay_ms > ZB_STEERING_RETRY_MAX_MS) delay_ms = ZB_STEERING_RETRY_MAX_MS;
                 pairing_retry_count++;
-                ESP_LOGI(TAG, "Will retry network steering in 3 seconds (attempt %d/5)", pairing_retry_count);
-                
-                // Schedule retry after delay
-                esp_timer_handle_t retry_timer;
-                esp_timer_create_args_t timer_args = {
-                    .callback = zigbee_retry_callback,
-                    .name = "zigbee_retry"
-                };
-                esp_timer_create(&timer_args, &retry_timer);
-                esp_timer_start_once(retry_timer, 3000000); // 3 seconds in microseconds
-            } else if (pairing_retry_count >= 5) {
+                ESP_LOGI(TAG, "Will retry network steering in %lu ms (attempt %d/%d)", delay_ms, pairing_retry_count, ZB_STEERING_MAX_RETRIES);
+                scheduler_start(&retry_job, delay_ms, 0, 0);
+            } else if (pairing_retry_count >= ZB_STEERING_MAX_RETRIES) {
                 ESP_LOGI(TAG, "Max retries reached, stopping pairing mode");
-                pairing_mode_active = false;
+                device_state_set_pairing(false);
                 pairing_retry_count = 0;
             }
         }
         break;
+#if CONFIG_PM_ENABLE
+    case ESP_ZB_COMMON_SIGNAL_CAN_SLEEP:
+        esp_zb_sleep_now();
+        break;
+#endif
     case ESP_ZB_ZDO_SIGNAL_LEAVE:
         if (err_status == ESP_OK) {
             ESP_LOGI(TAG, "Device left network");
-            zb_joined = false;
-            factory_reset_pending = false;
+            device_state_set_zb_joined(false);
+            device_state_set_reset_pending(false);
         }
         break;
     default:
@@ -150,6 +225,8 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct) {
                  esp_err_to_name(err_status));
         break;
     }
+    TRACE_END("zb_signal");
+    PROF_END(PROF_ZB_ITERATION, handler_start);
 }
 
 // Zigbee attribute handler
@@ -174,33 +251,66 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID && message->attribute.data.type == ESP_ZB_ZCL_ATTR_TYPE_BOOL) {
                 bool state = message->attribute.data.value ? *(bool *)message->attribute.data.value : false;
                 ESP_LOGI(TAG, "Fan state set to %s", state ? "ON" : "OFF");
-                zcl_onoff_attr = state ? 1 : 0;
                 
-                if (state) {
-                    fan_set_speed(10); // Turn fan on to max speed
-                } else {
-                    fan_set_speed(0); // Turn fan off
-                }
+                // Applied by the main loop; on turns the fan to max speed
+                commands_post(CMD_SET_SPEED, state ? FAN_SPEED_MAX : 0);
             }
         }
-        // Handle level control for fan speed (0-255 maps to 0-10)
+        // Handle level control for fan speed (0-254 maps to 0-1000 per mille)
         else if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL) {
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID && message->attribute.data.type == ESP_ZB_ZCL_ATTR_TYPE_U8) {
                 uint8_t level = message->attribute.data.value ? *(uint8_t *)message->attribute.data.value : 0;
                 ESP_LOGI(TAG, "Fan level set to %d", level);
-                zcl_level_attr = level;
                 
-                // Map level (0-255) to fan speed (0-10)
-                uint8_t fan_speed = (level * 10) / 255;
-                fan_set_speed(fan_speed);
+                commands_post(CMD_SET_SPEED, zb_level_to_speed(level));
+            }
+        }
+        // Crash summary retrieval: a hub writes the offset, then reads the chunk
+        else if (message->info.cluster == ZB_DIAG_CLUSTER_ID) {
+            if (message->attribute.id == ZB_DIAG_ATTR_CRASH_OFFSET && message->attribute.data.type == ESP_ZB_ZCL_ATTR_TYPE_U16) {
+                // Setting another attribute from inside the write callback is not
+                // safe, so the chunk is refreshed from an alarm right after it
+                crash_chunk_offset = message->attribute.data.value ? *(uint16_t *)message->attribute.data.value : 0;
+                esp_zb_scheduler_alarm(zb_crash_chunk_alarm, 0, 0);
+            } else if (message->attribute.id == ZB_DIAG_ATTR_PANEL_LOCK && message->attribute.data.type == ESP_ZB_ZCL_ATTR_TYPE_BOOL) {
+                bool locked = message->attribute.data.value ? *(bool *)message->attribute.data.value : false;
+                ESP_LOGI(TAG, "Panel lock set to %s", locked ? "ON" : "OFF");
+                commands_post(CMD_PANEL_LOCK, locked);
             }
         }
     }
     return ret;
 }
 
+// Mirror local fan and panel lock changes (buttons) into the ZCL attributes so the hub sees them.
+// Attributes that already match, e.g. because the hub just wrote them, are left alone.
+static void zb_state_changed(const device_state_t *state, uint32_t changed, void *arg) {
+    if (!zb_stack_started) return;
+
+    bool on = state->fan_speed > 0;
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_zcl_attr_t *onoff_attr = esp_zb_zcl_get_attribute(HA_ESP_LIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                                             ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID);
+    if (onoff_attr && *(bool *)onoff_attr->data_p != on) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_LIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &on, false);
+    }
+    esp_zb_zcl_attr_t *level_attr = esp_zb_zcl_get_attribute(HA_ESP_LIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
+                                                             ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID);
+    uint8_t level = zb_speed_to_level(state->fan_speed);
+    if (on && level_attr && *(uint8_t *)level_attr->data_p != level) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_LIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, &level, false);
+    }
+    bool locked = state->panel_locked;
+    zb_update_diag_attr(ZB_DIAG_ATTR_PANEL_LOCK, &locked, sizeof(locked));
+    esp_zb_lock_release();
+}
+
 // Zigbee action handler
 static esp_err_t zb_action_handler(esp_zb_core_action_callback_id_t callback_id, const void *message) {
+    PROF_START(handler_start);
+    TRACE_BEGIN("zb_action");
     esp_err_t ret = ESP_OK;
     switch (callback_id) {
     case ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID:
@@ -210,6 +320,8 @@ static esp_err_t zb_action_handler(esp_zb_core_action_callback_id_t callback_id,
         ESP_LOGW(TAG, "Receive Zigbee action(0x%x) callback", callback_id);
         break;
     }
+    TRACE_END("zb_action");
+    PROF_END(PROF_ZB_ITERATION, handler_start);
     return ret;
 }
 
@@ -223,6 +335,10 @@ void zigbee_task(void *pvParameters) {
             .keep_alive = 3000,
         },
     };
+#if CONFIG_PM_ENABLE
+    // Let the stack power down the radio between polls so light sleep can engage
+    esp_zb_sleep_enable(true);
+#endif
     esp_zb_init(&zb_nwk_cfg);
     
     // Create a custom endpoint with proper vendor information
@@ -230,6 +346,13 @@ void zigbee_task(void *pvParameters) {
     
     // Create basic cluster with vendor information
     esp_zb_color_dimmable_light_cfg_t light_cfg = ESP_ZB_DEFAULT_COLOR_DIMMABLE_LIGHT_CONFIG();
+    
+    // Start the attributes from the speed restored at boot so the hub sees the real state
+    int restored_speed = device_state_get().fan_speed;
+    light_cfg.on_off_cfg.on_off = restored_speed > 0;
+    if (restored_speed > 0) {
+        light_cfg.level_cfg.current_level = zb_speed_to_level(restored_speed);
+    }
     esp_zb_attribute_list_t *basic_cluster = esp_zb_basic_cluster_create(&(light_cfg.basic_cfg));
     ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, MANUFACTURER_NAME));
     ESP_ERROR_CHECK(esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID, MODEL_IDENTIFIER));
@@ -245,6 +368,38 @@ void zigbee_task(void *pvParameters) {
     // Add level control cluster for fan speed control
     ESP_ERROR_CHECK(esp_zb_cluster_list_add_level_cluster(cluster_list, esp_zb_level_cluster_create(&(light_cfg.level_cfg)), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
     
+    // Add temperature measurement cluster for the NTC reading
+    esp_zb_temperature_meas_cluster_cfg_t temp_cfg = {
+        .measured_value = device_state_get().temp_centi,
+        .min_value = -4000,
+        .max_value = 12500,
+    };
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_temperature_meas_cluster(cluster_list, esp_zb_temperature_meas_cluster_create(&temp_cfg), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+    
+    // Add manufacturer-specific diagnostics cluster (refreshed by the report job) and settings
+    uint16_t min_stack_free = UINT16_MAX;
+    uint8_t low_stack_tasks = 0;
+    esp_zb_attribute_list_t *diag_cluster = esp_zb_zcl_attr_list_create(ZB_DIAG_CLUSTER_ID);
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(diag_cluster, ZB_DIAG_ATTR_MIN_STACK_FREE, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &min_stack_free));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(diag_cluster, ZB_DIAG_ATTR_LOW_STACK_TASKS, ESP_ZB_ZCL_ATTR_TYPE_U8,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &low_stack_tasks));
+    uint16_t crash_size = (uint16_t)crash_log_size();
+    uint16_t crash_offset = 0;
+    // The stack sizes a string attribute from its initial value, so create
+    // the chunk at full length and load the real bytes after registering
+    uint8_t crash_chunk[ZB_DIAG_CRASH_CHUNK_LEN + 1] = { ZB_DIAG_CRASH_CHUNK_LEN };
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(diag_cluster, ZB_DIAG_ATTR_CRASH_SIZE, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &crash_size));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(diag_cluster, ZB_DIAG_ATTR_CRASH_OFFSET, ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &crash_offset));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(diag_cluster, ZB_DIAG_ATTR_CRASH_CHUNK, ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, crash_chunk));
+    bool panel_locked = device_state_get().panel_locked;
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(diag_cluster, ZB_DIAG_ATTR_PANEL_LOCK, ESP_ZB_ZCL_ATTR_TYPE_BOOL,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &panel_locked));
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_custom_cluster(cluster_list, diag_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+    
     // Create endpoint with custom clusters
     esp_zb_ep_list_t *ep_list = esp_zb_ep_list_create();
     esp_zb_endpoint_config_t endpoint_config = {
@@ -257,13 +412,15 @@ void zigbee_task(void *pvParameters) {
     
     // Register device and start
     esp_zb_device_register(ep_list);
+    zb_load_crash_chunk(0);
     esp_zb_core_action_handler_register(zb_action_handler);
     esp_zb_set_primary_network_channel_set(ESP_ZB_TRANSCEIVER_ALL_CHANNELS_MASK); // Scan all channels
     ESP_ERROR_CHECK(esp_zb_start(false));
+    zb_stack_started = true;
+    boot_timing_mark("zigbee_start");
+    scheduler_start(&report_job, ZB_REPORT_INTERVAL_MS, ZB_REPORT_INTERVAL_MS, SCHEDULER_COALESCE_MS);
     
-    // Main Zigbee loop
-    while (true) {
-        esp_zb_main_loop_iteration();
-        vTaskDelay(pdMS_TO_TICKS(10)); // Small delay to prevent watchdog issues
-    }
+    // Runs the stack for good; its work reaches the firmware through the
+    // signal and action handlers, which is where it is profiled and traced
+    esp_zb_stack_main_loop();
 }
@@ -9,18 +9,32 @@
 #include "esp_zigbee_cluster.h"
 #include "esp_zigbee_endpoint.h"
 
-// Zigbee state
-extern bool pairing_mode_active;
-extern bool factory_reset_pending;
-extern bool zb_joined;
-
 // Endpoint used by our device
 #define HA_ESP_LIGHT_ENDPOINT 10
 
+// Network steering retries: 3 s, doubling per attempt up to 60 s
+#define ZB_STEERING_MAX_RETRIES     5
+#define ZB_STEERING_RETRY_BASE_MS   3000
+#define ZB_STEERING_RETRY_MAX_MS    60000
+
+// How often the temperature attribute is refreshed for reporting
+#define ZB_REPORT_INTERVAL_MS       30000
+
+// Manufacturer-specific diagnostics and settings cluster on the same endpoint
+#define ZB_DIAG_CLUSTER_ID              0xFC00
+#define ZB_DIAG_ATTR_MIN_STACK_FREE     0x0000  // U16, lowest stack headroom of any task (bytes)
+#define ZB_DIAG_ATTR_LOW_STACK_TASKS    0x0001  // U8, tasks below the warning threshold
+// Crash summary, read in chunks: write the offset, then read the chunk
+#define ZB_DIAG_ATTR_CRASH_SIZE         0x0010  // U16, 0 when no crash is recorded
+#define ZB_DIAG_ATTR_CRASH_OFFSET       0x0011  // U16, writable
+#define ZB_DIAG_ATTR_CRASH_CHUNK        0x0012  // Octet string, summary bytes from the offset
+#define ZB_DIAG_CRASH_CHUNK_LEN         64      // Fits an unfragmented read response
+#define ZB_DIAG_ATTR_PANEL_LOCK         0x0020  // Bool, writable: ignore the buttons except the unlock chord
+
 // Add vendor information constants at the top after the includes
 #define MANUFACTURER_NAME               "\x0C""SiloCityLabs"
 #define MODEL_IDENTIFIER                "\x0F""airtap-4btn-rev2"
-#define SW_BUILD_ID                     "\x08""1.0.0"
+#define SW_BUILD_ID                     "\x05""1.0.0"
 
 // Function prototypes
 void zigbee_init(void);
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+#include "debounce.h"
+
+// Replays synthetic contact traces through the debouncer at the firmware's
+// sample rate and checks every real press is seen once, promptly, and that
+// short glitches never register. Times are in microseconds.
+#define SAMPLE_MS       2
+#define DEBOUNCE_MS     20
+#define BOUNCE_MAX_US   5000
+#define MAX_CHANGES     64
+
+typedef struct {
+    int64_t time_us[MAX_CHANGES];
+    bool pressed[MAX_CHANGES];
+    int count;
+} trace_t;
+
+static debounce_t debounce;
+
+void setUp(void) {
+    debounce_init(&debounce, DEBOUNCE_MS, SAMPLE_MS, false);
+}
+
+void tearDown(void) {}
+
+// Random toggles for up to BOUNCE_MAX_US, then the settled level
+static void add_bouncy_edge(trace_t *trace, int64_t at_us, bool pressed, int max_pulses) {
+    int pulses = max_pulses ? rand() % (max_pulses + 1) : 0;
+    int64_t t = at_us;
+    bool level = pressed;
+    for (int i = 0; i < pulses * 2 && trace->count < MAX_CHANGES - 1; i++) {
+        trace->time_us[trace->count] = t;
+        trace->pressed[trace->count++] = level;
+        level = !level;
+        t += 1 + rand() % (BOUNCE_MAX_US / (max_pulses * 2));
+    }
+    trace->time_us[trace->count] = t;
+    trace->pressed[trace->count++] = pressed;
+}
+
+static bool level_at(const trace_t *trace, int64_t t_us) {
+    bool level = false;
+    for (int i = 0; i < trace->count && trace->time_us[i] <= t_us; i++) {
+        level = trace->pressed[i];
+    }
+    return level;
+}
+
+typedef struct {
+    int presses;
+    int releases;
+    int64_t first_press_us;
+    int64_t first_release_us;
+} replay_result_t;
+
+static replay_result_t replay(const trace_t *trace, int64_t end_us) {
+    replay_result_t result = { 0, 0, -1, -1 };
+    for (int64_t t = 0; t <= end_us; t += SAMPLE_MS * 1000) {
+        if (debounce_sample(&debounce, level_at(trace, t))) {
+            if (debounce.pressed) {
+                if (result.presses++ == 0) result.first_press_us = t;
+            } else {
+                if (result.releases++ == 0) result.first_release_us = t;
+            }
+        }
+    }
+    return result;
+}
+
+static void test_clean_press_latency(void) {
+    trace_t trace = { .count = 0 };
+    add_bouncy_edge(&trace, 10000, true, 0);
+    add_bouncy_edge(&trace, 110000, false, 0);
+    replay_result_t result = replay(&trace, 200000);
+    TEST_ASSERT_EQUAL(1, result.presses);
+    TEST_ASSERT_EQUAL(1, result.releases);
+    // Flips on the DEBOUNCE_MS / SAMPLE_MS-th agreeing sample
+    TEST_ASSERT_INT_WITHIN(SAMPLE_MS * 1000, 10000 + (DEBOUNCE_MS - SAMPLE_MS) * 1000, (int)result.first_press_us);
+}
+
+static void test_glitch_shorter_than_debounce_ignored(void) {
+    trace_t trace = { .count = 0 };
+    add_bouncy_edge(&trace, 10000, true, 0);
+    add_bouncy_edge(&trace, 10000 + (DEBOUNCE_MS - 2 * SAMPLE_MS) * 1000, false, 0);
+    replay_result_t result = replay(&trace, 100000);
+    TEST_ASSERT_EQUAL(0, result.presses);
+}
+
+// Thousands of bouncy presses of random length: no misses, no doubles, and
+// the worst-case latency stays within the bounce plus the debounce time
+static void test_bouncy_presses_replay(void) {
+    srand(4);
+    int missed = 0;
+    int extra = 0;
+    int64_t worst_latency = 0;
+    int64_t total_latency = 0;
+    const int runs = 5000;
+
+    for (int run = 0; run < runs; run++) {
+        debounce_init(&debounce, DEBOUNCE_MS, SAMPLE_MS, false);
+        trace_t trace = { .count = 0 };
+        int64_t hold_us = 40000 + rand() % 400000;
+        add_bouncy_edge(&trace, 10000, true, 4);
+        add_bouncy_edge(&trace, 10000 + hold_us, false, 4);
+        replay_result_t result = replay(&trace, 10000 + hold_us + 100000);
+
+        if (result.presses == 0) missed++;
+        if (result.presses > 1 || result.releases > 1) extra++;
+        if (result.presses > 0) {
+            int64_t latency = result.first_press_us - 10000;
+            total_latency += latency;
+            if (latency > worst_latency) worst_latency = latency;
+        }
+    }
+
+    char line[96];
+    snprintf(line, sizeof(line), "%d presses: %d missed, %d doubled, latency avg %lld us max %lld us",
+             runs, missed, extra, (long long)(total_latency / runs), (long long)worst_latency);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(0, missed);
+    TEST_ASSERT_EQUAL(0, extra);
+    TEST_ASSERT_LESS_OR_EQUAL(BOUNCE_MAX_US + (DEBOUNCE_MS + SAMPLE_MS) * 1000, (int)worst_latency);
+}
+
+static void test_settled_only_on_rail(void) {
+    TEST_ASSERT_TRUE(debounce_settled(&debounce));
+    debounce_sample(&debounce, true);
+    TEST_ASSERT_FALSE(debounce_settled(&debounce));
+    debounce_sample(&debounce, false);
+    TEST_ASSERT_TRUE(debounce_settled(&debounce));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_press_latency);
+    RUN_TEST(test_glitch_shorter_than_debounce_ignored);
+    RUN_TEST(test_bouncy_presses_replay);
+    RUN_TEST(test_settled_only_on_rail);
+    return UNITY_END();
+}
@@ -0,0 +1,226 @@
+#include <unity.h>
+#include "button_table.h"
+
+// Gesture engine traces: chord windows holding back member presses, taps,
+// late partners, double-clicks and repeats through a held-back press. The
+// local table has the Gen-4 UP+DOWN chords; the firmware table is checked
+// for the Gen-2 build this suite compiles. Times are in milliseconds.
+#define MAX_EVENTS  256
+#define WINDOW_MS   BUTTONS_CHORD_WINDOW_MS
+
+enum { A_UP = 1, A_DOWN, A_UP_DOUBLE, A_PAIR, A_RESET, A_PLAIN_CHORD };
+
+static const gesture_def_t chord_table[] = {
+    { .kind = GESTURE_PRESS,        .mask = 1u << BTN_UP,   .action = A_UP, .repeat = true },
+    { .kind = GESTURE_DOUBLE_CLICK, .mask = 1u << BTN_UP,   .action = A_UP_DOUBLE, .ms = 400 },
+    { .kind = GESTURE_PRESS,        .mask = 1u << BTN_DOWN, .action = A_DOWN, .repeat = true },
+    { .kind = GESTURE_CHORD, .mask = (1u << BTN_UP) | (1u << BTN_DOWN), .action = A_PAIR,
+      .ms = 3000, .max_ms = WINDOW_MS },
+    { .kind = GESTURE_CHORD, .mask = (1u << BTN_UP) | (1u << BTN_DOWN), .action = A_RESET,
+      .ms = 10000, .max_ms = WINDOW_MS },
+};
+
+static const gesture_def_t plain_chord_table[] = {
+    { .kind = GESTURE_PRESS, .mask = 1u << BTN_UP, .action = A_UP },
+    { .kind = GESTURE_CHORD, .mask = (1u << BTN_UP) | (1u << BTN_TOGGLE), .action = A_PLAIN_CHORD, .ms = 1000 },
+};
+
+static const gesture_repeat_stage_t stages[] = {
+    { .from_repeat = 0, .interval_ms = 300, .steps = 1 },
+};
+
+static gesture_engine_t engine;
+static gesture_output_t events[MAX_EVENTS];
+static int event_count;
+
+static void record(const gesture_output_t *output, void *arg) {
+    if (event_count < MAX_EVENTS) {
+        events[event_count++] = *output;
+    }
+}
+
+static void use_table(const gesture_def_t *defs, int count) {
+    event_count = 0;
+    gesture_init(&engine, defs, count, stages, 1, 500, record, NULL);
+}
+
+void setUp(void) {
+    use_table(chord_table, sizeof(chord_table) / sizeof(chord_table[0]));
+}
+
+void tearDown(void) {}
+
+static void run_until(int64_t ms) {
+    int64_t deadline;
+    while ((deadline = gesture_next_deadline(&engine)) <= ms * 1000) {
+        gesture_tick(&engine, deadline);
+    }
+}
+
+static void button_at(int button, bool pressed, int64_t ms) {
+    run_until(ms);
+    gesture_button(&engine, button, pressed, ms * 1000);
+}
+
+// Occurrences of an action, leaving out repeats
+static int count_action(int action) {
+    int count = 0;
+    for (int i = 0; i < event_count; i++) {
+        count += events[i].action == action && events[i].repeat == 0;
+    }
+    return count;
+}
+
+static void test_member_press_waits_out_window(void) {
+    button_at(BTN_UP, true, 0);
+    run_until(WINDOW_MS - 1);
+    TEST_ASSERT_EQUAL(0, event_count);
+    run_until(WINDOW_MS);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(A_UP, events[0].action);
+    TEST_ASSERT_EQUAL_INT64(WINDOW_MS * 1000, events[0].time_us);
+}
+
+// The reported bug: starting the chord must not step the fan first
+static void test_chord_swallows_member_presses(void) {
+    button_at(BTN_DOWN, true, 0);
+    button_at(BTN_UP, true, WINDOW_MS / 2);
+    run_until(2999 + WINDOW_MS / 2);
+    TEST_ASSERT_EQUAL(0, event_count);
+    run_until(3000 + WINDOW_MS / 2);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(A_PAIR, events[0].action);
+    button_at(BTN_UP, false, 11000);
+    button_at(BTN_DOWN, false, 11000);
+    run_until(20000);
+    TEST_ASSERT_EQUAL(2, event_count);
+    TEST_ASSERT_EQUAL(A_RESET, events[1].action);
+}
+
+static void test_chord_released_early_does_nothing(void) {
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_DOWN, true, 10);
+    button_at(BTN_UP, false, 1000);
+    button_at(BTN_DOWN, false, 1000);
+    run_until(20000);
+    TEST_ASSERT_EQUAL(0, event_count);
+}
+
+static void test_tap_inside_window_still_presses(void) {
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_UP, false, WINDOW_MS / 3);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(A_UP, events[0].action);
+    run_until(5000);
+    TEST_ASSERT_EQUAL(1, event_count);
+}
+
+static void test_late_partner_is_not_a_chord(void) {
+    button_at(BTN_DOWN, true, 0);
+    button_at(BTN_UP, true, WINDOW_MS + 50);
+    button_at(BTN_UP, false, 4000);
+    button_at(BTN_DOWN, false, 4000);
+    TEST_ASSERT_EQUAL(0, count_action(A_PAIR));
+    TEST_ASSERT_EQUAL(1, count_action(A_UP));
+    TEST_ASSERT_EQUAL(A_DOWN, events[0].action);
+}
+
+static void test_double_click_through_window(void) {
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_UP, false, 60);
+    button_at(BTN_UP, true, 300);
+    button_at(BTN_UP, false, 360);
+    TEST_ASSERT_EQUAL(2, count_action(A_UP));
+    TEST_ASSERT_EQUAL(1, count_action(A_UP_DOUBLE));
+}
+
+// Repeats keep their timing from the physical press, not the window
+static void test_repeat_counts_from_press(void) {
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_UP, false, 850);
+    TEST_ASSERT_EQUAL(3, event_count);
+    TEST_ASSERT_EQUAL_INT64(500 * 1000, events[1].time_us);
+    TEST_ASSERT_EQUAL_INT64(800 * 1000, events[2].time_us);
+}
+
+static void test_cancel_drops_held_back_press(void) {
+    button_at(BTN_UP, true, 0);
+    gesture_cancel(&engine, BTN_UP, 10 * 1000);
+    run_until(5000);
+    TEST_ASSERT_EQUAL(0, event_count);
+}
+
+// A chord without a window keeps the old behaviour: presses are immediate
+static void test_windowless_chord(void) {
+    use_table(plain_chord_table, sizeof(plain_chord_table) / sizeof(plain_chord_table[0]));
+    button_at(BTN_UP, true, 0);
+    TEST_ASSERT_EQUAL(1, event_count);
+    button_at(BTN_TOGGLE, true, 2000);
+    run_until(2999);
+    TEST_ASSERT_EQUAL(1, event_count);
+    run_until(3000);
+    TEST_ASSERT_EQUAL(2, event_count);
+    TEST_ASSERT_EQUAL(A_PLAIN_CHORD, events[1].action);
+}
+
+static void init_firmware_table(void) {
+    event_count = 0;
+    gesture_init(&engine, button_gestures, button_gesture_count, button_repeat_stages,
+                 button_repeat_stage_count, BUTTONS_REPEAT_DELAY_MS, record, NULL);
+}
+
+// Gen-2 has a MODE button, so UP+DOWN does nothing special and UP is immediate
+static void test_gen2_table_has_no_up_down_chord(void) {
+    init_firmware_table();
+    button_at(BTN_UP, true, 0);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(BUTTON_EVENT_UP_PRESS, events[0].action);
+    button_at(BTN_DOWN, true, 10);
+    button_at(BTN_UP, false, 12000);
+    button_at(BTN_DOWN, false, 12000);
+    TEST_ASSERT_EQUAL(0, count_action(BUTTON_EVENT_MODE_PRESS));
+    TEST_ASSERT_EQUAL(0, count_action(BUTTON_EVENT_FACTORY_RESET));
+}
+
+// The lock chord toggles the lock and nothing else, whichever button leads
+static void test_lock_chord_does_not_touch_fan(void) {
+    static const int leads[] = { BTN_TOGGLE, BTN_DOWN };
+    for (int i = 0; i < 2; i++) {
+        int lead = leads[i];
+        int other = lead == BTN_TOGGLE ? BTN_DOWN : BTN_TOGGLE;
+        init_firmware_table();
+        button_at(lead, true, 0);
+        button_at(other, true, BUTTONS_CHORD_WINDOW_MS - 20);
+        button_at(lead, false, BUTTONS_LOCK_CHORD_MS + 1000);
+        button_at(other, false, BUTTONS_LOCK_CHORD_MS + 1000);
+        run_until(BUTTONS_LOCK_CHORD_MS + 5000);
+        TEST_ASSERT_EQUAL(1, event_count);
+        TEST_ASSERT_EQUAL(BUTTON_EVENT_PANEL_LOCK, events[0].action);
+    }
+}
+
+static void test_down_alone_still_lowers_fan(void) {
+    init_firmware_table();
+    button_at(BTN_DOWN, true, 0);
+    button_at(BTN_DOWN, false, 200);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(BUTTON_EVENT_DOWN_PRESS, events[0].action);
+    TEST_ASSERT_EQUAL_INT64(BUTTONS_CHORD_WINDOW_MS * 1000, events[0].time_us);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_member_press_waits_out_window);
+    RUN_TEST(test_chord_swallows_member_presses);
+    RUN_TEST(test_chord_released_early_does_nothing);
+    RUN_TEST(test_tap_inside_window_still_presses);
+    RUN_TEST(test_late_partner_is_not_a_chord);
+    RUN_TEST(test_double_click_through_window);
+    RUN_TEST(test_repeat_counts_from_press);
+    RUN_TEST(test_cancel_drops_held_back_press);
+    RUN_TEST(test_windowless_chord);
+    RUN_TEST(test_gen2_table_has_no_up_down_chord);
+    RUN_TEST(test_lock_chord_does_not_touch_fan);
+    RUN_TEST(test_down_alone_still_lowers_fan);
+    return UNITY_END();
+}
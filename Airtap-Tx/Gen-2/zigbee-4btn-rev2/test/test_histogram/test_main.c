@@ -0,0 +1,102 @@
+#include <string.h>
+#include <unity.h>
+#include "histogram.h"
+
+static const uint32_t bounds[] = { 100, 500, 1000, 5000 };
+static histogram_t hist;
+
+void setUp(void) {
+    histogram_init(&hist, "lat", bounds, sizeof(bounds) / sizeof(bounds[0]));
+}
+
+void tearDown(void) {}
+
+static void test_buckets_use_exclusive_upper_bounds(void) {
+    histogram_record(&hist, 0);
+    histogram_record(&hist, 99);
+    histogram_record(&hist, 100);   // First value of the second bucket
+    histogram_record(&hist, 999);
+    histogram_record(&hist, 5000);  // Overflow
+    TEST_ASSERT_EQUAL_UINT32(2, hist.counts[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, hist.counts[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, hist.counts[2]);
+    TEST_ASSERT_EQUAL_UINT32(0, hist.counts[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, hist.counts[4]);
+    TEST_ASSERT_EQUAL_UINT32(5, hist.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, hist.min);
+    TEST_ASSERT_EQUAL_UINT32(5000, hist.max);
+}
+
+static void test_percentile_reports_bucket_bound(void) {
+    for (int i = 0; i < 90; i++) histogram_record(&hist, 50);
+    for (int i = 0; i < 10; i++) histogram_record(&hist, 700);
+    TEST_ASSERT_EQUAL_UINT32(100, histogram_percentile(&hist, 50));
+    TEST_ASSERT_EQUAL_UINT32(100, histogram_percentile(&hist, 90));
+    TEST_ASSERT_EQUAL_UINT32(700, histogram_percentile(&hist, 91));  // Capped at the maximum
+    TEST_ASSERT_EQUAL_UINT32(700, histogram_percentile(&hist, 100));
+    TEST_ASSERT_EQUAL_UINT32(700, histogram_percentile(&hist, 150));
+}
+
+static void test_percentile_in_overflow_reports_max(void) {
+    histogram_record(&hist, 10);
+    histogram_record(&hist, 123456);
+    TEST_ASSERT_EQUAL_UINT32(123456, histogram_percentile(&hist, 99));
+}
+
+static void test_empty_histogram(void) {
+    char buf[64];
+    TEST_ASSERT_EQUAL_UINT32(0, histogram_percentile(&hist, 90));
+    histogram_format(&hist, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("lat n=0", buf);
+}
+
+static void test_format_summary(void) {
+    char buf[96];
+    histogram_record(&hist, 50);
+    histogram_record(&hist, 150);
+    histogram_record(&hist, 6000);
+    int len = histogram_format(&hist, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("lat n=3 avg=2066 min=50 max=6000 p90<6000 [1 1 0 0|1]", buf);
+    TEST_ASSERT_EQUAL((int)strlen(buf), len);
+}
+
+static void test_format_truncates_safely(void) {
+    char buf[16];
+    memset(buf, 'x', sizeof(buf));
+    histogram_record(&hist, 50);
+    histogram_format(&hist, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(sizeof(buf) - 1, strlen(buf));
+}
+
+static void test_reset_clears_samples(void) {
+    histogram_record(&hist, 50);
+    histogram_record(&hist, 6000);
+    histogram_reset(&hist);
+    TEST_ASSERT_EQUAL_UINT32(0, hist.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, hist.counts[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, hist.counts[4]);
+    histogram_record(&hist, 7);
+    TEST_ASSERT_EQUAL_UINT32(7, hist.min);
+    TEST_ASSERT_EQUAL_UINT32(7, hist.max);
+}
+
+static void test_init_clamps_bucket_count(void) {
+    static const uint32_t many[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    histogram_init(&hist, "many", many, sizeof(many) / sizeof(many[0]));
+    TEST_ASSERT_EQUAL(HISTOGRAM_MAX_BUCKETS, hist.num_bounds);
+    histogram_record(&hist, 100);
+    TEST_ASSERT_EQUAL_UINT32(1, hist.counts[HISTOGRAM_MAX_BUCKETS]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_buckets_use_exclusive_upper_bounds);
+    RUN_TEST(test_percentile_reports_bucket_bound);
+    RUN_TEST(test_percentile_in_overflow_reports_max);
+    RUN_TEST(test_empty_histogram);
+    RUN_TEST(test_format_summary);
+    RUN_TEST(test_format_truncates_safely);
+    RUN_TEST(test_reset_clears_samples);
+    RUN_TEST(test_init_clamps_bucket_count);
+    return UNITY_END();
+}
@@ -0,0 +1,102 @@
+#include <unity.h>
+#include "button_table.h"
+
+// Hold-to-repeat on the firmware's own gesture table and acceleration
+// stages, driven the way buttons.c drives it: gesture_tick() exactly at
+// gesture_next_deadline(). Times are in milliseconds.
+#define MAX_EVENTS 64
+
+static gesture_engine_t engine;
+static gesture_output_t events[MAX_EVENTS];
+static int event_count;
+
+static void record(const gesture_output_t *output, void *arg) {
+    if (event_count < MAX_EVENTS) {
+        events[event_count++] = *output;
+    }
+}
+
+void setUp(void) {
+    event_count = 0;
+    gesture_init(&engine, button_gestures, button_gesture_count, button_repeat_stages,
+                 button_repeat_stage_count, BUTTONS_REPEAT_DELAY_MS, record, NULL);
+}
+
+void tearDown(void) {}
+
+static void run_until(int64_t ms) {
+    int64_t deadline;
+    while ((deadline = gesture_next_deadline(&engine)) <= ms * 1000) {
+        gesture_tick(&engine, deadline);
+    }
+}
+
+static void button_at(int button, bool pressed, int64_t ms) {
+    run_until(ms);
+    gesture_button(&engine, button, pressed, ms * 1000);
+}
+
+static void test_repeat_delay_and_acceleration(void) {
+    // Delay, then three stages: 300 ms from the first repeat, 200 ms from
+    // the third, 120 ms from the sixth
+    static const int64_t expected_ms[] = { 0, 500, 800, 1100, 1300, 1500, 1700, 1820, 1940, 2060 };
+    const int count = sizeof(expected_ms) / sizeof(expected_ms[0]);
+
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_UP, false, 2100);
+    TEST_ASSERT_EQUAL(count, event_count);
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL(BUTTON_EVENT_UP_PRESS, events[i].action);
+        TEST_ASSERT_EQUAL(i, events[i].repeat);
+        TEST_ASSERT_EQUAL(1, events[i].steps);
+        TEST_ASSERT_EQUAL_INT64(expected_ms[i] * 1000, events[i].time_us);
+    }
+}
+
+static void test_release_before_delay_does_not_repeat(void) {
+    button_at(BTN_DOWN, true, 0);
+    button_at(BTN_DOWN, false, BUTTONS_REPEAT_DELAY_MS - 1);
+    run_until(5000);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(BUTTON_EVENT_DOWN_PRESS, events[0].action);
+    TEST_ASSERT_EQUAL(GESTURE_NO_DEADLINE, gesture_next_deadline(&engine));
+}
+
+static void test_release_stops_repeating(void) {
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_UP, false, 900);
+    int seen = event_count;
+    run_until(5000);
+    TEST_ASSERT_EQUAL(seen, event_count);
+    TEST_ASSERT_EQUAL(3, seen);     // Press, then repeats at 500 and 800
+}
+
+// A press that repeated is not the first click of a double-click
+static void test_repeated_press_is_not_a_click(void) {
+    button_at(BTN_UP, true, 0);
+    button_at(BTN_UP, false, 600);
+    button_at(BTN_UP, true, 700);
+    button_at(BTN_UP, false, 750);
+    for (int i = 0; i < event_count; i++) {
+        TEST_ASSERT_NOT_EQUAL(BUTTON_EVENT_SPEED_MAX, events[i].action);
+    }
+}
+
+static void test_toggle_does_not_repeat(void) {
+    button_at(BTN_TOGGLE, true, 0);
+    run_until(3000);
+    TEST_ASSERT_EQUAL(0, event_count);
+    button_at(BTN_TOGGLE, false, 3000);
+    TEST_ASSERT_EQUAL(1, event_count);
+    TEST_ASSERT_EQUAL(BUTTON_EVENT_TOGGLE_PRESS, events[0].action);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_repeat_delay_and_acceleration);
+    RUN_TEST(test_release_before_delay_does_not_repeat);
+    RUN_TEST(test_release_stops_repeating);
+    RUN_TEST(test_repeated_press_is_not_a_click);
+    RUN_TEST(test_toggle_does_not_repeat);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "sim.h"
+#include "board.h"
+#include "boot_timing.h"
+#include "device_state.h"
+#include "fan_control.h"
+
+// Power-on to first PWM edge on the fan pin, with a speed saved in NVS by
+// the previous run. Time zero is app_main(); the ROM and second-stage
+// bootloader that precede it on the device are not simulated.
+
+#define SAVED_SPEED     600
+#define PHASE_MAX       8
+
+typedef struct {
+    char name[16];
+    int64_t time_us;
+} phase_t;
+
+static phase_t phases[PHASE_MAX];
+static int num_phases;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Collect the boot_timing breakdown as the firmware logs it
+static void log_hook(esp_log_level_t level, const char *line) {
+    const char *entry = strstr(line, "BOOT: ");
+    if (!entry || num_phases == PHASE_MAX) return;
+    phase_t *phase = &phases[num_phases];
+    long long time_us;
+    if (sscanf(entry, "BOOT: %15s at %lld us", phase->name, &time_us) == 2) {
+        phase->time_us = time_us;
+        num_phases++;
+    }
+}
+
+static int64_t phase_us(const char *name) {
+    for (int i = 0; i < num_phases; i++) {
+        if (strcmp(phases[i].name, name) == 0) return phases[i].time_us;
+    }
+    return -1;
+}
+
+static void test_fan_restored_before_display_and_zigbee(void) {
+    int64_t edge = sim_pwm_first_edge_us(BOARD_PIN_FAN_PWM);
+    int64_t oled = phase_us("oled");
+    int64_t zigbee = phase_us("zigbee_start");
+    char line[160];
+    snprintf(line, sizeof(line), "power-on to first PWM edge: %lld us (OLED ready at %lld us, Zigbee started at %lld us)",
+             (long long)edge, (long long)oled, (long long)zigbee);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL(SAVED_SPEED, device_state_get().fan_speed);
+    TEST_ASSERT_EQUAL_UINT32((SAVED_SPEED * FAN_PWM_DUTY_MAX + FAN_SPEED_MAX / 2) / FAN_SPEED_MAX, sim_pwm_duty(BOARD_PIN_FAN_PWM));
+    TEST_ASSERT_TRUE(edge >= 0);
+    TEST_ASSERT_LESS_THAN(BOOT_TIMING_FAN_TARGET_US, edge);
+    TEST_ASSERT_TRUE(oled > 0 && zigbee > 0);
+    TEST_ASSERT_LESS_THAN(oled, edge);
+    TEST_ASSERT_LESS_THAN(zigbee, edge);
+}
+
+// Restoring the speed reads NVS but must not write it back
+static void test_restore_writes_nothing(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, sim_nvs_writes());
+}
+
+int main(void) {
+    sim_init(1);
+    sim_nvs_set_u16(FAN_NVS_NAMESPACE, FAN_NVS_KEY_SPEED, SAVED_SPEED);
+    sim_set_log_hook(log_hook);
+    sim_start();
+    sim_run_for((BOOT_TIMING_REPORT_DELAY_MS + 1000) * 1000LL);
+    UNITY_BEGIN();
+    RUN_TEST(test_fan_restored_before_display_and_zigbee);
+    RUN_TEST(test_restore_writes_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+#include "sim.h"
+#include "esp_zigbee_core.h"
+
+// The diagnostics build ([env:sim_diag]: profiler and trace on) on the
+// simulator. The Zigbee stack loop never returns, so its work must be
+// measured in the handlers it calls: the zb_iter histogram has to fill as
+// the device joins and the hub writes to it, and every trace slice they open
+// has to close. Console output is captured in a temporary file.
+
+#define SECOND_US   1000000LL
+#define LINE_MAX    160
+
+static uint32_t zb_iter_samples;
+static uint32_t zb_iter_dumps;
+static FILE *out;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void log_hook(esp_log_level_t level, const char *line) {
+    const char *hist = strstr(line, "zb_iter n=");
+    unsigned long n;
+    if (hist && sscanf(hist, "zb_iter n=%lu", &n) == 1) {
+        zb_iter_samples += n;
+        zb_iter_dumps++;
+    }
+}
+
+static void test_zb_iter_gets_samples(void) {
+    sim_run_for(60 * SECOND_US);
+    TEST_ASSERT_TRUE(sim_zb_joined());
+    uint32_t after_join = zb_iter_samples;
+    TEST_ASSERT_TRUE(zb_iter_dumps > 0);
+    TEST_ASSERT_TRUE(after_join > 0);
+
+    bool off = false;
+    TEST_ASSERT_TRUE(sim_zb_hub_write(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &off));
+    sim_run_for(60 * SECOND_US);
+    TEST_ASSERT_TRUE(zb_iter_samples > after_join);
+}
+
+// Types a console command and runs long enough for its output to drain,
+// with the firmware's stdout going to the capture file
+static void console_command(const char *command) {
+    fflush(stdout);
+    if (out) fclose(out);
+    out = tmpfile();
+    int console = dup(STDOUT_FILENO);
+    dup2(fileno(out), STDOUT_FILENO);
+    sim_console_input(command);
+    sim_run_for(30 * SECOND_US);
+    fflush(stdout);
+    dup2(console, STDOUT_FILENO);
+    close(console);
+}
+
+// Counts the handler slices in a dump; a slice left open would run to the
+// end of the capture in the Chrome view
+static void count_slices(const char *name, int *begins, int *ends) {
+    bool dumped = false;
+    char line[LINE_MAX];
+    rewind(out);
+    while (fgets(line, sizeof(line), out)) {
+        unsigned long time, type;
+        char ev_name[32];
+        dumped |= strncmp(line, "@end", 4) == 0;
+        if (sscanf(line, "@ev,%lu,%lu,%31s", &time, &type, ev_name) != 3) continue;
+        TEST_ASSERT_NULL(strstr(ev_name, "zb_iteration"));
+        if (strcmp(ev_name, name) != 0) continue;
+        *begins += type == 4;   // TRACE_EV_BEGIN
+        *ends += type == 5;     // TRACE_EV_END
+    }
+    TEST_ASSERT_TRUE(dumped);
+}
+
+static void test_trace_slices_close(void) {
+    // Boot and join: signals
+    console_command("trace\n");
+    int signal_begins = 0, signal_ends = 0;
+    count_slices("zb_signal", &signal_begins, &signal_ends);
+    TEST_ASSERT_TRUE(signal_begins > 0);
+    TEST_ASSERT_EQUAL(signal_begins, signal_ends);
+
+    // A hub write: an action
+    bool on = true;
+    TEST_ASSERT_TRUE(sim_zb_hub_write(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &on));
+    sim_run_for(60 * SECOND_US);
+    console_command("trace\n");
+    int action_begins = 0, action_ends = 0;
+    count_slices("zb_action", &action_begins, &action_ends);
+    TEST_ASSERT_TRUE(action_begins > 0);
+    TEST_ASSERT_EQUAL(action_begins, action_ends);
+}
+
+static void test_tracebench_reports_the_cost(void) {
+    console_command("tracebench\n");
+    int reports = 0;
+    char line[LINE_MAX];
+    rewind(out);
+    while (fgets(line, sizeof(line), out)) {
+        unsigned long cycles, ns, mhz;
+        reports += sscanf(line, "trace_record: %lu cycles, %lu ns per event at %lu MHz", &cycles, &ns, &mhz) == 3;
+    }
+    TEST_ASSERT_TRUE(reports > 0);
+}
+
+int main(void) {
+    sim_init(1);
+    sim_set_log_hook(log_hook);
+    sim_start();
+    UNITY_BEGIN();
+    RUN_TEST(test_zb_iter_gets_samples);
+    RUN_TEST(test_trace_slices_close);
+    RUN_TEST(test_tracebench_reports_the_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+#include "sim.h"
+#include "board.h"
+
+// The I2C stall measurement mode ([env:sim_i2c_stall]) on the simulator:
+// every OLED update holds the main task for CONFIG_AIRTAP_I2C_STALL_MS, and
+// every press changes the fan speed and so asks for another update. A burst
+// of presses therefore lands while the main loop is stalled. The "buttons"
+// console command must then report no lost edges or events, and the main
+// loop must have acted on every press in the order they were made.
+
+#define MS_US           1000LL
+#define SECOND_US       1000000LL
+#define PRESSES         30
+#define PRESS_GAP_US    (160 * MS_US)
+#define PRESS_HOLD_US   (40 * MS_US)    // Release to the same button's next press: 440 ms, past a double-click
+#define BOUNCE_US       (5 * MS_US)
+#define LINE_MAX        160
+
+static const int pins[] = { BOARD_PIN_BTN_UP, BOARD_PIN_BTN_DOWN, BOARD_PIN_BTN_TOGGLE };
+static const char marks[] = { 'U', 'D', 'T' };
+
+static char handled[PRESSES * 2 + 1];
+static size_t handled_count;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// The main loop logs each button event it acts on; double-clicks would show
+// up as M (full speed) or O (off)
+static void log_hook(esp_log_level_t level, const char *line) {
+    char mark = 0;
+    if (strstr(line, "Fan speed increased")) mark = 'U';
+    if (strstr(line, "Fan speed decreased")) mark = 'D';
+    if (strstr(line, "Fan toggled")) mark = 'T';
+    if (strstr(line, "Fan set to full speed")) mark = 'M';
+    if (strstr(line, "Fan turned off")) mark = 'O';
+    if (mark && handled_count < sizeof(handled) - 1) handled[handled_count++] = mark;
+}
+
+static void test_presses_during_stalled_pushes_are_not_lost(void) {
+    sim_run_for(30 * SECOND_US);
+    handled_count = 0;
+
+    char expected[PRESSES + 1] = { 0 };
+    int64_t start = sim_now_us() + 10 * MS_US;
+    for (int i = 0; i < PRESSES; i++) {
+        sim_button_press(pins[i % 3], !BOARD_BUTTONS_ACTIVE_LOW, start + i * PRESS_GAP_US, PRESS_HOLD_US, BOUNCE_US);
+        expected[i] = marks[i % 3];
+    }
+
+    sim_stats_t before, after;
+    sim_get_stats(&before);
+    sim_run_until(start + PRESSES * PRESS_GAP_US);
+    sim_get_stats(&after);
+    sim_run_for(5 * SECOND_US);
+
+    // The stalled pushes held the CPU for most of the burst
+    TEST_ASSERT_TRUE(2 * (after.busy_us - before.busy_us) >= PRESSES * PRESS_GAP_US);
+    TEST_ASSERT_EQUAL_STRING(expected, handled);
+}
+
+static void test_buttons_command_reports_nothing_lost(void) {
+    FILE *out = tmpfile();
+    fflush(stdout);
+    int console = dup(STDOUT_FILENO);
+    dup2(fileno(out), STDOUT_FILENO);
+    sim_console_input("buttons\n");
+    sim_run_for(SECOND_US);
+    fflush(stdout);
+    dup2(console, STDOUT_FILENO);
+    close(console);
+
+    unsigned long edges = 0, overflows = 1, changes = 0, glitches = 0;
+    unsigned long events = 0, dropped = 1, consumed = 0, waiting = 0, stuck = 0, blocked = 0;
+    bool none_lost = false;
+    char line[LINE_MAX];
+    rewind(out);
+    while (fgets(line, sizeof(line), out)) {
+        sscanf(line, "edges=%lu overflows=%lu changes=%lu glitches=%lu", &edges, &overflows, &changes, &glitches);
+        sscanf(line, "events=%lu dropped=%lu consumed=%lu waiting=%lu stuck=%lu blocked=%lu", &events, &dropped,
+               &consumed, &waiting, &stuck, &blocked);
+        none_lost |= strcmp(line, "no events lost\n") == 0;
+    }
+    fclose(out);
+
+    TEST_ASSERT_EQUAL(0, overflows);
+    TEST_ASSERT_EQUAL(0, dropped);
+    TEST_ASSERT_EQUAL(edges, changes + glitches);
+    TEST_ASSERT_EQUAL(2 * PRESSES, changes);
+    TEST_ASSERT_EQUAL(PRESSES, events);
+    TEST_ASSERT_EQUAL(events, consumed);
+    TEST_ASSERT_TRUE(none_lost);
+}
+
+int main(void) {
+    sim_init(1);
+    sim_set_log_hook(log_hook);
+    sim_start();
+    UNITY_BEGIN();
+    RUN_TEST(test_presses_during_stalled_pushes_are_not_lost);
+    RUN_TEST(test_buttons_command_reports_nothing_lost);
+    return UNITY_END();
+}
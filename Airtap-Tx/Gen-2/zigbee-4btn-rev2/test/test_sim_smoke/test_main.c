@@ -0,0 +1,59 @@
+#include <unity.h>
+#include "sim.h"
+#include "board.h"
+#include "device_state.h"
+#include "fan_control.h"
+#include "esp_zigbee_core.h"
+
+// Boots the whole firmware on the simulator and runs it for a day of
+// device time: it must join, stay responsive to the buttons and the hub,
+// and idle in light sleep.
+
+#define DAY_US  (24LL * 3600 * 1000000)
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void test_boots_and_joins(void) {
+    sim_run_for(30LL * 1000000);
+    TEST_ASSERT_TRUE(sim_zb_joined());
+    TEST_ASSERT_EQUAL(1, sim_zb_steering_attempts());
+}
+
+static void test_button_changes_speed(void) {
+    int before = device_state_get().fan_speed;
+    int64_t now = sim_now_us();
+    sim_button_press(BOARD_PIN_BTN_UP, !BOARD_BUTTONS_ACTIVE_LOW, now + 1000, 100000, 5000);
+    sim_run_for(1000000);
+    TEST_ASSERT_TRUE(device_state_get().fan_speed > before);
+    TEST_ASSERT_TRUE(sim_pwm_duty(BOARD_PIN_FAN_PWM) > 0);
+}
+
+static void test_hub_write_reaches_the_fan(void) {
+    bool off = false;
+    TEST_ASSERT_TRUE(sim_zb_hub_write(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &off));
+    sim_run_for(5000000);   // Delivered at the next parent poll
+    TEST_ASSERT_EQUAL(0, device_state_get().fan_speed);
+    TEST_ASSERT_EQUAL(0, sim_pwm_duty(BOARD_PIN_FAN_PWM));
+}
+
+static void test_idles_in_light_sleep_for_a_day(void) {
+    sim_stats_t before, after;
+    sim_get_stats(&before);
+    sim_run_for(DAY_US);
+    sim_get_stats(&after);
+    TEST_ASSERT_TRUE(sim_zb_joined());
+    TEST_ASSERT_TRUE(after.sleep_us - before.sleep_us > DAY_US * 9 / 10);
+}
+
+int main(void) {
+    sim_init(1);
+    sim_start();
+    UNITY_BEGIN();
+    RUN_TEST(test_boots_and_joins);
+    RUN_TEST(test_button_changes_speed);
+    RUN_TEST(test_hub_write_reaches_the_fan);
+    RUN_TEST(test_idles_in_light_sleep_for_a_day);
+    return UNITY_END();
+}
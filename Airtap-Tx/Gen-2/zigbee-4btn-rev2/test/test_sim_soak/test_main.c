@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <unity.h>
+#include "sim.h"
+#include "esp_zigbee_core.h"
+
+// Runs the soak-test image (CONFIG_AIRTAP_SOAK, see [env:sim_soak]) for four
+// weeks of device time. On top of the firmware's own random stimuli the
+// network goes away for hours at a time, steering fails at random and the
+// hub writes the fan level and on/off state. The soak's CSV rows go to a
+// temporary file and are checked afterwards: no metric may trend, and the
+// heap must be where it was after the first day.
+
+#define HOUR_US     (3600LL * 1000000)
+#define DAY_US      (24 * HOUR_US)
+#define SOAK_DAYS   28
+#define CSV_LINE    256
+
+typedef struct {
+    uint32_t rows;
+    uint32_t heap_free_first;
+    uint32_t heap_free_last;
+    uint32_t jobs_min;
+    uint32_t jobs_max;
+    uint32_t stimuli;
+    uint32_t zb_faults;
+    int failures;
+} soak_csv_t;
+
+static FILE *csv;
+static uint32_t soak_fail_lines;
+static uint32_t joins;
+static uint32_t outages;
+static uint32_t hub_writes;
+static uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void log_hook(esp_log_level_t level, const char *line) {
+    if (strstr(line, "SOAK FAIL")) soak_fail_lines++;
+    if (strstr(line, "Joined network successfully")) joins++;
+}
+
+// The test's own random stream, so the environment does not depend on how
+// often the firmware draws from esp_random()
+static uint32_t env_random(void) {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// One stretch of up to two hours under a random network condition, with a
+// hub write at its start when the device is joined
+static void run_stretch(void) {
+    uint32_t r = env_random();
+    bool network = r % 4 != 0;
+    outages += !network;
+    sim_zb_set_network(network);
+    sim_zb_set_steering_fail_permille((r >> 2) % 500);
+    if ((r >> 12) % 2) {
+        uint8_t level = (uint8_t)((r >> 13) % 255);
+        hub_writes += sim_zb_hub_write(ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
+                                       ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, &level);
+    } else {
+        bool on = (r >> 13) % 2;
+        hub_writes += sim_zb_hub_write(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &on);
+    }
+    sim_run_for(60LL * 1000000 + (int64_t)(env_random() % 7200) * 1000000);
+}
+
+// The firmware's stdout goes to the CSV file while the device runs
+static int console_to_csv(void) {
+    fflush(stdout);
+    int console = dup(STDOUT_FILENO);
+    dup2(fileno(csv), STDOUT_FILENO);
+    return console;
+}
+
+static void console_restore(int console) {
+    fflush(stdout);
+    dup2(console, STDOUT_FILENO);
+    close(console);
+}
+
+static soak_csv_t read_csv(void) {
+    soak_csv_t s = { .jobs_min = UINT32_MAX };
+    char line[CSV_LINE];
+    rewind(csv);
+    while (fgets(line, sizeof(line), csv)) {
+        unsigned long uptime, heap_free, heap_min, block, jobs, tasks, stack, stimuli, faults;
+        char task[24];
+        int failures;
+        if (sscanf(line, "@soak,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%23[^,],%lu,%lu,%d", &uptime, &heap_free, &heap_min,
+                   &block, &jobs, &tasks, &stack, task, &stimuli, &faults, &failures) != 11) {
+            continue;
+        }
+        if (uptime <= DAY_US / 1000000) s.heap_free_first = heap_free;
+        s.heap_free_last = heap_free;
+        if (jobs < s.jobs_min) s.jobs_min = jobs;
+        if (jobs > s.jobs_max) s.jobs_max = jobs;
+        s.stimuli = stimuli;
+        s.zb_faults = faults;
+        s.failures = failures;
+        s.rows++;
+    }
+    return s;
+}
+
+static void test_soaks_for_weeks_without_leaks(void) {
+    int console = console_to_csv();
+    while (sim_now_us() < SOAK_DAYS * DAY_US) {
+        run_stretch();
+    }
+    console_restore(console);
+    soak_csv_t s = read_csv();
+
+    char line[160];
+    snprintf(line, sizeof(line), "%d days: %lu samples, %lu stimuli, %lu hub writes, %lu outages, %lu steering attempts, "
+             "%lu injected failures", SOAK_DAYS, (unsigned long)s.rows, (unsigned long)s.stimuli,
+             (unsigned long)hub_writes, (unsigned long)outages, (unsigned long)sim_zb_steering_attempts(),
+             (unsigned long)s.zb_faults);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(0, soak_fail_lines);
+    TEST_ASSERT_EQUAL(0, s.failures);
+    TEST_ASSERT_INT_WITHIN(2, sim_now_us() / (CONFIG_AIRTAP_SOAK_SAMPLE_MS * 1000LL), s.rows);
+    TEST_ASSERT_EQUAL_UINT32(s.heap_free_first, s.heap_free_last);
+    TEST_ASSERT_TRUE(s.jobs_max - s.jobs_min <= 2);
+    TEST_ASSERT_TRUE(s.stimuli > 0);
+    TEST_ASSERT_TRUE(s.zb_faults > 0);
+    TEST_ASSERT_TRUE(outages > 0);
+    TEST_ASSERT_TRUE(hub_writes > 0);
+}
+
+// The soak's own faults still apply, so the firmware's joined flag may be
+// down at any given moment; what matters is that pairing keeps succeeding
+static void test_joins_once_the_network_is_back(void) {
+    sim_zb_set_network(true);
+    sim_zb_set_steering_fail_permille(0);
+    uint32_t before = joins;
+    int console = console_to_csv();
+    sim_run_for(6 * HOUR_US);
+    console_restore(console);
+    TEST_ASSERT_TRUE(sim_zb_joined());
+    TEST_ASSERT_TRUE(joins > before);
+}
+
+int main(void) {
+    csv = tmpfile();
+    sim_init(1);
+    sim_set_log_hook(log_hook);
+    sim_start();
+    UNITY_BEGIN();
+    RUN_TEST(test_soaks_for_weeks_without_leaks);
+    RUN_TEST(test_joins_once_the_network_is_back);
+    return UNITY_END();
+}
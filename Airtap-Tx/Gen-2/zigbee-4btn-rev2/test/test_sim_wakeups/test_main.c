@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <unity.h>
+#include "sim.h"
+#include "board.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Wakeups per idle hour of the event-driven main loop, and of the 10 ms
+// polling loop it replaced, on the whole firmware in the simulator. The
+// old loop is rebuilt here as a task of the same priority doing the same
+// polling, since the firmware no longer contains it.
+
+#define HOUR_US     (3600LL * 1000000)
+
+typedef struct {
+    uint64_t main_resumes;
+    uint64_t task_resumes;
+    uint64_t wakeups;
+    int64_t sleep_us;
+} hour_t;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static hour_t measure_hour(const char *task) {
+    sim_stats_t before, after;
+    uint64_t main_before = sim_task_resumes("main");
+    uint64_t task_before = task ? sim_task_resumes(task) : 0;
+    sim_get_stats(&before);
+    sim_run_for(HOUR_US);
+    sim_get_stats(&after);
+    return (hour_t){
+        .main_resumes = sim_task_resumes("main") - main_before,
+        .task_resumes = task ? sim_task_resumes(task) - task_before : 0,
+        .wakeups = after.wakeups - before.wakeups,
+        .sleep_us = after.sleep_us - before.sleep_us,
+    };
+}
+
+static void report(const char *name, uint64_t loop_resumes, const hour_t *h) {
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %llu main task wakeups/h, %llu chip wakeups/h, %.1f %% in light sleep", name,
+             (unsigned long long)loop_resumes, (unsigned long long)h->wakeups, 100.0 * h->sleep_us / HOUR_US);
+    TEST_MESSAGE(line);
+}
+
+// The loop before the event queue: poll the buttons, refresh the display
+// once a second, sleep 10 ms
+static void polling_loop(void *arg) {
+    static const int pins[] = { BOARD_PIN_BTN_MODE, BOARD_PIN_BTN_UP, BOARD_PIN_BTN_DOWN, BOARD_PIN_BTN_TOGGLE };
+    uint32_t last_update = 0;
+    volatile int levels = 0;
+    while (true) {
+        uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+        if (now - last_update >= 1000) {
+            last_update = now;
+        }
+        for (size_t i = 0; i < sizeof(pins) / sizeof(pins[0]); i++) {
+            if (pins[i] >= 0) levels += gpio_get_level(pins[i]);
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static hour_t event_hour;
+
+static void test_event_loop_idle_hour(void) {
+    event_hour = measure_hour(NULL);
+    report("event loop", event_hour.main_resumes, &event_hour);
+    // Periodic jobs only. The display refresh is two: the job, then the end
+    // of its I2C transfer.
+    TEST_ASSERT_LESS_THAN(3 * 3600, event_hour.main_resumes);
+    TEST_ASSERT_GREATER_THAN(HOUR_US * 9 / 10, event_hour.sleep_us);
+}
+
+static void test_polling_loop_idle_hour(void) {
+    xTaskCreate(polling_loop, "polling_loop", 3584, NULL, 1, NULL);
+    hour_t h = measure_hour("polling_loop");
+    report("10 ms polling", h.task_resumes, &h);
+    TEST_ASSERT_INT_WITHIN(100, 360000, (int)h.task_resumes);
+    // Each 10 ms gap is shorter than the idle time before light sleep
+    TEST_ASSERT_LESS_THAN(event_hour.sleep_us / 10, h.sleep_us);
+    TEST_ASSERT_GREATER_THAN(20 * event_hour.main_resumes, h.task_resumes);
+}
+
+int main(void) {
+    sim_init(1);
+    sim_zb_set_commissioned(true);
+    sim_start();
+    sim_run_for(60LL * 1000000);    // Boot, rejoin and first reports
+    UNITY_BEGIN();
+    RUN_TEST(test_event_loop_idle_hour);
+    RUN_TEST(test_polling_loop_idle_hour);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+#include "snapshot.h"
+
+static snapshot_store_t store;
+
+void setUp(void) {
+    snapshot_clear(&store);
+}
+
+void tearDown(void) {}
+
+static snapshot_data_t make_data(uint32_t n) {
+    snapshot_data_t data = {
+        .fan_speed = (int32_t)(n % 1001),
+        .flags = SNAPSHOT_FLAG_SPEED_PERMILLE,
+        .fan_runtime_s = n * 7,
+        .brownouts = n / 3,
+        .resets = n,
+    };
+    return data;
+}
+
+static bool data_equal(const snapshot_data_t *a, const snapshot_data_t *b) {
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+// Replay snapshot_write() against 'before' byte by byte in the order the
+// firmware stores them (crc invalidated, then the body, then the new crc)
+// and stop after 'cut' bytes, as if power failed there.
+static void torn_write(const snapshot_store_t *before, const snapshot_store_t *after,
+                       int slot, size_t cut, snapshot_store_t *out) {
+    *out = *before;
+    uint8_t *dst = (uint8_t *)&out->slots[slot];
+    const uint8_t *src = (const uint8_t *)&after->slots[slot];
+    size_t crc_at = offsetof(snapshot_slot_t, crc);
+    uint32_t invalid = ~before->slots[slot].crc;
+
+    size_t done = 0;
+    for (size_t i = 0; i < sizeof(uint32_t) && done < cut; i++, done++) {
+        dst[crc_at + i] = ((const uint8_t *)&invalid)[i];
+    }
+    for (size_t i = 0; i < crc_at && done < cut; i++, done++) {
+        dst[i] = src[i];
+    }
+    for (size_t i = 0; i < sizeof(uint32_t) && done < cut; i++, done++) {
+        dst[crc_at + i] = src[crc_at + i];
+    }
+}
+
+static int written_slot(const snapshot_store_t *before, const snapshot_store_t *after) {
+    return memcmp(&before->slots[0], &after->slots[0], sizeof(snapshot_slot_t)) != 0 ? 0 : 1;
+}
+
+static void test_empty_store_reads_nothing(void) {
+    snapshot_data_t data;
+    TEST_ASSERT_FALSE(snapshot_read(&store, &data));
+}
+
+static void test_read_returns_latest_write(void) {
+    snapshot_data_t data;
+    for (uint32_t n = 1; n <= 5; n++) {
+        snapshot_data_t written = make_data(n);
+        snapshot_write(&store, &written);
+        TEST_ASSERT_TRUE(snapshot_read(&store, &data));
+        TEST_ASSERT_TRUE(data_equal(&written, &data));
+    }
+}
+
+// Cut power at every byte of a write: the reader sees the old or the new
+// record in full, never a mix and never nothing. The new one can only show
+// once its body is complete.
+static void test_power_cut_at_every_byte(void) {
+    snapshot_data_t old_data = make_data(41);
+    snapshot_data_t new_data = make_data(42);
+    snapshot_data_t first = make_data(40);
+    snapshot_write(&store, &first);
+    snapshot_write(&store, &old_data);
+
+    snapshot_store_t after = store;
+    snapshot_write(&after, &new_data);
+    int slot = written_slot(&store, &after);
+
+    size_t total = 2 * sizeof(uint32_t) + offsetof(snapshot_slot_t, crc);
+    for (size_t cut = 0; cut <= total; cut++) {
+        snapshot_store_t torn;
+        snapshot_data_t data;
+        torn_write(&store, &after, slot, cut, &torn);
+        TEST_ASSERT_TRUE(snapshot_read(&torn, &data));
+        if (cut == total) {
+            TEST_ASSERT_TRUE(data_equal(&new_data, &data));
+        } else if (cut <= total - sizeof(uint32_t)) {
+            TEST_ASSERT_TRUE_MESSAGE(data_equal(&old_data, &data), "torn write exposed new data");
+        } else {
+            // Mid-crc: new only if the unwritten crc bytes happen to match
+            TEST_ASSERT_TRUE(data_equal(&old_data, &data) || data_equal(&new_data, &data));
+        }
+    }
+}
+
+// Random cuts across a long run of writes, continuing from the torn store
+// as the firmware would after a brownout reset
+static void test_random_power_cuts(void) {
+    srand(3);
+    snapshot_data_t last = make_data(0);
+    snapshot_write(&store, &last);
+    size_t total = 2 * sizeof(uint32_t) + offsetof(snapshot_slot_t, crc);
+
+    for (uint32_t n = 1; n < 20000; n++) {
+        snapshot_data_t next = make_data(n);
+        snapshot_store_t after = store;
+        snapshot_write(&after, &next);
+
+        size_t cut = (size_t)rand() % (total + 1);
+        torn_write(&store, &after, written_slot(&store, &after), cut, &store);
+
+        snapshot_data_t data;
+        TEST_ASSERT_TRUE(snapshot_read(&store, &data));
+        if (cut == total) {
+            TEST_ASSERT_TRUE(data_equal(&next, &data));
+        } else if (cut <= total - sizeof(uint32_t)) {
+            TEST_ASSERT_TRUE(data_equal(&last, &data));
+        } else {
+            TEST_ASSERT_TRUE(data_equal(&last, &data) || data_equal(&next, &data));
+        }
+        last = data;
+    }
+}
+
+static void test_corrupt_slot_falls_back(void) {
+    snapshot_data_t old_data = make_data(1);
+    snapshot_data_t new_data = make_data(2);
+    snapshot_write(&store, &old_data);
+    snapshot_store_t before = store;
+    snapshot_write(&store, &new_data);
+
+    // Flip a bit in the newest slot, as RAM decay across a long outage might
+    int slot = written_slot(&before, &store);
+    store.slots[slot].data.fan_runtime_s ^= 1u << 9;
+    snapshot_data_t data;
+    TEST_ASSERT_TRUE(snapshot_read(&store, &data));
+    TEST_ASSERT_TRUE(data_equal(&old_data, &data));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_store_reads_nothing);
+    RUN_TEST(test_read_returns_latest_write);
+    RUN_TEST(test_power_cut_at_every_byte);
+    RUN_TEST(test_random_power_cuts);
+    RUN_TEST(test_corrupt_slot_falls_back);
+    return UNITY_END();
+}
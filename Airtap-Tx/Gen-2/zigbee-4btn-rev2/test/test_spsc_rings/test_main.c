@@ -0,0 +1,111 @@
+#include <pthread.h>
+#include <sched.h>
+#include <unity.h>
+#include "cmd_ring.h"
+#include "edge_ring.h"
+
+// Two real threads hammer each ring: the producer pushes a numbered sequence,
+// retrying when full, and the consumer checks every item arrives once, intact
+// and in order. A missing acquire/release shows up as a torn or stale slot.
+// Both sides yield when blocked so the test also finishes on one core.
+#define STRESS_ITEMS 500000
+
+static cmd_ring_t cmds;
+static edge_ring_t edges;
+
+void setUp(void) {
+    cmd_ring_init(&cmds);
+    edge_ring_init(&edges);
+}
+
+void tearDown(void) {}
+
+static void *cmd_producer(void *arg) {
+    for (int32_t i = 0; i < STRESS_ITEMS; i++) {
+        command_t cmd = { .type = (i & 1) ? CMD_PANEL_LOCK : CMD_SET_SPEED, .value = i };
+        while (!cmd_ring_push(&cmds, cmd)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *edge_producer(void *arg) {
+    for (int32_t i = 0; i < STRESS_ITEMS; i++) {
+        button_edge_t edge = { .time_us = (int64_t)i * 1000003, .button = (uint8_t)i, .level = (uint8_t)(i & 1) };
+        while (!edge_ring_push(&edges, &edge)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_cmd_ring_two_threads(void) {
+    pthread_t producer;
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, cmd_producer, NULL));
+
+    int32_t expected = 0;
+    while (expected < STRESS_ITEMS) {
+        command_t cmd;
+        if (!cmd_ring_pop(&cmds, &cmd)) {
+            sched_yield();
+            continue;
+        }
+        if (cmd.value != expected || cmd.type != ((expected & 1) ? CMD_PANEL_LOCK : CMD_SET_SPEED)) {
+            TEST_FAIL_MESSAGE("command out of order or torn");
+        }
+        expected++;
+    }
+    pthread_join(producer, NULL);
+
+    TEST_ASSERT_TRUE(cmd_ring_empty(&cmds));
+    // Every rejected push was retried, so the count only shows back-pressure
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, atomic_load(&cmds.head));
+}
+
+static void test_edge_ring_two_threads(void) {
+    pthread_t producer;
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, edge_producer, NULL));
+
+    int32_t expected = 0;
+    while (expected < STRESS_ITEMS) {
+        button_edge_t edge;
+        if (!edge_ring_pop(&edges, &edge)) {
+            sched_yield();
+            continue;
+        }
+        if (edge.time_us != (int64_t)expected * 1000003 || edge.button != (uint8_t)expected ||
+            edge.level != (uint8_t)(expected & 1)) {
+            TEST_FAIL_MESSAGE("edge out of order or torn");
+        }
+        expected++;
+    }
+    pthread_join(producer, NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, edge_ring_pushed(&edges));
+}
+
+static void test_full_ring_counts_drops(void) {
+    command_t cmd = { .type = CMD_SET_SPEED, .value = 1 };
+    for (int i = 0; i < CMD_RING_SIZE; i++) {
+        TEST_ASSERT_TRUE(cmd_ring_push(&cmds, cmd));
+    }
+    TEST_ASSERT_FALSE(cmd_ring_push(&cmds, cmd));
+    TEST_ASSERT_EQUAL_UINT32(1, atomic_load(&cmds.dropped));
+
+    button_edge_t edge = { 0 };
+    for (int i = 0; i < EDGE_RING_SIZE; i++) {
+        TEST_ASSERT_TRUE(edge_ring_push(&edges, &edge));
+    }
+    TEST_ASSERT_FALSE(edge_ring_push(&edges, &edge));
+    TEST_ASSERT_EQUAL_UINT32(1, edge_ring_overflows(&edges));
+    TEST_ASSERT_EQUAL_UINT32(EDGE_RING_SIZE, edge_ring_pushed(&edges));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cmd_ring_two_threads);
+    RUN_TEST(test_edge_ring_two_threads);
+    RUN_TEST(test_full_ring_counts_drops);
+    return UNITY_END();
+}
@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <unity.h>
+#include "temp_filter.h"
+
+// Shift and threshold as temperature.c uses them: 1/8 smoothing, values in
+// centi-degrees
+#define SHIFT       3
+#define THRESHOLD   10
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// The first sample seeds the filter and is reported as is
+static void test_first_sample_primes(void) {
+    temp_filter_t f;
+    temp_filter_init(&f, SHIFT, THRESHOLD);
+    TEST_ASSERT_TRUE(temp_filter_update(&f, 2150));
+    TEST_ASSERT_EQUAL(2150, temp_filter_value(&f));
+
+    temp_filter_init(&f, SHIFT, THRESHOLD);
+    TEST_ASSERT_TRUE(temp_filter_update(&f, -730));
+    TEST_ASSERT_EQUAL(-730, temp_filter_value(&f));
+}
+
+// The output is the nearest integer for negative values too; a plain shift
+// would floor -3.25 to -4
+static void test_rounds_to_nearest_both_signs(void) {
+    temp_filter_t f;
+    temp_filter_init(&f, 4, THRESHOLD);
+    f.acc = -52;                    // -3.25
+    TEST_ASSERT_EQUAL(-3, temp_filter_value(&f));
+    f.acc = -60;                    // -3.75
+    TEST_ASSERT_EQUAL(-4, temp_filter_value(&f));
+    f.acc = 52;
+    TEST_ASSERT_EQUAL(3, temp_filter_value(&f));
+    f.acc = 60;
+    TEST_ASSERT_EQUAL(4, temp_filter_value(&f));
+    for (int32_t acc = -4000; acc <= 4000; acc++) {
+        f.acc = acc;
+        TEST_ASSERT_TRUE(abs(temp_filter_value(&f) * 16 - acc) <= 8);
+    }
+}
+
+// A step settles exactly on the new input, without overshoot, both ways
+static void test_step_converges_to_input(void) {
+    static const int16_t steps[][2] = { { 2000, 2600 }, { 2600, -400 }, { -400, -401 } };
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        temp_filter_t f;
+        temp_filter_init(&f, SHIFT, THRESHOLD);
+        temp_filter_update(&f, steps[s][0]);
+        int16_t target = steps[s][1];
+        int16_t prev = temp_filter_value(&f);
+        int settled = -1;
+        for (int i = 0; i < 200; i++) {
+            temp_filter_update(&f, target);
+            int16_t value = temp_filter_value(&f);
+            // Moves towards the input and never past it
+            if (target > steps[s][0]) {
+                TEST_ASSERT_TRUE(value >= prev && value <= target);
+            } else {
+                TEST_ASSERT_TRUE(value <= prev && value >= target);
+            }
+            if (value == target && settled < 0) settled = i;
+            prev = value;
+        }
+        TEST_ASSERT_TRUE(settled >= 0);
+        TEST_ASSERT_EQUAL(target, temp_filter_value(&f));
+    }
+}
+
+// Without smoothing the threshold alone decides: a report once the value is
+// threshold away from the last report, in either direction
+static void test_reports_only_past_threshold(void) {
+    temp_filter_t f;
+    temp_filter_init(&f, 0, 5);
+    TEST_ASSERT_TRUE(temp_filter_update(&f, 250));
+    TEST_ASSERT_FALSE(temp_filter_update(&f, 254));
+    TEST_ASSERT_TRUE(temp_filter_update(&f, 255));
+    TEST_ASSERT_FALSE(temp_filter_update(&f, 251));
+    TEST_ASSERT_TRUE(temp_filter_update(&f, 250));
+    TEST_ASSERT_FALSE(temp_filter_update(&f, 246));
+}
+
+// Noise below the threshold is never reported, and a slow ramp reports once
+// per threshold of movement with the filtered value at that point
+static void test_ramp_reports_per_threshold(void) {
+    temp_filter_t f;
+    temp_filter_init(&f, SHIFT, THRESHOLD);
+    temp_filter_update(&f, 2000);
+    for (int i = 0; i < 500; i++) {
+        TEST_ASSERT_FALSE(temp_filter_update(&f, (int16_t)(2000 + (i % 2 ? 30 : -30))));
+    }
+
+    temp_filter_init(&f, SHIFT, THRESHOLD);
+    temp_filter_update(&f, 2000);
+    int16_t last = 2000;
+    int reports = 0;
+    for (int16_t sample = 2000; sample <= 3000; sample++) {
+        if (temp_filter_update(&f, sample)) {
+            int16_t value = temp_filter_value(&f);
+            TEST_ASSERT_TRUE(value - last >= THRESHOLD);
+            last = value;
+            reports++;
+        }
+    }
+    TEST_ASSERT_TRUE(reports >= 95 && reports <= 100);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_primes);
+    RUN_TEST(test_rounds_to_nearest_both_signs);
+    RUN_TEST(test_step_converges_to_input);
+    RUN_TEST(test_reports_only_past_threshold);
+    RUN_TEST(test_ramp_reports_per_threshold);
+    return UNITY_END();
+}
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+#include "timer_wheel.h"
+
+#define NUM_TIMERS      200
+#define BENCH_TIMERS    10000
+
+static timer_wheel_t wheel;
+static wheel_timer_t timers[NUM_TIMERS];
+
+static void noop_cb(wheel_timer_t *timer, void *arg) {
+    (void)timer;
+    (void)arg;
+}
+
+void setUp(void) {
+    timer_wheel_init(&wheel, 0);
+    for (int i = 0; i < NUM_TIMERS; i++) {
+        timer_wheel_timer_init(&timers[i], "t", noop_cb, NULL);
+    }
+}
+
+void tearDown(void) {}
+
+// Advance to 'now' and check that exactly the timers due by then come out
+static int advance_and_check(uint32_t now) {
+    timer_wheel_advance(&wheel, now);
+    int fired = 0;
+    wheel_timer_t *timer;
+    while ((timer = timer_wheel_pop_expired(&wheel)) != NULL) {
+        TEST_ASSERT_TRUE_MESSAGE((int32_t)(timer->expires - now) <= 0, "timer fired early");
+        fired++;
+    }
+    for (int i = 0; i < NUM_TIMERS; i++) {
+        if (timers[i].pending) {
+            TEST_ASSERT_TRUE_MESSAGE((int32_t)(timers[i].expires - now) > 0, "due timer left pending");
+        }
+    }
+    return fired;
+}
+
+// Earliest deadline by brute force, clamped like timer_wheel_next_expiry()
+static bool model_next_expiry(uint32_t now, uint32_t *expires) {
+    bool found = false;
+    uint32_t best = 0;
+    for (int i = 0; i < NUM_TIMERS; i++) {
+        if (timers[i].pending && (!found || (int32_t)(timers[i].expires - best) < 0)) {
+            best = timers[i].expires;
+            found = true;
+        }
+    }
+    if (found && (int32_t)(best - now) >= (int32_t)TIMER_WHEEL_RANGE) {
+        best = now + TIMER_WHEEL_RANGE - 1;
+    }
+    *expires = best;
+    return found;
+}
+
+static void test_fires_on_exact_tick(void) {
+    static const uint32_t delays[] = { 1, 63, 64, 65, 4095, 4096, 4097, TIMER_WHEEL_RANGE - 1 };
+    for (uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        timer_wheel_add(&wheel, &timers[i], delays[i]);
+    }
+    for (uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        TEST_ASSERT_EQUAL(0, advance_and_check(delays[i] - 1));
+        TEST_ASSERT_EQUAL(1, advance_and_check(delays[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, wheel.pending);
+}
+
+static void test_cancel_removes_timer(void) {
+    timer_wheel_add(&wheel, &timers[0], 100);
+    timer_wheel_add(&wheel, &timers[1], 200);
+    timer_wheel_cancel(&wheel, &timers[0]);
+    TEST_ASSERT_FALSE(timers[0].pending);
+    TEST_ASSERT_EQUAL_UINT32(1, wheel.pending);
+    TEST_ASSERT_EQUAL(0, advance_and_check(150));
+    TEST_ASSERT_EQUAL(1, advance_and_check(200));
+}
+
+static void test_readd_moves_timer(void) {
+    timer_wheel_add(&wheel, &timers[0], 100);
+    timer_wheel_add(&wheel, &timers[0], 300);
+    TEST_ASSERT_EQUAL_UINT32(1, wheel.pending);
+    TEST_ASSERT_EQUAL(0, advance_and_check(299));
+    TEST_ASSERT_EQUAL(1, advance_and_check(300));
+}
+
+static void test_align_rounds_up_to_slack(void) {
+    TEST_ASSERT_EQUAL_UINT32(17, timer_wheel_align(17, 0));
+    TEST_ASSERT_EQUAL_UINT32(17, timer_wheel_align(17, 1));
+    TEST_ASSERT_EQUAL_UINT32(200, timer_wheel_align(101, 100));
+    TEST_ASSERT_EQUAL_UINT32(200, timer_wheel_align(200, 100));
+}
+
+// Timers past TIMER_WHEEL_RANGE (hour-long Kconfig intervals) fire on time
+static void test_far_timer_fires_on_exact_tick(void) {
+    uint32_t far = 3 * TIMER_WHEEL_RANGE + 12345;
+    timer_wheel_add(&wheel, &timers[0], far);
+    timer_wheel_add(&wheel, &timers[1], 1000);
+    uint32_t expires;
+    TEST_ASSERT_TRUE(timer_wheel_next_expiry(&wheel, &expires));
+    TEST_ASSERT_EQUAL_UINT32(1000, expires);
+    TEST_ASSERT_EQUAL(1, advance_and_check(1000));
+    TEST_ASSERT_EQUAL(0, advance_and_check(far - 1));
+    TEST_ASSERT_EQUAL(1, advance_and_check(far));
+}
+
+// Regression: a timer beyond the wheel range used to sit in a slot the
+// next-expiry scan reached early, hiding earlier timers behind its own
+// later deadline
+static void test_next_expiry_matches_model(void) {
+    srand(1);
+    uint32_t now = 0;
+    for (int step = 0; step < 100000; step++) {
+        int i = rand() % NUM_TIMERS;
+        if (!timers[i].pending) {
+            timer_wheel_add(&wheel, &timers[i], now + 1 + (uint32_t)(rand() % 400000));
+        } else if (rand() % 8 == 0) {
+            timer_wheel_cancel(&wheel, &timers[i]);
+        }
+        now += (uint32_t)(rand() % 3000);
+        advance_and_check(now);
+
+        uint32_t got, want;
+        bool found = timer_wheel_next_expiry(&wheel, &got);
+        TEST_ASSERT_EQUAL(model_next_expiry(now + 1, &want), found);
+        if (found) {
+            TEST_ASSERT_EQUAL_UINT32(want, got);
+        }
+    }
+}
+
+static void test_tick_counter_wraps(void) {
+    timer_wheel_init(&wheel, UINT32_MAX - 100);
+    timer_wheel_add(&wheel, &timers[0], 50);    // 151 ticks ahead, past the wrap
+    TEST_ASSERT_EQUAL(0, advance_and_check(UINT32_MAX));
+    TEST_ASSERT_EQUAL(0, advance_and_check(49));
+    TEST_ASSERT_EQUAL(1, advance_and_check(50));
+}
+
+static double elapsed_ns(const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+// Insert and expire cost with thousands of timers spread over the range
+static void test_benchmark_insert_expire(void) {
+    static wheel_timer_t bench[BENCH_TIMERS];
+    struct timespec start;
+    srand(2);
+    for (int i = 0; i < BENCH_TIMERS; i++) {
+        timer_wheel_timer_init(&bench[i], "bench", noop_cb, NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_TIMERS; i++) {
+        timer_wheel_add(&wheel, &bench[i], 1 + (uint32_t)(rand() % 360000));
+    }
+    double insert_ns = elapsed_ns(&start) / BENCH_TIMERS;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int fired = 0;
+    for (uint32_t now = 0; now <= 360000; now += 100) {
+        timer_wheel_advance(&wheel, now);
+        while (timer_wheel_pop_expired(&wheel) != NULL) {
+            fired++;
+        }
+    }
+    double expire_ns = elapsed_ns(&start) / BENCH_TIMERS;
+
+    char line[96];
+    snprintf(line, sizeof(line), "%d timers: insert %.0f ns, advance+expire %.0f ns per timer",
+             BENCH_TIMERS, insert_ns, expire_ns);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(BENCH_TIMERS, fired);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_on_exact_tick);
+    RUN_TEST(test_cancel_removes_timer);
+    RUN_TEST(test_readd_moves_timer);
+    RUN_TEST(test_align_rounds_up_to_slack);
+    RUN_TEST(test_far_timer_fires_on_exact_tick);
+    RUN_TEST(test_next_expiry_matches_model);
+    RUN_TEST(test_tick_counter_wraps);
+    RUN_TEST(test_benchmark_insert_expire);
+    return UNITY_END();
+}
@@ -0,0 +1,56 @@
+#include <unity.h>
+#include "zb_level.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Every level a hub can write reads back as the same level
+static void test_all_levels_round_trip(void) {
+    for (int level = 0; level <= ZB_LEVEL_MAX; level++) {
+        int speed = zb_level_to_speed((uint8_t)level);
+        TEST_ASSERT_TRUE(speed >= 0 && speed <= ZB_LEVEL_SPEED_MAX);
+        TEST_ASSERT_EQUAL(level, zb_speed_to_level(speed));
+    }
+}
+
+static void test_end_points(void) {
+    TEST_ASSERT_EQUAL(0, zb_level_to_speed(0));
+    TEST_ASSERT_EQUAL(ZB_LEVEL_SPEED_MAX, zb_level_to_speed(ZB_LEVEL_MAX));
+    TEST_ASSERT_EQUAL(0, zb_speed_to_level(0));
+    TEST_ASSERT_EQUAL(ZB_LEVEL_MAX, zb_speed_to_level(ZB_LEVEL_SPEED_MAX));
+}
+
+// 255 is reserved by the ZCL and is treated as full scale
+static void test_reserved_level_clamps(void) {
+    TEST_ASSERT_EQUAL(ZB_LEVEL_SPEED_MAX, zb_level_to_speed(255));
+}
+
+static void test_both_directions_monotonic(void) {
+    for (int level = 1; level <= ZB_LEVEL_MAX; level++) {
+        TEST_ASSERT_TRUE(zb_level_to_speed((uint8_t)level) > zb_level_to_speed((uint8_t)(level - 1)));
+    }
+    for (int speed = 1; speed <= ZB_LEVEL_SPEED_MAX; speed++) {
+        TEST_ASSERT_TRUE(zb_speed_to_level(speed) >= zb_speed_to_level(speed - 1));
+    }
+}
+
+// A running fan never reports off, and out-of-range speeds are clamped
+static void test_running_fan_never_reports_zero(void) {
+    TEST_ASSERT_EQUAL(1, zb_speed_to_level(1));
+    for (int speed = 1; speed <= ZB_LEVEL_SPEED_MAX; speed++) {
+        TEST_ASSERT_TRUE(zb_speed_to_level(speed) > 0);
+    }
+    TEST_ASSERT_EQUAL(0, zb_speed_to_level(-5));
+    TEST_ASSERT_EQUAL(ZB_LEVEL_MAX, zb_speed_to_level(ZB_LEVEL_SPEED_MAX + 100));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_all_levels_round_trip);
+    RUN_TEST(test_end_points);
+    RUN_TEST(test_reserved_level_clamps);
+    RUN_TEST(test_both_directions_monotonic);
+    RUN_TEST(test_running_fan_never_reports_zero);
+    return UNITY_END();
+}
@@ -0,0 +1,389 @@
+// Replay a GPIO level trace through the button debouncers and gesture table
+// on the host, and report the events and their detection latency.
+//
+// The trace is CSV: a time in seconds, then one level column per channel, one
+// row per change. This is what logic analyzers export (Saleae "Export raw
+// data" as CSV); header lines are skipped. tools/button_trace_gen.py writes
+// synthetic traces with contact bounce.
+//
+//     gcc -O2 -I src -o button_replay tools/button_replay.c src/{debounce,gesture,edge_ring,button_table}.c
+//     ./button_replay trace.csv --debounce 20 --expect UP_PRESS,UP_PRESS,SPEED_MAX
+//
+// The sampling below mirrors sample_timer_callback() in src/buttons.c: the
+// pin masks on its first edge, a shared BUTTONS_SAMPLE_MS tick integrates
+// every unsettled button, changes reach the gesture engine in edge order and
+// a settled pin is re-armed on the opposite level.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "button_table.h"
+#include "debounce.h"
+#include "edge_ring.h"
+#include "gesture.h"
+
+#define MAX_CHANNELS 16
+#define NO_TIME INT64_MAX
+
+typedef struct {
+    int64_t time_us;
+    uint8_t levels[MAX_CHANNELS];
+} trace_row_t;
+
+typedef struct {
+    bool pressed_raw;
+    bool armed;
+    bool settling;
+    bool changed;
+    int64_t edge_us;
+    debounce_t debounce;
+} sim_button_t;
+
+typedef struct {
+    button_event_t event;
+    uint16_t repeat;
+    int64_t time_us;
+    int64_t latency_us;             // -1 for events fired by a deadline
+} sim_event_t;
+
+static sim_button_t sim[BTN_COUNT];
+static int channel_of[BTN_COUNT] = { 0, 1, 2, 3 };
+static bool active_high = false;
+
+static edge_ring_t ring;
+static gesture_engine_t engine;
+static int64_t sample_due = NO_TIME;
+static int64_t sim_now = 0;
+static bool edge_driven = false;
+
+static sim_event_t *events = NULL;
+static int event_count = 0;
+static int event_cap = 0;
+
+static void on_gesture(const gesture_output_t *output, void *arg) {
+    (void)arg;
+    if (event_count == event_cap) {
+        event_cap = event_cap ? event_cap * 2 : 64;
+        events = realloc(events, event_cap * sizeof(events[0]));
+        if (events == NULL) {
+            perror("realloc");
+            exit(2);
+        }
+    }
+    events[event_count++] = (sim_event_t){
+        .event = (button_event_t)output->action,
+        .repeat = output->repeat,
+        .time_us = sim_now,
+        .latency_us = edge_driven ? sim_now - output->time_us : -1,
+    };
+}
+
+// The GPIO ISR: an armed pin whose level differs from its debounced state
+// masks itself, queues the edge and starts the sampler
+static void check_trigger(int b) {
+    sim_button_t *button = &sim[b];
+    if (!button->armed || button->pressed_raw == button->debounce.pressed) return;
+    button->armed = false;
+    button_edge_t edge = { .time_us = sim_now, .button = (uint8_t)b, .level = !button->pressed_raw };
+    edge_ring_push(&ring, &edge);
+    if (sample_due == NO_TIME) {
+        sample_due = sim_now + BUTTONS_SAMPLE_MS * 1000;
+    }
+}
+
+static void sample_tick(void) {
+    sample_due = NO_TIME;
+
+    button_edge_t edge;
+    while (edge_ring_pop(&ring, &edge)) {
+        sim_button_t *button = &sim[edge.button];
+        if (!button->settling) {
+            button->settling = true;
+            button->changed = false;
+            button->edge_us = edge.time_us;
+        }
+    }
+
+    int order[BTN_COUNT];
+    int changed = 0;
+    uint32_t settled = 0;
+    for (int i = 0; i < BTN_COUNT; i++) {
+        sim_button_t *button = &sim[i];
+        if (!button->settling) continue;
+        if (debounce_sample(&button->debounce, button->pressed_raw)) {
+            int j = changed++;
+            while (j > 0 && sim[order[j - 1]].edge_us > button->edge_us) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+            button->changed = true;
+        }
+        if (debounce_settled(&button->debounce)) {
+            button->settling = false;
+            settled |= 1u << i;
+        }
+    }
+
+    edge_driven = true;
+    for (int k = 0; k < changed; k++) {
+        sim_button_t *button = &sim[order[k]];
+        gesture_tick(&engine, button->edge_us);
+        gesture_button(&engine, order[k], button->debounce.pressed, button->edge_us);
+        button->edge_us = sim_now;
+    }
+    edge_driven = false;
+
+    bool settling = false;
+    for (int i = 0; i < BTN_COUNT; i++) {
+        if (settled & (1u << i)) {
+            sim[i].armed = true;
+        }
+        settling |= sim[i].settling;
+    }
+    if (settling) {
+        sample_due = sim_now + BUTTONS_SAMPLE_MS * 1000;
+    }
+    // Level trigger: a change that happened while masked fires at once
+    for (int i = 0; i < BTN_COUNT; i++) {
+        if (settled & (1u << i)) check_trigger(i);
+    }
+}
+
+static bool parse_row(const char *line, int columns_max, trace_row_t *row, int *columns) {
+    char *end;
+    double seconds = strtod(line, &end);
+    if (end == line) return false;
+    row->time_us = (int64_t)(seconds * 1e6 + (seconds < 0 ? -0.5 : 0.5));
+    int n = 0;
+    const char *p = end;
+    while (*p && n < columns_max) {
+        while (*p == ',' || *p == ' ' || *p == '\t') p++;
+        if (*p != '0' && *p != '1') break;
+        row->levels[n++] = (uint8_t)(*p - '0');
+        p++;
+    }
+    *columns = n;
+    return n > 0;
+}
+
+static int load_trace(const char *path, trace_row_t **rows_out) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    trace_row_t *rows = NULL;
+    int count = 0, cap = 0, columns_needed = 0;
+    for (int b = 0; b < BTN_COUNT; b++) {
+        if (channel_of[b] + 1 > columns_needed) columns_needed = channel_of[b] + 1;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        trace_row_t row;
+        int columns;
+        if (!parse_row(line, MAX_CHANNELS, &row, &columns)) continue;
+        if (columns < columns_needed) {
+            fprintf(stderr, "%s: row at %.6f s has %d channels, need %d\n", path,
+                    row.time_us / 1e6, columns, columns_needed);
+            exit(2);
+        }
+        if (count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            rows = realloc(rows, cap * sizeof(rows[0]));
+            if (rows == NULL) {
+                perror("realloc");
+                exit(2);
+            }
+        }
+        rows[count++] = row;
+    }
+    fclose(f);
+    *rows_out = rows;
+    return count;
+}
+
+static bool row_pressed(const trace_row_t *row, int b) {
+    return row->levels[channel_of[b]] == (active_high ? 1 : 0);
+}
+
+static int button_by_name(const char *name, size_t len) {
+    for (int b = 0; b < BTN_COUNT; b++) {
+        if (strlen(button_name(b)) == len && strncmp(button_name(b), name, len) == 0) return b;
+    }
+    return -1;
+}
+
+// "UP=0,DOWN=1,..." assigns trace channel columns to buttons
+static void parse_map(const char *spec) {
+    const char *p = spec;
+    while (*p) {
+        const char *eq = strchr(p, '=');
+        if (eq == NULL) break;
+        int b = button_by_name(p, (size_t)(eq - p));
+        if (b < 0) {
+            fprintf(stderr, "unknown button in --map: %.*s\n", (int)(eq - p), p);
+            exit(2);
+        }
+        channel_of[b] = atoi(eq + 1);
+        if (channel_of[b] < 0 || channel_of[b] >= MAX_CHANNELS) {
+            fprintf(stderr, "channel out of range in --map\n");
+            exit(2);
+        }
+        p = strchr(eq, ',');
+        if (p == NULL) break;
+        p++;
+    }
+}
+
+static int compare_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const int64_t *sorted, int n, int pct) {
+    int index = (int)(((int64_t)pct * n + 99) / 100) - 1;
+    if (index < 0) index = 0;
+    if (index >= n) index = n - 1;
+    return sorted[index] / 1000.0;
+}
+
+// Compare against "NAME,NAME,..."; repeats count as separate events
+static bool check_expected(const char *spec) {
+    int i = 0;
+    const char *p = spec;
+    bool ok = true;
+    while (*p) {
+        const char *comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        const char *got = i < event_count ? button_event_name(events[i].event) : "(none)";
+        if (strlen(got) != len || strncmp(got, p, len) != 0) {
+            printf("MISMATCH at event %d: expected %.*s, got %s\n", i, (int)len, p, got);
+            ok = false;
+            break;
+        }
+        i++;
+        if (comma == NULL) break;
+        p = comma + 1;
+    }
+    if (ok && i != event_count) {
+        printf("MISMATCH: expected %d events, got %d\n", i, event_count);
+        ok = false;
+    }
+    return ok;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s TRACE.csv [--debounce MS] [--map MODE=0,UP=1,DOWN=2,TOGGLE=3]\n"
+            "       [--active-high] [--tail MS] [--expect EVENT,EVENT,...] [--quiet]\n",
+            prog);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    const char *expect = NULL;
+    uint32_t debounce_ms = 20;
+    uint32_t tail_ms = 1000;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--debounce") == 0 && i + 1 < argc) {
+            debounce_ms = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            parse_map(argv[++i]);
+        } else if (strcmp(argv[i], "--active-high") == 0) {
+            active_high = true;
+        } else if (strcmp(argv[i], "--tail") == 0 && i + 1 < argc) {
+            tail_ms = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+            expect = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (path == NULL) usage(argv[0]);
+
+    trace_row_t *rows;
+    int row_count = load_trace(path, &rows);
+    if (row_count == 0) {
+        fprintf(stderr, "%s: no samples\n", path);
+        return 2;
+    }
+
+    // The first row is the state at boot; a button held then is not a press
+    edge_ring_init(&ring);
+    gesture_init(&engine, button_gestures, button_gesture_count, button_repeat_stages,
+                 button_repeat_stage_count, BUTTONS_REPEAT_DELAY_MS, on_gesture, NULL);
+    for (int b = 0; b < BTN_COUNT; b++) {
+        sim[b].pressed_raw = row_pressed(&rows[0], b);
+        sim[b].armed = true;
+        debounce_init(&sim[b].debounce, debounce_ms, BUTTONS_SAMPLE_MS, sim[b].pressed_raw);
+    }
+
+    int64_t end_us = rows[row_count - 1].time_us + (int64_t)tail_ms * 1000;
+    int next_row = 1;
+    while (true) {
+        int64_t row_due = next_row < row_count ? rows[next_row].time_us : NO_TIME;
+        int64_t gesture_due = gesture_next_deadline(&engine);
+        int64_t due = row_due;
+        if (sample_due < due) due = sample_due;
+        if (gesture_due < due) due = gesture_due;
+        if (due == NO_TIME || due > end_us) break;
+        sim_now = due;
+
+        if (due == row_due) {
+            for (int b = 0; b < BTN_COUNT; b++) {
+                sim[b].pressed_raw = row_pressed(&rows[next_row], b);
+                check_trigger(b);
+            }
+            next_row++;
+        } else if (due == sample_due) {
+            sample_tick();
+        } else {
+            gesture_tick(&engine, sim_now);
+        }
+    }
+
+    int64_t *latencies = malloc((event_count + 1) * sizeof(int64_t));
+    int latency_count = 0;
+    for (int i = 0; i < event_count; i++) {
+        const sim_event_t *e = &events[i];
+        if (!quiet) {
+            printf("%12.6f %-14s repeat=%u", e->time_us / 1e6, button_event_name(e->event), e->repeat);
+            if (e->latency_us >= 0) printf(" latency=%.3f ms", e->latency_us / 1000.0);
+            printf("\n");
+        }
+        if (e->latency_us >= 0) latencies[latency_count++] = e->latency_us;
+    }
+
+    printf("events=%d edge_events=%d ring_overflows=%u debounce=%u ms\n", event_count, latency_count,
+           (unsigned)edge_ring_overflows(&ring), (unsigned)debounce_ms);
+    if (latency_count > 0) {
+        qsort(latencies, latency_count, sizeof(int64_t), compare_i64);
+        printf("latency_ms p50=%.3f p90=%.3f p99=%.3f max=%.3f\n", percentile_ms(latencies, latency_count, 50),
+               percentile_ms(latencies, latency_count, 90), percentile_ms(latencies, latency_count, 99),
+               latencies[latency_count - 1] / 1000.0);
+    }
+    free(latencies);
+
+    int status = 0;
+    if (expect != NULL) {
+        if (check_expected(expect)) {
+            printf("expected sequence matched\n");
+        } else {
+            status = 1;
+        }
+    }
+    free(events);
+    free(rows);
+    return status;
+}
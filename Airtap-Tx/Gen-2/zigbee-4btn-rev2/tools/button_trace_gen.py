@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Write a synthetic button GPIO trace with contact bounce, as CSV.
+
+Each press is BUTTON:START:DURATION in seconds. Every press and release
+edge gets a burst of random bounce before the contact settles. The output
+has the same layout as a logic analyzer export and feeds tools/button_replay.c:
+
+    python3 tools/button_trace_gen.py UP:0.1:0.08 UP:0.3:0.08 > up_double.csv
+    ./button_replay up_double.csv --expect UP_PRESS,UP_PRESS,SPEED_MAX
+"""
+
+import argparse
+import random
+import sys
+
+BUTTONS = ["MODE", "UP", "DOWN", "TOGGLE"]
+
+
+def parse_press(spec):
+    try:
+        name, start, duration = spec.split(":")
+        return BUTTONS.index(name.upper()), float(start), float(duration)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"expected BUTTON:START:DURATION, got {spec!r}")
+
+
+def bounce(rng, time_s, pressed, bounce_ms, edges):
+    """Level changes for one edge: random toggles, then the settled level."""
+    changes = []
+    t = time_s
+    level = pressed
+    for _ in range(rng.randint(0, edges) * 2):
+        changes.append((t, level))
+        level = not level
+        t += rng.uniform(0, bounce_ms / 1000.0 / max(edges, 1))
+    changes.append((t, pressed))
+    return changes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("presses", nargs="+", type=parse_press)
+    parser.add_argument("--bounce-ms", type=float, default=5.0, help="longest bounce burst")
+    parser.add_argument("--bounce-edges", type=int, default=4, help="most bounce pulses per edge")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    changes = []
+    for button, start, duration in args.presses:
+        for t, pressed in bounce(rng, start, True, args.bounce_ms, args.bounce_edges):
+            changes.append((t, button, pressed))
+        for t, pressed in bounce(rng, start + duration, False, args.bounce_ms, args.bounce_edges):
+            changes.append((t, button, pressed))
+    changes.sort(key=lambda change: change[0])
+
+    # Active low, like the panel: 1 = released
+    levels = [1] * len(BUTTONS)
+    out = sys.stdout
+    out.write("Time [s]," + ",".join(BUTTONS) + "\n")
+    out.write("0.000000," + ",".join(map(str, levels)) + "\n")
+    for t, button, pressed in changes:
+        levels[button] = 0 if pressed else 1
+        out.write(f"{t:.6f}," + ",".join(map(str, levels)) + "\n")
+
+
+if __name__ == "__main__":
+    main()
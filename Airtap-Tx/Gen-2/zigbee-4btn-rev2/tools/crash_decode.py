@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Decode an AirTap crash summary and symbolize it against the firmware ELF.
+
+The summary comes either from the serial console ("crash" prints a line
+starting with "@crash,") or from the Zigbee diagnostics cluster 0xFC00
+(attribute 0x0010 is the size; write the offset to 0x0011 and read 64-byte
+chunks from 0x0012), concatenated into a binary file.
+
+    python3 tools/crash_decode.py monitor.log --elf .pio/build/esp32c6/firmware.elf
+    python3 tools/crash_decode.py crash.bin --elf firmware.elf
+"""
+
+import argparse
+import hashlib
+import shutil
+import struct
+import subprocess
+import sys
+
+MAGIC = 0x53435441
+HEADER = struct.Struct("<IBBBBBBH16s16sIIIII")
+TASK = struct.Struct("<16sHBB")
+
+RESET_REASONS = {
+    4: "panic", 5: "interrupt watchdog", 6: "task watchdog", 7: "other watchdog",
+}
+TASK_STATES = ["running", "ready", "blocked", "suspended", "deleted"]
+MCAUSE = {
+    0: "instruction address misaligned", 1: "instruction access fault", 2: "illegal instruction",
+    3: "breakpoint", 4: "load address misaligned", 5: "load access fault",
+    6: "store address misaligned", 7: "store access fault", 11: "machine ecall",
+}
+
+
+def load(path):
+    data = open(path, "rb").read()
+    if data[:4] == struct.pack("<I", MAGIC):
+        return data
+    for line in data.decode(errors="replace").splitlines():
+        at = line.find("@crash,")
+        if at >= 0:
+            return bytes.fromhex(line[at + 7:].strip())
+    sys.exit("no crash summary found in input")
+
+
+def cstr(raw):
+    return raw.split(b"\0", 1)[0].decode(errors="replace")
+
+
+def symbolizer(elf, tool):
+    if not elf:
+        return lambda addrs: {}
+    exe = shutil.which(tool)
+    if not exe:
+        print(f"warning: {tool} not found, addresses are not symbolized", file=sys.stderr)
+        return lambda addrs: {}
+
+    def run(addrs):
+        out = subprocess.run([exe, "-pfiaC", "-e", elf] + [f"0x{a:08x}" for a in addrs],
+                             capture_output=True, text=True, check=False).stdout
+        # One block per address, each starting with "0x<addr>: "
+        result, current = {}, None
+        for line in out.splitlines():
+            if line.startswith("0x"):
+                addr, _, rest = line.partition(": ")
+                current = int(addr, 16)
+                result[current] = rest
+            elif current is not None:
+                result[current] += "\n" + " " * 14 + line.strip()
+        return result
+    return run
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="monitor log or binary summary")
+    parser.add_argument("--elf", help="firmware ELF of the build that crashed")
+    parser.add_argument("--addr2line", default="riscv32-esp-elf-addr2line")
+    args = parser.parse_args()
+
+    data = load(args.input)
+    (magic, version, reset_reason, num_bt, num_tasks, num_logs, _, length,
+     elf_sha, exc_task, exc_pc, mcause, mtval, ra, sp) = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("bad magic, not a crash summary")
+    if version != 1:
+        sys.exit(f"unsupported summary version {version}")
+    if len(data) < length:
+        sys.exit(f"summary truncated: {len(data)} of {length} bytes")
+
+    off = HEADER.size
+    backtrace = list(struct.unpack_from(f"<{num_bt}I", data, off))
+    off += 4 * num_bt
+    tasks = []
+    for _ in range(num_tasks):
+        tasks.append(TASK.unpack_from(data, off))
+        off += TASK.size
+    logs = []
+    for _ in range(num_logs):
+        n = data[off]
+        logs.append(data[off + 1:off + 1 + n].decode(errors="replace"))
+        off += 1 + n
+
+    sha = cstr(elf_sha)
+    if args.elf:
+        actual = hashlib.sha256(open(args.elf, "rb").read()).hexdigest()
+        if sha and not actual.startswith(sha):
+            print(f"warning: crash is from ELF {sha}, given ELF is {actual[:len(sha)]}", file=sys.stderr)
+
+    symbols = symbolizer(args.elf, args.addr2line)([exc_pc, ra] + backtrace)
+
+    def sym(addr):
+        return f"0x{addr:08x}  {symbols.get(addr, '')}".rstrip()
+
+    print(f"Reset reason : {RESET_REASONS.get(reset_reason, reset_reason)}")
+    print(f"App ELF SHA  : {sha}")
+    print(f"Task         : {cstr(exc_task)}")
+    print(f"Cause        : {MCAUSE.get(mcause, 'interrupt' if mcause & 0x80000000 else mcause)} "
+          f"(mcause 0x{mcause:08x}, mtval 0x{mtval:08x})")
+    print(f"PC           : {sym(exc_pc)}")
+    print(f"RA           : {sym(ra)}")
+    print(f"SP           : 0x{sp:08x}")
+    print("\nBacktrace (code addresses found on the stack, innermost first):")
+    for addr in backtrace:
+        print(f"  {sym(addr)}")
+    print("\nTasks (last snapshot before the crash):")
+    for name, stack_free, state, prio in tasks:
+        state_name = TASK_STATES[state] if state < len(TASK_STATES) else str(state)
+        print(f"  {cstr(name):16s} prio {prio:2d}  {state_name:9s} stack free {stack_free}")
+    print(f"\nLast {len(logs)} log lines:")
+    for line in logs:
+        print(f"  {line}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Right-size task stacks from one or more "stacks" console captures.
+
+Each "@stack,<option>,<size>,<used>,<suggested>" line printed by the
+"stacks" command is one measurement. Across all captures the largest usage
+per option wins; the margin is added and the result rounded up to 256 bytes
+and clamped to the option's Kconfig range. The fragment is picked up by the
+build (CMakeLists.txt adds sdkconfig.stacks to SDKCONFIG_DEFAULTS), but
+defaults only seed options missing from an existing sdkconfig, so pass
+--apply to rewrite the env's sdkconfig as well.
+
+    python3 tools/stack_sizes.py soak.log idle.log
+    python3 tools/stack_sizes.py monitor.log --margin 1536 --apply sdkconfig.esp32c6
+"""
+
+import argparse
+import re
+import sys
+
+ROUND = 256
+
+# Kconfig ranges; values outside them are rejected by menuconfig
+RANGES = {
+    "CONFIG_ESP_MAIN_TASK_STACK_SIZE": (2048, 65536),
+    "CONFIG_AIRTAP_ZIGBEE_TASK_STACK": (2048, 16384),
+    "CONFIG_ESP_TIMER_TASK_STACK_SIZE": (2048, 65536),
+    "CONFIG_FREERTOS_IDLE_TASK_STACKSIZE": (768, 32768),
+    "CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH": (1536, 32768),
+    "CONFIG_AIRTAP_CONSOLE_TASK_STACK": (2048, 8192),
+}
+
+# Deprecated names ESP-IDF still writes to sdkconfig next to the new ones
+ALIASES = {
+    "CONFIG_ESP_MAIN_TASK_STACK_SIZE": "CONFIG_MAIN_TASK_STACK_SIZE",
+    "CONFIG_ESP_TIMER_TASK_STACK_SIZE": "CONFIG_TIMER_TASK_STACK_SIZE",
+    "CONFIG_FREERTOS_TIMER_TASK_STACK_DEPTH": "CONFIG_TIMER_TASK_STACK_DEPTH",
+}
+
+LINE = re.compile(r"@stack,(CONFIG_\w+),(\d+),(\d+)")
+
+
+def measure(paths):
+    used = {}
+    sizes = {}
+    for path in paths:
+        with open(path, errors="replace") as f:
+            for line in f:
+                match = LINE.search(line)
+                if match:
+                    option, size, peak = match.group(1), int(match.group(2)), int(match.group(3))
+                    used[option] = max(used.get(option, 0), peak)
+                    sizes[option] = size
+    return used, sizes
+
+
+def suggest(option, used, margin):
+    size = (used + margin + ROUND - 1) // ROUND * ROUND
+    low, high = RANGES.get(option, (0, 1 << 20))
+    return min(max(size, low), high)
+
+
+def apply(path, values):
+    with open(path) as f:
+        lines = f.read().splitlines()
+    names = dict(values)
+    for option, value in values.items():
+        if option in ALIASES:
+            names[ALIASES[option]] = value
+    seen = set()
+    for i, line in enumerate(lines):
+        name = line.split("=", 1)[0]
+        if name in names:
+            lines[i] = f"{name}={names[name]}"
+            seen.add(name)
+    lines += [f"{option}={value}" for option, value in values.items() if option not in seen]
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="+", help="monitor logs containing \"stacks\" output")
+    parser.add_argument("--margin", type=int, default=1024, help="bytes added to the peak usage")
+    parser.add_argument("-o", "--output", default="sdkconfig.stacks", help="fragment to write")
+    parser.add_argument("--apply", metavar="SDKCONFIG", help="also update this sdkconfig in place")
+    args = parser.parse_args()
+
+    used, sizes = measure(args.input)
+    if not used:
+        sys.exit("no @stack lines found in input")
+
+    values = {}
+    print(f"{'option':<40} {'size':>6} {'used':>6} {'new':>6}")
+    for option in sorted(used):
+        values[option] = suggest(option, used[option], args.margin)
+        print(f"{option:<40} {sizes[option]:>6} {used[option]:>6} {values[option]:>6}")
+
+    with open(args.output, "w") as f:
+        f.write(f"# Generated by tools/stack_sizes.py: peak usage + {args.margin} bytes\n")
+        for option, value in values.items():
+            f.write(f"{option}={value}\n")
+    print(f"wrote {args.output}")
+    if args.apply:
+        apply(args.apply, values)
+        print(f"updated {args.apply}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Convert an AirTap scheduling trace dump to Chrome/Perfetto trace JSON.
+
+Capture the dump by typing "trace" in the serial monitor and saving the
+output (for example `pio device monitor | tee trace.log`), then run:
+
+    python3 tools/trace_to_chrome.py trace.log > trace.json
+
+Open the result in https://ui.perfetto.dev or chrome://tracing. Each task
+gets a track showing when it ran; ISRs and code markers appear on the task
+that was running when they were recorded.
+"""
+
+import json
+import sys
+
+TASK_IN = 1
+ISR_ENTER = 2
+ISR_EXIT = 3
+BEGIN = 4
+END = 5
+INSTANT = 6
+
+WRAP = 1 << 32
+
+
+def parse(lines):
+    """Return (task names by handle, [(time_us, type, id)]) from the last dump."""
+    tasks, events, dropped = {}, [], 0
+    for raw in lines:
+        line = raw.strip()
+        at = line.find("@")
+        if at < 0:
+            continue
+        fields = line[at + 1:].split(",", 3)
+        kind = fields[0]
+        if kind == "begin":
+            tasks, events = {}, []
+            dropped = int(fields[2])
+        elif kind == "task":
+            tasks[fields[1]] = fields[2]
+        elif kind == "ev" and len(fields) == 4:
+            events.append((int(fields[1]), int(fields[2]), fields[3]))
+    return tasks, events, dropped
+
+
+def unwrap(events):
+    """Extend the 32-bit microsecond timestamps into a monotonic timeline."""
+    out, offset, prev = [], 0, None
+    for t, kind, ident in events:
+        if prev is not None and t < prev and prev - t > WRAP // 2:
+            offset += WRAP
+        prev = t
+        out.append((t + offset, kind, ident))
+    return out
+
+
+def convert(tasks, events):
+    trace = []
+    tids = {}
+
+    def tid(name):
+        if name not in tids:
+            tids[name] = len(tids) + 1
+            trace.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tids[name],
+                          "args": {"name": name}})
+        return tids[name]
+
+    current, since = None, None
+    for t, kind, ident in events:
+        if kind == TASK_IN:
+            if current is not None:
+                trace.append({"ph": "X", "name": current, "cat": "task", "pid": 1,
+                              "tid": tid(current), "ts": since, "dur": t - since})
+            current, since = tasks.get(ident, ident), t
+            continue
+        track = tid(current if current is not None else "unknown")
+        if kind in (ISR_ENTER, BEGIN):
+            trace.append({"ph": "B", "name": ident, "cat": "isr" if kind == ISR_ENTER else "marker",
+                          "pid": 1, "tid": track, "ts": t})
+        elif kind in (ISR_EXIT, END):
+            trace.append({"ph": "E", "name": ident, "pid": 1, "tid": track, "ts": t})
+        elif kind == INSTANT:
+            trace.append({"ph": "i", "name": ident, "s": "t", "pid": 1, "tid": track, "ts": t})
+    if current is not None and events:
+        trace.append({"ph": "X", "name": current, "cat": "task", "pid": 1,
+                      "tid": tid(current), "ts": since, "dur": events[-1][0] - since})
+    return trace
+
+
+def main():
+    source = open(sys.argv[1], errors="replace") if len(sys.argv) > 1 else sys.stdin
+    tasks, events, dropped = parse(source)
+    if not events:
+        sys.exit("no trace dump found in input")
+    if dropped:
+        print(f"note: {dropped} older events were overwritten", file=sys.stderr)
+    json.dump({"traceEvents": convert(tasks, unwrap(events)), "displayTimeUnit": "ms"}, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()